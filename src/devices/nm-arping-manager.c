@@ -17,14 +17,27 @@
 #include "nm-default.h"
 
 #include <netinet/in.h>
+#include <netinet/if_ether.h>
+#include <netpacket/packet.h>
+#include <sys/socket.h>
 #include <sys/types.h>
-#include <sys/wait.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include "nm-arping-manager.h"
 #include "nm-platform.h"
+#include "nmp-netns.h"
 #include "nm-utils.h"
 #include "NetworkManagerUtils.h"
 
+#include "nm-sd-adapt.h"
+#include "arp-util.h"
+
+/* number of ARP probes sent for each address, evenly spread over the
+ * probe timeout. */
+#define PROBE_NUM                3
+#define ANNOUNCE_INTERVAL_SEC    2
+
 typedef enum {
 	STATE_INIT,
 	STATE_PROBING,
@@ -32,19 +45,24 @@ typedef enum {
 	STATE_ANNOUNCING,
 } State;
 
+typedef struct _ArpSocket ArpSocket;
+
 typedef struct {
+	NMPlatform    *platform;
 	int            ifindex;
 	State          state;
 	GHashTable    *addresses;
 	guint          completed;
 	guint          timer;
+	guint          probe_id;
+	guint          probes_sent;
 	guint          round2_id;
+	ArpSocket     *socket;
+	struct ether_addr hwaddr;
 } NMArpingManagerPrivate;
 
 typedef struct {
 	in_addr_t address;
-	GPid pid;
-	guint watch;
 	gboolean duplicate;
 	NMArpingManager *manager;
 } AddressInfo;
@@ -74,6 +92,201 @@ G_DEFINE_TYPE (NMArpingManager, nm_arping_manager, G_TYPE_OBJECT)
                 _NM_UTILS_MACRO_REST (__VA_ARGS__)); \
     } G_STMT_END
 
+static void probe_handle_packet (NMArpingManager *self, const struct ether_arp *arp);
+static gboolean arping_timeout_cb (gpointer user_data);
+
+/*****************************************************************************/
+
+/* All managers of an interface share one packet socket. The probes of all
+ * addresses are sent on it and the received ARP packets are dispatched to
+ * the managers that are currently probing. The socket is created in the
+ * network namespace of the platform, so that it also works for devices
+ * that are not in the initial namespace. */
+struct _ArpSocket {
+	NMPNetns *netns;
+	int ifindex;
+	int fd;
+	guint ref_count;
+	GIOChannel *channel;
+	guint event_id;
+	GSList *listeners;
+};
+
+static GHashTable *arp_sockets;
+
+static guint
+arp_socket_hash (gconstpointer key)
+{
+	const ArpSocket *s = key;
+
+	return g_direct_hash (s->netns) ^ ((guint) s->ifindex);
+}
+
+static gboolean
+arp_socket_equal (gconstpointer a, gconstpointer b)
+{
+	const ArpSocket *s_a = a;
+	const ArpSocket *s_b = b;
+
+	return    s_a->netns == s_b->netns
+	       && s_a->ifindex == s_b->ifindex;
+}
+
+static gboolean
+arp_socket_event_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	ArpSocket *s = user_data;
+	struct ether_arp arp;
+	ssize_t n;
+	GSList *iter;
+
+	while (TRUE) {
+		n = recv (s->fd, &arp, sizeof (arp), 0);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN)
+				nm_log_dbg (LOGD_IP4, "arping: failed to receive on ifindex %d: %s", s->ifindex, g_strerror (errno));
+			break;
+		}
+
+		if (   n < (ssize_t) sizeof (arp)
+		    || arp.ea_hdr.ar_hrd != htons (ARPHRD_ETHER)
+		    || arp.ea_hdr.ar_pro != htons (ETHERTYPE_IP)
+		    || arp.ea_hdr.ar_hln != ETH_ALEN
+		    || arp.ea_hdr.ar_pln != sizeof (in_addr_t)
+		    || !NM_IN_SET (ntohs (arp.ea_hdr.ar_op), ARPOP_REQUEST, ARPOP_REPLY))
+			continue;
+
+		/* listeners never unregister while handling a packet. Finishing a
+		 * probe is always deferred to an idle handler. */
+		for (iter = s->listeners; iter; iter = iter->next)
+			probe_handle_packet (iter->data, &arp);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static ArpSocket *
+arp_socket_acquire (NMPlatform *platform, int ifindex, GError **error)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	ArpSocket key = {
+		.netns = nm_platform_netns_get (platform),
+		.ifindex = ifindex,
+	};
+	union {
+		struct sockaddr sa;
+		struct sockaddr_ll ll;
+	} link = {
+		.ll.sll_family = AF_PACKET,
+		.ll.sll_protocol = htons (ETH_P_ARP),
+		.ll.sll_ifindex = ifindex,
+	};
+	ArpSocket *s;
+	int fd, errsv;
+
+	if (G_UNLIKELY (!arp_sockets))
+		arp_sockets = g_hash_table_new (arp_socket_hash, arp_socket_equal);
+
+	s = g_hash_table_lookup (arp_sockets, &key);
+	if (s) {
+		s->ref_count++;
+		return s;
+	}
+
+	if (!nm_platform_netns_push (platform, &netns)) {
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "failed to switch network namespace");
+		return NULL;
+	}
+
+	fd = socket (PF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (fd < 0) {
+		errsv = errno;
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "failed to create packet socket: %s", g_strerror (errsv));
+		return NULL;
+	}
+
+	if (bind (fd, &link.sa, sizeof (link.ll)) < 0) {
+		errsv = errno;
+		close (fd);
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "failed to bind packet socket to ifindex %d: %s", ifindex, g_strerror (errsv));
+		return NULL;
+	}
+
+	s = g_slice_new0 (ArpSocket);
+	s->netns = key.netns ? g_object_ref (key.netns) : NULL;
+	s->ifindex = ifindex;
+	s->fd = fd;
+	s->ref_count = 1;
+	s->channel = g_io_channel_unix_new (fd);
+	s->event_id = g_io_add_watch (s->channel, G_IO_IN, arp_socket_event_cb, s);
+	g_hash_table_add (arp_sockets, s);
+
+	nm_log_dbg (LOGD_IP4, "arping: opened packet socket for ifindex %d (fd %d)", ifindex, fd);
+	return s;
+}
+
+static void
+arp_socket_release (ArpSocket *s)
+{
+	g_return_if_fail (s && s->ref_count > 0);
+
+	if (--s->ref_count > 0)
+		return;
+
+	nm_assert (!s->listeners);
+
+	g_hash_table_remove (arp_sockets, s);
+	nm_clear_g_source (&s->event_id);
+	g_io_channel_unref (s->channel);
+	close (s->fd);
+	g_clear_object (&s->netns);
+	nm_log_dbg (LOGD_IP4, "arping: closed packet socket for ifindex %d", s->ifindex);
+	g_slice_free (ArpSocket, s);
+}
+
+/*****************************************************************************/
+
+static gboolean
+manager_acquire_socket (NMArpingManager *self, GError **error)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	gconstpointer hwaddr;
+	size_t hwaddr_len = 0;
+
+	if (priv->socket)
+		return TRUE;
+
+	hwaddr = nm_platform_link_get_address (priv->platform, priv->ifindex, &hwaddr_len);
+	if (!hwaddr || hwaddr_len != ETH_ALEN) {
+		/* The device was probably just removed, or it is not an Ethernet-like link. */
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "can't find an Ethernet address for ifindex %d", priv->ifindex);
+		return FALSE;
+	}
+	memcpy (&priv->hwaddr, hwaddr, ETH_ALEN);
+
+	priv->socket = arp_socket_acquire (priv->platform, priv->ifindex, error);
+	return !!priv->socket;
+}
+
+static void
+manager_release_socket (NMArpingManager *self)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	if (priv->socket) {
+		priv->socket->listeners = g_slist_remove (priv->socket->listeners, self);
+		g_clear_pointer (&priv->socket, arp_socket_release);
+	}
+}
+
+/*****************************************************************************/
+
 /**
  * nm_arping_manager_add_address:
  * @self: a #NMArpingManager
@@ -108,35 +321,84 @@ nm_arping_manager_add_address (NMArpingManager *self, in_addr_t address)
 }
 
 static void
-arping_watch_cb (GPid pid, gint status, gpointer user_data)
+probe_handle_packet (NMArpingManager *self, const struct ether_arp *arp)
 {
-	AddressInfo *info = user_data;
-	NMArpingManager *self = info->manager;
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
-	const char *addr;
-
-	info->pid = 0;
-	info->watch = 0;
-	addr = nm_utils_inet4_ntop (info->address, NULL);
-
-	if (WIFEXITED (status)) {
-		if (WEXITSTATUS (status) != 0) {
-			_LOGD ("%s already used in the %s network",
-			       addr, nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex));
-			info->duplicate = TRUE;
-		} else
-			_LOGD ("DAD succeeded for %s", addr);
-	} else {
-		_LOGD ("stopped unexpectedly with status %d for %s", status, addr);
-	}
+	AddressInfo *info;
+	in_addr_t spa, tpa;
+
+	if (priv->state != STATE_PROBING)
+		return;
+
+	/* our own probes, looped back by the packet socket. */
+	if (memcmp (arp->arp_sha, &priv->hwaddr, ETH_ALEN) == 0)
+		return;
+
+	memcpy (&spa, arp->arp_spa, sizeof (spa));
+	memcpy (&tpa, arp->arp_tpa, sizeof (tpa));
+
+	if (spa)
+		info = g_hash_table_lookup (priv->addresses, GUINT_TO_POINTER (spa));
+	else if (ntohs (arp->ea_hdr.ar_op) == ARPOP_REQUEST) {
+		/* another host probing for the same address at the same time. */
+		info = g_hash_table_lookup (priv->addresses, GUINT_TO_POINTER (tpa));
+	} else
+		info = NULL;
+
+	if (!info || info->duplicate)
+		return;
+
+	_LOGD ("%s already used in the %s network",
+	       nm_utils_inet4_ntop (info->address, NULL),
+	       nm_platform_link_get_name (priv->platform, priv->ifindex));
+	info->duplicate = TRUE;
 
 	if (++priv->completed == g_hash_table_size (priv->addresses)) {
-		priv->state = STATE_PROBE_DONE;
+		/* all addresses are taken, no need to wait for the timeout. Still
+		 * don't emit the signal while dispatching the packet. */
 		nm_clear_g_source (&priv->timer);
-		g_signal_emit (self, signals[PROBE_TERMINATED], 0);
+		priv->timer = g_idle_add (arping_timeout_cb, self);
+	}
+}
+
+static void
+probe_send (NMArpingManager *self)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	GHashTableIter iter;
+	AddressInfo *info;
+	int r;
+
+	priv->probes_sent++;
+
+	g_hash_table_iter_init (&iter, priv->addresses);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
+		if (info->duplicate)
+			continue;
+
+		r = arp_send_probe (priv->socket->fd, priv->ifindex, info->address, &priv->hwaddr);
+		if (r < 0) {
+			_LOGD ("could not send ARP probe for %s: %s",
+			       nm_utils_inet4_ntop (info->address, NULL), g_strerror (-r));
+		}
 	}
 }
 
+static gboolean
+probe_send_cb (gpointer user_data)
+{
+	NMArpingManager *self = user_data;
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	probe_send (self);
+
+	if (priv->probes_sent < PROBE_NUM)
+		return G_SOURCE_CONTINUE;
+
+	priv->probe_id = 0;
+	return G_SOURCE_REMOVE;
+}
+
 static gboolean
 arping_timeout_cb (gpointer user_data)
 {
@@ -146,19 +408,15 @@ arping_timeout_cb (gpointer user_data)
 	AddressInfo *info;
 
 	priv->timer = 0;
+	nm_clear_g_source (&priv->probe_id);
 
 	g_hash_table_iter_init (&iter, priv->addresses);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		nm_clear_g_source (&info->watch);
-		if (info->pid) {
-			_LOGD ("DAD timed out for %s",
-			       nm_utils_inet4_ntop (info->address, NULL));
-			nm_utils_kill_child_async (info->pid, SIGTERM, LOGD_IP4,
-			                           "arping", 1000, NULL, NULL);
-			info->pid = 0;
-		}
+		if (!info->duplicate)
+			_LOGD ("DAD succeeded for %s", nm_utils_inet4_ntop (info->address, NULL));
 	}
 
+	manager_release_socket (self);
 	priv->state = STATE_PROBE_DONE;
 	g_signal_emit (self, signals[PROBE_TERMINATED], 0);
 
@@ -179,11 +437,7 @@ arping_timeout_cb (gpointer user_data)
 gboolean
 nm_arping_manager_start_probe (NMArpingManager *self, guint timeout, GError **error)
 {
-	const char *argv[] = { NULL, "-D", "-q", "-I", NULL, "-c", NULL, "-w", NULL, NULL, NULL };
 	NMArpingManagerPrivate *priv;
-	GHashTableIter iter;
-	AddressInfo *info;
-	gs_free char *timeout_str = NULL;
 
 	g_return_val_if_fail (NM_IS_ARPING_MANAGER (self), FALSE);
 	g_return_val_if_fail (!error || !*error, FALSE);
@@ -192,45 +446,17 @@ nm_arping_manager_start_probe (NMArpingManager *self, guint timeout, GError **er
 	priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 	g_return_val_if_fail (priv->state == STATE_INIT, FALSE);
 
-	argv[4] = nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex);
-	if (!argv[4]) {
-		/* The device was probably just removed. */
-		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		             "can't find a name for ifindex %d", priv->ifindex);
+	if (!manager_acquire_socket (self, error))
 		return FALSE;
-	}
 
 	priv->completed = 0;
+	priv->probes_sent = 0;
+	priv->socket->listeners = g_slist_prepend (priv->socket->listeners, self);
 
-	argv[0] = nm_utils_find_helper ("arping", NULL, NULL);
-	if (!argv[0]) {
-		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		                     "arping could not be found");
-		return FALSE;
-	}
-
-	timeout_str = g_strdup_printf ("%u", timeout / 1000 + 2);
-	argv[6] = timeout_str;
-	argv[8] = timeout_str;
-
-	g_hash_table_iter_init (&iter, priv->addresses);
-
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		gs_free char *tmp_str = NULL;
-		gboolean success;
-
-		argv[9] = nm_utils_inet4_ntop (info->address, NULL);
-		_LOGD ("run %s", (tmp_str = g_strjoinv (" ", (char **) argv)));
-
-		success = g_spawn_async (NULL, (char **) argv, NULL,
-		                         G_SPAWN_STDOUT_TO_DEV_NULL |
-		                         G_SPAWN_STDERR_TO_DEV_NULL |
-		                         G_SPAWN_DO_NOT_REAP_CHILD,
-		                         NULL, NULL, &info->pid, NULL);
-
-		info->watch = g_child_watch_add (info->pid, arping_watch_cb, info);
-	}
+	_LOGD ("probe %u addresses (timeout %u ms)", g_hash_table_size (priv->addresses), timeout);
 
+	probe_send (self);
+	priv->probe_id = g_timeout_add (MAX (timeout / PROBE_NUM, 1), probe_send_cb, self);
 	priv->timer = g_timeout_add (timeout, arping_timeout_cb, self);
 	priv->state = STATE_PROBING;
 
@@ -252,7 +478,9 @@ nm_arping_manager_reset (NMArpingManager *self)
 	priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 
 	nm_clear_g_source (&priv->timer);
+	nm_clear_g_source (&priv->probe_id);
 	nm_clear_g_source (&priv->round2_id);
+	manager_release_socket (self);
 	g_hash_table_remove_all (priv->addresses);
 
 	priv->state = STATE_INIT;
@@ -301,48 +529,23 @@ nm_arping_manager_check_address (NMArpingManager *self, in_addr_t address)
 }
 
 static void
-send_announcements (NMArpingManager *self, const char *mode_arg)
+send_announcements (NMArpingManager *self)
 {
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
-	const char *argv[] = { NULL, mode_arg, "-q", "-I", NULL, "-c", "1", NULL, NULL };
-	int ip_arg = G_N_ELEMENTS (argv) - 2;
-	GError *error = NULL;
 	GHashTableIter iter;
 	AddressInfo *info;
-
-	argv[4] = nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex);
-	if (!argv[4]) {
-		/* The device was probably just removed. */
-		_LOGW ("can't find a name for ifindex %d", priv->ifindex);
-		return;
-	}
-
-	argv[0] = nm_utils_find_helper ("arping", NULL, NULL);
-	if (!argv[0]) {
-		_LOGW ("arping could not be found; no ARPs will be sent");
-		return;
-	}
+	int r;
 
 	g_hash_table_iter_init (&iter, priv->addresses);
 
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		gs_free char *tmp_str = NULL;
-		gboolean success;
-
 		if (info->duplicate)
 			continue;
 
-		argv[ip_arg] = nm_utils_inet4_ntop (info->address, NULL);
-		_LOGD ("run %s", (tmp_str = g_strjoinv (" ", (char **) argv)));
-
-		success = g_spawn_async (NULL, (char **) argv, NULL,
-		                         G_SPAWN_STDOUT_TO_DEV_NULL |
-		                         G_SPAWN_STDERR_TO_DEV_NULL,
-		                         NULL, NULL, NULL, &error);
-		if (!success) {
-			_LOGW ("could not send ARP for address %s: %s", argv[ip_arg],
-			       error->message);
-			g_clear_error (&error);
+		r = arp_send_announcement (priv->socket->fd, priv->ifindex, info->address, &priv->hwaddr);
+		if (r < 0) {
+			_LOGW ("could not send ARP for address %s: %s",
+			       nm_utils_inet4_ntop (info->address, NULL), g_strerror (-r));
 		}
 	}
 }
@@ -353,7 +556,8 @@ arp_announce_round2 (gpointer self)
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 
 	priv->round2_id = 0;
-	send_announcements (self, "-U");
+	send_announcements (self);
+	manager_release_socket (self);
 	priv->state = STATE_INIT;
 	g_hash_table_remove_all (priv->addresses);
 
@@ -370,13 +574,21 @@ void
 nm_arping_manager_announce_addresses (NMArpingManager *self)
 {
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	GError *error = NULL;
 
 	g_return_if_fail (   priv->state == STATE_INIT
 	                  || priv->state == STATE_PROBE_DONE);
 
-	send_announcements (self, "-A");
+	if (!manager_acquire_socket (self, &error)) {
+		_LOGW ("no ARPs will be sent: %s", error->message);
+		g_clear_error (&error);
+		return;
+	}
+
+	/* like RFC 5227, send two announcements ANNOUNCE_INTERVAL_SEC apart. */
+	send_announcements (self);
 	nm_clear_g_source (&priv->round2_id);
-	priv->round2_id = g_timeout_add_seconds (2, arp_announce_round2, self);
+	priv->round2_id = g_timeout_add_seconds (ANNOUNCE_INTERVAL_SEC, arp_announce_round2, self);
 	priv->state = STATE_ANNOUNCING;
 }
 
@@ -385,13 +597,6 @@ destroy_address_info (gpointer data)
 {
 	AddressInfo *info = (AddressInfo *) data;
 
-	nm_clear_g_source (&info->watch);
-
-	if (info->pid) {
-		nm_utils_kill_child_async (info->pid, SIGTERM, LOGD_IP4, "arping",
-		                           1000, NULL, NULL);
-	}
-
 	g_slice_free (AddressInfo, info);
 }
 
@@ -402,8 +607,11 @@ dispose (GObject *object)
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 
 	nm_clear_g_source (&priv->timer);
+	nm_clear_g_source (&priv->probe_id);
 	nm_clear_g_source (&priv->round2_id);
+	manager_release_socket (self);
 	g_clear_pointer (&priv->addresses, g_hash_table_destroy);
+	g_clear_object (&priv->platform);
 
 	G_OBJECT_CLASS (nm_arping_manager_parent_class)->dispose (object);
 }
@@ -419,13 +627,16 @@ nm_arping_manager_init (NMArpingManager *self)
 }
 
 NMArpingManager *
-nm_arping_manager_new (int ifindex)
+nm_arping_manager_new (NMPlatform *platform, int ifindex)
 {
 	NMArpingManager *self;
 	NMArpingManagerPrivate *priv;
 
+	g_return_val_if_fail (NM_IS_PLATFORM (platform), NULL);
+
 	self = g_object_new (NM_TYPE_ARPING_MANAGER, NULL);
 	priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	priv->platform = g_object_ref (platform);
 	priv->ifindex = ifindex;
 
 	return self;
@@ -39,12 +39,14 @@
 #include "NetworkManagerUtils.h"
 #include "nm-manager.h"
 #include "nm-platform.h"
+#include "nmp-netns.h"
 #include "nm-rdisc.h"
 #include "nm-lndp-rdisc.h"
 #include "nm-dhcp-manager.h"
 #include "nm-activation-request.h"
 #include "nm-ip4-config.h"
 #include "nm-ip6-config.h"
+#include "nm-ip-config-deltas.h"
 #include "nm-dnsmasq-manager.h"
 #include "nm-dhcp4-config.h"
 #include "nm-dhcp6-config.h"
@@ -201,11 +203,17 @@ typedef struct _NMDevicePrivate {
 	guint device_link_changed_id;
 	guint device_ip_link_changed_id;
 
+	/* platform events for the ifindex and, if it differs, the ip-ifindex. */
+	NMPlatformIfindexWatch *platform_watch;
+	NMPlatformIfindexWatch *platform_watch_ip;
+
 	NMDeviceState state;
 	NMDeviceStateReason state_reason;
 	QueuedState   queued_state;
 	guint queued_ip4_config_id;
 	guint queued_ip6_config_id;
+	NMIPConfigDeltas ip4_deltas;
+	NMIPConfigDeltas ip6_deltas;
 	GSList *pending_actions;
 	GSList *dad6_failed_addrs;
 
@@ -280,6 +288,7 @@ typedef struct _NMDevicePrivate {
 	NMIP4Config *   con_ip4_config; /* config from the setting */
 	NMIP4Config *   dev_ip4_config; /* Config from DHCP, PPP, LLv4, etc */
 	NMIP4Config *   ext_ip4_config; /* Stuff added outside NM */
+	NMIP4Config *   ext_ip4_config_captured; /* Configuration captured from platform, kept while route changes are replayed. */
 	NMIP4Config *   wwan_ip4_config; /* WWAN configuration */
 	GSList *        vpn4_configs;   /* VPNs which use this device */
 	struct {
@@ -421,6 +430,7 @@ static NMActStageReturn dhcp4_start (NMDevice *self, NMConnection *connection, N
 static gboolean dhcp6_start (NMDevice *self, gboolean wait_for_ll, NMDeviceStateReason *reason);
 static void nm_device_start_ip_check (NMDevice *self);
 static void realize_start_setup (NMDevice *self, const NMPlatformLink *plink);
+static void _platform_watch_update (NMDevice *self);
 
 /***********************************************************/
 
@@ -643,6 +653,7 @@ nm_device_set_ip_iface (NMDevice *self, const char *iface)
 	priv->ip_iface = g_strdup (iface);
 	if (priv->ip_iface) {
 		priv->ip_ifindex = nm_platform_link_get_ifindex (nm_device_get_platform(self), priv->ip_iface);
+		_platform_watch_update (self);
 		if (priv->ip_ifindex > 0) {
 			if (nm_platform_check_support_user_ipv6ll (nm_device_get_platform(self)))
 				nm_platform_link_set_user_ipv6ll_enabled (nm_device_get_platform(self), priv->ip_ifindex, TRUE);
@@ -654,6 +665,7 @@ nm_device_set_ip_iface (NMDevice *self, const char *iface)
 			_LOGW (LOGD_HW, "failed to look up interface index");
 		}
 	}
+	_platform_watch_update (self);
 
 	/* We don't care about any saved values from the old iface */
 	g_hash_table_remove_all (priv->ip6_saved_properties);
@@ -1782,6 +1794,7 @@ update_device_from_platform_link (NMDevice *self, const NMPlatformLink *plink)
 	}
 
 	priv->ifindex = plink->ifindex;
+	_platform_watch_update (self);
 	_notify (self, PROP_IFINDEX);
 
 	priv->up = NM_FLAGS_HAS (plink->n_ifi_flags, IFF_UP);
@@ -1899,6 +1912,8 @@ realize_start_setup (NMDevice *self, const NMPlatformLink *plink)
 	}
 
 	/* trigger initial ip config change to initialize ip-config */
+	nm_ip_config_deltas_reset (&priv->ip4_deltas, TRUE);
+	nm_ip_config_deltas_reset (&priv->ip6_deltas, TRUE);
 	priv->queued_ip4_config_id = g_idle_add (queued_ip4_config_change, self);
 	priv->queued_ip6_config_id = g_idle_add (queued_ip6_config_change, self);
 
@@ -2074,6 +2089,7 @@ nm_device_unrealize (NMDevice *self, gboolean remove_resources, GError **error)
 		g_clear_pointer (&priv->ip_iface, g_free);
 		_notify (self, PROP_IP_IFACE);
 	}
+	_platform_watch_update (self);
 	if (priv->driver_version) {
 		g_clear_pointer (&priv->driver_version, g_free);
 		_notify (self, PROP_DRIVER_VERSION);
@@ -3837,7 +3853,7 @@ ipv4_dad_start (NMDevice *self, NMIP4Config **configs, ArpingCallback cb)
 	/* don't take additional references of @arping_manager that outlive @self.
 	 * Otherwise, the callback can be invoked on a dangling pointer as we don't
 	 * disconnect the handler. */
-	arping_manager = nm_arping_manager_new (nm_device_get_ip_ifindex (self));
+	arping_manager = nm_arping_manager_new (nm_device_get_platform (self), nm_device_get_ip_ifindex (self));
 	priv->arping.dad_list = g_slist_append (priv->arping.dad_list, arping_manager);
 
 	data = g_slice_new0 (ArpingData);
@@ -4221,6 +4237,11 @@ ip4_config_merge_and_apply (NMDevice *self,
 	gboolean ignore_auto_routes = FALSE;
 	gboolean ignore_auto_dns = FALSE;
 
+	/* The internal configurations might have changed, which affects how the
+	 * external one is computed from platform. */
+	if (!priv->ip4_deltas.updating)
+		priv->ip4_deltas.need_full = TRUE;
+
 	/* Merge all the configs into the composite config */
 	if (config) {
 		g_clear_object (&priv->dev_ip4_config);
@@ -4584,19 +4605,27 @@ dhcp4_start (NMDevice *self,
 
 	/* Begin DHCP on the interface */
 	g_warn_if_fail (priv->dhcp4_client == NULL);
-	priv->dhcp4_client = nm_dhcp_manager_start_ip4 (nm_dhcp_manager_get (),
-	                                                nm_device_get_ip_iface (self),
-	                                                nm_device_get_ip_ifindex (self),
-	                                                tmp,
-	                                                nm_connection_get_uuid (connection),
-	                                                nm_device_get_ip4_route_metric (self),
-	                                                nm_setting_ip_config_get_dhcp_send_hostname (s_ip4),
-	                                                nm_setting_ip_config_get_dhcp_hostname (s_ip4),
-	                                                nm_setting_ip4_config_get_dhcp_fqdn (NM_SETTING_IP4_CONFIG (s_ip4)),
-	                                                nm_setting_ip4_config_get_dhcp_client_id (NM_SETTING_IP4_CONFIG (s_ip4)),
-	                                                dhcp4_get_timeout (self, NM_SETTING_IP4_CONFIG (s_ip4)),
-	                                                priv->dhcp_anycast_address,
-	                                                NULL);
+	{
+		nm_auto_pop_netns NMPNetns *netns = NULL;
+
+		/* The client opens its sockets and picks its event loop in the
+		 * current namespace, which must be the device's. */
+		if (nm_platform_netns_push (nm_device_get_platform (self), &netns)) {
+			priv->dhcp4_client = nm_dhcp_manager_start_ip4 (nm_dhcp_manager_get (),
+			                                                nm_device_get_ip_iface (self),
+			                                                nm_device_get_ip_ifindex (self),
+			                                                tmp,
+			                                                nm_connection_get_uuid (connection),
+			                                                nm_device_get_ip4_route_metric (self),
+			                                                nm_setting_ip_config_get_dhcp_send_hostname (s_ip4),
+			                                                nm_setting_ip_config_get_dhcp_hostname (s_ip4),
+			                                                nm_setting_ip4_config_get_dhcp_fqdn (NM_SETTING_IP4_CONFIG (s_ip4)),
+			                                                nm_setting_ip4_config_get_dhcp_client_id (NM_SETTING_IP4_CONFIG (s_ip4)),
+			                                                dhcp4_get_timeout (self, NM_SETTING_IP4_CONFIG (s_ip4)),
+			                                                priv->dhcp_anycast_address,
+			                                                NULL);
+		}
+	}
 
 	if (tmp)
 		g_byte_array_free (tmp, TRUE);
@@ -4941,6 +4970,11 @@ ip6_config_merge_and_apply (NMDevice *self,
 	gboolean ignore_auto_routes = FALSE;
 	gboolean ignore_auto_dns = FALSE;
 
+	/* The internal configurations might have changed, which affects how the
+	 * external one is computed from platform. */
+	if (!priv->ip6_deltas.updating)
+		priv->ip6_deltas.need_full = TRUE;
+
 	/* Apply ignore-auto-routes and ignore-auto-dns settings */
 	connection = nm_device_get_applied_connection (self);
 	if (connection) {
@@ -5310,19 +5344,26 @@ dhcp6_start_with_link_ready (NMDevice *self, NMConnection *connection)
 
 	g_return_val_if_fail (ll_addr, FALSE);
 
-	priv->dhcp6_client = nm_dhcp_manager_start_ip6 (nm_dhcp_manager_get (),
-	                                                nm_device_get_ip_iface (self),
-	                                                nm_device_get_ip_ifindex (self),
-	                                                tmp,
-	                                                &ll_addr->address,
-	                                                nm_connection_get_uuid (connection),
-	                                                nm_device_get_ip6_route_metric (self),
-	                                                nm_setting_ip_config_get_dhcp_send_hostname (s_ip6),
-	                                                nm_setting_ip_config_get_dhcp_hostname (s_ip6),
-	                                                priv->dhcp_timeout,
-	                                                priv->dhcp_anycast_address,
-	                                                (priv->dhcp6_mode == NM_RDISC_DHCP_LEVEL_OTHERCONF) ? TRUE : FALSE,
-	                                                nm_setting_ip6_config_get_ip6_privacy (NM_SETTING_IP6_CONFIG (s_ip6)));
+	{
+		nm_auto_pop_netns NMPNetns *netns = NULL;
+
+		/* see dhcp4_start() */
+		if (nm_platform_netns_push (nm_device_get_platform (self), &netns)) {
+			priv->dhcp6_client = nm_dhcp_manager_start_ip6 (nm_dhcp_manager_get (),
+			                                                nm_device_get_ip_iface (self),
+			                                                nm_device_get_ip_ifindex (self),
+			                                                tmp,
+			                                                &ll_addr->address,
+			                                                nm_connection_get_uuid (connection),
+			                                                nm_device_get_ip6_route_metric (self),
+			                                                nm_setting_ip_config_get_dhcp_send_hostname (s_ip6),
+			                                                nm_setting_ip_config_get_dhcp_hostname (s_ip6),
+			                                                priv->dhcp_timeout,
+			                                                priv->dhcp_anycast_address,
+			                                                (priv->dhcp6_mode == NM_RDISC_DHCP_LEVEL_OTHERCONF) ? TRUE : FALSE,
+			                                                nm_setting_ip6_config_get_ip6_privacy (NM_SETTING_IP6_CONFIG (s_ip6)));
+		}
+	}
 	if (tmp)
 		g_byte_array_free (tmp, TRUE);
 
@@ -6690,7 +6731,7 @@ arp_announce (NMDevice *self)
 	if (num == 0)
 		return;
 
-	priv->arping.announcing = nm_arping_manager_new (nm_device_get_ip_ifindex (self));
+	priv->arping.announcing = nm_arping_manager_new (nm_device_get_platform (self), nm_device_get_ip_ifindex (self));
 
 	for (i = 0; i < num; i++) {
 		NMIPAddress *ip = nm_setting_ip_config_get_address (s_ip4, i);
@@ -6780,6 +6821,9 @@ queued_ip4_config_change_clear (NMDevice *self)
 		_LOGD (LOGD_DEVICE, "clearing queued IP4 config change");
 		g_source_remove (priv->queued_ip4_config_id);
 		priv->queued_ip4_config_id = 0;
+
+		/* the pending changes are lost, resync on the next one. */
+		nm_ip_config_deltas_reset (&priv->ip4_deltas, TRUE);
 	}
 }
 
@@ -6792,6 +6836,9 @@ queued_ip6_config_change_clear (NMDevice *self)
 		_LOGD (LOGD_DEVICE, "clearing queued IP6 config change");
 		g_source_remove (priv->queued_ip6_config_id);
 		priv->queued_ip6_config_id = 0;
+
+		/* the pending changes are lost, resync on the next one. */
+		nm_ip_config_deltas_reset (&priv->ip6_deltas, TRUE);
 	}
 }
 
@@ -8715,7 +8762,7 @@ _ip4_config_subtract (gpointer value, gpointer user_data)
 }
 
 static void
-update_ip4_config (NMDevice *self, gboolean initial)
+update_ip4_config (NMDevice *self, gboolean initial, gboolean keep_captured)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	int ifindex;
@@ -8729,10 +8776,19 @@ update_ip4_config (NMDevice *self, gboolean initial)
 	resolv_conf_mode = nm_dns_manager_get_resolv_conf_mode (nm_dns_manager_get ());
 	capture_resolv_conf = initial && (resolv_conf_mode == NM_DNS_MANAGER_RESOLV_CONF_EXPLICIT);
 
+	/* the capture includes all changes that happened so far. */
+	nm_ip_config_deltas_reset (&priv->ip4_deltas, FALSE);
+
 	/* IPv4 */
 	g_clear_object (&priv->ext_ip4_config);
+	g_clear_object (&priv->ext_ip4_config_captured);
 	priv->ext_ip4_config = nm_ip4_config_capture (nm_device_get_netns(self), ifindex, capture_resolv_conf);
 	if (priv->ext_ip4_config) {
+		/* The captured configuration is only needed to replay route changes
+		 * later. Only pay for the copy if route changes brought us here. */
+		if (keep_captured)
+			priv->ext_ip4_config_captured = nm_ip4_config_new_cloned (priv->ext_ip4_config);
+
 		if (initial) {
 			g_clear_object (&priv->dev_ip4_config);
 			capture_lease_config (self, priv->ext_ip4_config, &priv->dev_ip4_config, NULL, NULL);
@@ -8770,8 +8826,95 @@ update_ip4_config (NMDevice *self, gboolean initial)
 		if (priv->wwan_ip4_config)
 			nm_ip4_config_subtract (priv->ext_ip4_config, priv->wwan_ip4_config);
 
+		priv->ip4_deltas.updating = TRUE;
 		ip4_config_merge_and_apply (self, NULL, FALSE, NULL);
+		priv->ip4_deltas.updating = FALSE;
+	}
+}
+
+static gboolean
+_ip4_config_has_internal_route (NMDevice *self, const NMPlatformIP4Route *route)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GSList *iter;
+
+	if (priv->con_ip4_config && nm_ip4_config_lookup_route (priv->con_ip4_config, route))
+		return TRUE;
+	if (priv->dev_ip4_config && nm_ip4_config_lookup_route (priv->dev_ip4_config, route))
+		return TRUE;
+	for (iter = priv->vpn4_configs; iter; iter = iter->next) {
+		if (nm_ip4_config_lookup_route (iter->data, route))
+			return TRUE;
 	}
+	if (priv->wwan_ip4_config && nm_ip4_config_lookup_route (priv->wwan_ip4_config, route))
+		return TRUE;
+	return FALSE;
+}
+
+static void
+_ip4_config_remove_internal_route (NMDevice *self, const NMPlatformIP4Route *route)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GSList *iter;
+
+	if (priv->con_ip4_config)
+		nm_ip4_config_remove_route (priv->con_ip4_config, route);
+	if (priv->dev_ip4_config)
+		nm_ip4_config_remove_route (priv->dev_ip4_config, route);
+	for (iter = priv->vpn4_configs; iter; iter = iter->next)
+		nm_ip4_config_remove_route (iter->data, route);
+	if (priv->wwan_ip4_config)
+		nm_ip4_config_remove_route (priv->wwan_ip4_config, route);
+}
+
+/* Like update_ip4_config(), but only replays the route changes that happened
+ * since the last update instead of capturing everything again. Returns %FALSE
+ * if that is not possible, in which case a full update is needed. */
+static gboolean
+update_ip4_config_from_deltas (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMIP4Config *captured = priv->ext_ip4_config_captured;
+	GArray *deltas = priv->ip4_deltas.routes;
+	guint i;
+
+	if (   priv->ip4_deltas.need_full
+	    || !deltas
+	    || !deltas->len
+	    || !captured
+	    || !priv->ext_ip4_config
+	    || nm_ip4_config_get_ifindex (captured) != nm_device_get_ip_ifindex (self))
+		return FALSE;
+
+	/* First bring the captured configuration up to date. */
+	if (!nm_ip_config_deltas_replay_ip4 (&priv->ip4_deltas, captured))
+		return FALSE;
+
+	/* Then do what intersect and subtract in update_ip4_config() would do,
+	 * but only for the changed routes. */
+	for (i = 0; i < deltas->len; i++) {
+		const NMIPRouteDelta *delta = &g_array_index (deltas, NMIPRouteDelta, i);
+		const NMPlatformIP4Route *route = &delta->r4;
+
+		if (route->source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL)
+			continue;
+
+		if (delta->change_type == NM_PLATFORM_SIGNAL_REMOVED) {
+			nm_ip4_config_remove_route (priv->ext_ip4_config, route);
+			_ip4_config_remove_internal_route (self, route);
+		} else if (_ip4_config_has_internal_route (self, route))
+			nm_ip4_config_remove_route (priv->ext_ip4_config, route);
+		else
+			nm_ip4_config_add_route (priv->ext_ip4_config, route);
+	}
+
+	_LOGD (LOGD_DEVICE, "updated IP4 config from %u route changes", deltas->len);
+	nm_ip_config_deltas_reset (&priv->ip4_deltas, FALSE);
+
+	priv->ip4_deltas.updating = TRUE;
+	ip4_config_merge_and_apply (self, NULL, FALSE, NULL);
+	priv->ip4_deltas.updating = FALSE;
+	return TRUE;
 }
 
 static void
@@ -8807,6 +8950,9 @@ update_ip6_config (NMDevice *self, gboolean initial)
 	resolv_conf_mode = nm_dns_manager_get_resolv_conf_mode (nm_dns_manager_get ());
 	capture_resolv_conf = initial && (resolv_conf_mode == NM_DNS_MANAGER_RESOLV_CONF_EXPLICIT);
 
+	/* the capture includes all changes that happened so far. */
+	nm_ip_config_deltas_reset (&priv->ip6_deltas, FALSE);
+
 	/* IPv6 */
 	g_clear_object (&priv->ext_ip6_config);
 	g_clear_object (&priv->ext_ip6_config_captured);
@@ -8842,7 +8988,9 @@ update_ip6_config (NMDevice *self, gboolean initial)
 			nm_ip6_config_subtract (priv->ext_ip6_config, priv->wwan_ip6_config);
 		g_slist_foreach (priv->vpn6_configs, _ip6_config_subtract, priv->ext_ip6_config);
 
+		priv->ip6_deltas.updating = TRUE;
 		ip6_config_merge_and_apply (self, FALSE, NULL);
+		priv->ip6_deltas.updating = FALSE;
 	}
 
 	if (   priv->linklocal6_timeout_id
@@ -8855,10 +9003,96 @@ update_ip6_config (NMDevice *self, gboolean initial)
 	}
 }
 
+static gboolean
+_ip6_config_has_internal_route (NMDevice *self, const NMPlatformIP6Route *route)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GSList *iter;
+
+	if (priv->con_ip6_config && nm_ip6_config_lookup_route (priv->con_ip6_config, route))
+		return TRUE;
+	if (priv->ac_ip6_config && nm_ip6_config_lookup_route (priv->ac_ip6_config, route))
+		return TRUE;
+	if (priv->dhcp6_ip6_config && nm_ip6_config_lookup_route (priv->dhcp6_ip6_config, route))
+		return TRUE;
+	if (priv->wwan_ip6_config && nm_ip6_config_lookup_route (priv->wwan_ip6_config, route))
+		return TRUE;
+	for (iter = priv->vpn6_configs; iter; iter = iter->next) {
+		if (nm_ip6_config_lookup_route (iter->data, route))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void
+_ip6_config_remove_internal_route (NMDevice *self, const NMPlatformIP6Route *route)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GSList *iter;
+
+	if (priv->con_ip6_config)
+		nm_ip6_config_remove_route (priv->con_ip6_config, route);
+	if (priv->ac_ip6_config)
+		nm_ip6_config_remove_route (priv->ac_ip6_config, route);
+	if (priv->dhcp6_ip6_config)
+		nm_ip6_config_remove_route (priv->dhcp6_ip6_config, route);
+	if (priv->wwan_ip6_config)
+		nm_ip6_config_remove_route (priv->wwan_ip6_config, route);
+	for (iter = priv->vpn6_configs; iter; iter = iter->next)
+		nm_ip6_config_remove_route (iter->data, route);
+}
+
+/* See update_ip4_config_from_deltas(). Address changes always need a full
+ * update, because the captured addresses are sorted and because they drive
+ * the link-local and DAD handling. */
+static gboolean
+update_ip6_config_from_deltas (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMIP6Config *captured = priv->ext_ip6_config_captured;
+	GArray *deltas = priv->ip6_deltas.routes;
+	guint i;
+
+	if (   priv->ip6_deltas.need_full
+	    || !deltas
+	    || !deltas->len
+	    || !captured
+	    || !priv->ext_ip6_config
+	    || nm_ip6_config_get_ifindex (captured) != nm_device_get_ip_ifindex (self))
+		return FALSE;
+
+	if (!nm_ip_config_deltas_replay_ip6 (&priv->ip6_deltas, captured))
+		return FALSE;
+
+	for (i = 0; i < deltas->len; i++) {
+		const NMIPRouteDelta *delta = &g_array_index (deltas, NMIPRouteDelta, i);
+		const NMPlatformIP6Route *route = &delta->r6;
+
+		if (route->source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL)
+			continue;
+
+		if (delta->change_type == NM_PLATFORM_SIGNAL_REMOVED) {
+			nm_ip6_config_remove_route (priv->ext_ip6_config, route);
+			_ip6_config_remove_internal_route (self, route);
+		} else if (_ip6_config_has_internal_route (self, route))
+			nm_ip6_config_remove_route (priv->ext_ip6_config, route);
+		else
+			nm_ip6_config_add_route (priv->ext_ip6_config, route);
+	}
+
+	_LOGD (LOGD_DEVICE, "updated IP6 config from %u route changes", deltas->len);
+	nm_ip_config_deltas_reset (&priv->ip6_deltas, FALSE);
+
+	priv->ip6_deltas.updating = TRUE;
+	ip6_config_merge_and_apply (self, FALSE, NULL);
+	priv->ip6_deltas.updating = FALSE;
+	return TRUE;
+}
+
 void
 nm_device_capture_initial_config (NMDevice *self)
 {
-	update_ip4_config (self, TRUE);
+	update_ip4_config (self, TRUE, FALSE);
 	update_ip6_config (self, TRUE);
 }
 
@@ -8867,6 +9101,7 @@ queued_ip4_config_change (gpointer user_data)
 {
 	NMDevice *self = NM_DEVICE (user_data);
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gboolean keep_captured;
 
 	/* Wait for any queued state changes */
 	if (priv->queued_state.id)
@@ -8874,7 +9109,11 @@ queued_ip4_config_change (gpointer user_data)
 
 	priv->queued_ip4_config_id = 0;
 	g_object_ref (self);
-	update_ip4_config (self, FALSE);
+	keep_captured =    !priv->ip4_deltas.need_full
+	                && priv->ip4_deltas.routes
+	                && priv->ip4_deltas.routes->len;
+	if (!update_ip4_config_from_deltas (self))
+		update_ip4_config (self, FALSE, keep_captured);
 	g_object_unref (self);
 
 	return FALSE;
@@ -8894,7 +9133,8 @@ queued_ip6_config_change (gpointer user_data)
 
 	priv->queued_ip6_config_id = 0;
 	g_object_ref (self);
-	update_ip6_config (self, FALSE);
+	if (!update_ip6_config_from_deltas (self))
+		update_ip6_config (self, FALSE);
 
 	if (   nm_platform_link_get (nm_device_get_platform(self), priv->ifindex)
 	    && priv->state < NM_DEVICE_STATE_DEACTIVATING) {
@@ -8952,7 +9192,11 @@ device_ipx_changed (NMPlatform *platform,
 
 	switch (obj_type) {
 	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+		nm_ip_config_deltas_reset (&priv->ip4_deltas, TRUE);
+		/* fallthrough */
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
+		if (obj_type == NMP_OBJECT_TYPE_IP4_ROUTE)
+			nm_ip_config_deltas_add_route (&priv->ip4_deltas, change_type, platform_object, sizeof (NMPlatformIP4Route));
 		if (!priv->queued_ip4_config_id) {
 			priv->queued_ip4_config_id = g_idle_add (queued_ip4_config_change, self);
 			_LOGD (LOGD_DEVICE, "queued IP4 config change");
@@ -8968,8 +9212,11 @@ device_ipx_changed (NMPlatform *platform,
 			priv->dad6_failed_addrs = g_slist_append (priv->dad6_failed_addrs,
 			                                          g_memdup (addr, sizeof (NMPlatformIP6Address)));
 		}
+		nm_ip_config_deltas_reset (&priv->ip6_deltas, TRUE);
 		/* fallthrough */
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		if (obj_type == NMP_OBJECT_TYPE_IP6_ROUTE)
+			nm_ip_config_deltas_add_route (&priv->ip6_deltas, change_type, platform_object, sizeof (NMPlatformIP6Route));
 		if (!priv->queued_ip6_config_id) {
 			priv->queued_ip6_config_id = g_idle_add (queued_ip6_config_change, self);
 			_LOGD (LOGD_DEVICE, "queued IP6 config change");
@@ -8980,6 +9227,62 @@ device_ipx_changed (NMPlatform *platform,
 	}
 }
 
+static void
+platform_ifindex_changed (NMPlatform *platform,
+                          NMPObjectType obj_type,
+                          int ifindex,
+                          gconstpointer platform_object,
+                          NMPlatformSignalChangeType change_type,
+                          gpointer user_data)
+{
+	NMDevice *self = user_data;
+
+	if (obj_type == NMP_OBJECT_TYPE_LINK)
+		link_changed_cb (platform, obj_type, ifindex, (NMPlatformLink *) platform_object, change_type, self);
+	else
+		device_ipx_changed (platform, obj_type, ifindex, (gpointer) platform_object, change_type, self);
+}
+
+static void
+_platform_watch_setup (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	nm_assert (!priv->platform_watch);
+
+	priv->platform_watch = nm_platform_ifindex_watch_add (nm_device_get_platform (self), 0, platform_ifindex_changed, self);
+	priv->platform_watch_ip = nm_platform_ifindex_watch_add (nm_device_get_platform (self), 0, platform_ifindex_changed, self);
+	_platform_watch_update (self);
+}
+
+static void
+_platform_watch_clear (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	if (priv->platform_watch) {
+		nm_platform_ifindex_watch_remove (nm_device_get_platform (self), priv->platform_watch);
+		nm_platform_ifindex_watch_remove (nm_device_get_platform (self), priv->platform_watch_ip);
+		priv->platform_watch = NULL;
+		priv->platform_watch_ip = NULL;
+	}
+}
+
+static void
+_platform_watch_update (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	int ip_ifindex;
+
+	if (!priv->platform_watch)
+		return;
+
+	ip_ifindex = nm_device_get_ip_ifindex (self);
+	nm_platform_ifindex_watch_set_ifindex (nm_device_get_platform (self), priv->platform_watch, priv->ifindex);
+	nm_platform_ifindex_watch_set_ifindex (nm_device_get_platform (self), priv->platform_watch_ip,
+	                                       ip_ifindex != priv->ifindex ? ip_ifindex : 0);
+}
+
 /*****************************************************************************/
 
 NM_UTILS_FLAGS2STR_DEFINE (nm_unmanaged_flags2str, NMUnmanagedFlags,
@@ -9981,6 +10284,7 @@ _cleanup_generic_post (NMDevice *self, CleanupType cleanup_type)
 	g_clear_object (&priv->con_ip4_config);
 	g_clear_object (&priv->dev_ip4_config);
 	g_clear_object (&priv->ext_ip4_config);
+	g_clear_object (&priv->ext_ip4_config_captured);
 	g_clear_object (&priv->wwan_ip4_config);
 	g_clear_object (&priv->ip4_config);
 	g_clear_object (&priv->con_ip6_config);
@@ -11003,10 +11307,17 @@ nm_device_set_netns (NMDevice *self, NMNetns *netns)
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 
 	if (priv->netns != netns) {
+		gboolean watching = !!priv->platform_watch;
+
+		/* the watches belong to the platform of the old namespace. */
+		if (watching)
+			_platform_watch_clear (self);
 		if (priv->netns)
 			g_object_unref(priv->netns);
 		priv->netns = netns;
 		g_object_ref(netns);
+		if (watching)
+			_platform_watch_setup (self);
 		g_object_notify (G_OBJECT (self), NM_DEVICE_NETNS);
 
 		nm_log_dbg (LOGD_NETNS, "Device %s(%d) assigned network namespace %s",
@@ -11108,12 +11419,8 @@ nm_device_connect_to_netns (NMDevice *self, NMNetns *netns)
 		}
 	}
 
-	/* Watch for external IP config changes */
-	g_signal_connect (nm_device_get_platform(self), NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (nm_device_get_platform(self), NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (nm_device_get_platform(self), NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (nm_device_get_platform(self), NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (nm_device_get_platform(self), NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK (link_changed_cb), self);
+	/* Watch for link changes and external IP config changes */
+	_platform_watch_setup (self);
 
 	priv->con_provider = nm_connection_provider_get ();
 	g_assert (priv->con_provider);
@@ -11190,7 +11497,6 @@ dispose (GObject *object)
 {
 	NMDevice *self = NM_DEVICE (object);
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
-	NMPlatform *platform;
 
 	_LOGD (LOGD_DEVICE, "disposing");
 
@@ -11234,9 +11540,7 @@ dispose (GObject *object)
 
 	_clear_queued_act_request (priv);
 
-	platform = nm_netns_get_platform (priv->netns);
-	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (device_ipx_changed), self);
-	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (link_changed_cb), self);
+	_platform_watch_clear (self);
 
 	nm_clear_g_source (&priv->device_link_changed_id);
 	nm_clear_g_source (&priv->device_ip_link_changed_id);
@@ -11272,6 +11576,8 @@ finalize (GObject *object)
 	g_free (priv->initial_hw_addr);
 	g_slist_free_full (priv->pending_actions, g_free);
 	g_slist_free_full (priv->dad6_failed_addrs, g_free);
+	nm_ip_config_deltas_clear (&priv->ip4_deltas);
+	nm_ip_config_deltas_clear (&priv->ip6_deltas);
 	g_clear_pointer (&priv->physical_port_id, g_free);
 	g_free (priv->udi);
 	g_free (priv->iface);
@@ -20,6 +20,10 @@
 
 #include "nm-default.h"
 
+#include <netinet/if_ether.h>
+#include <netpacket/packet.h>
+#include <sys/socket.h>
+
 #include "nm-arping-manager.h"
 #include "test-common.h"
 
@@ -67,12 +71,7 @@ test_arping_common (test_fixture *fixture, TestInfo *info)
 	GMainLoop *loop;
 	int i;
 
-	if (!nm_utils_find_helper ("arping", NULL, NULL)) {
-		g_test_skip ("arping binary is missing");
-		return;
-	}
-
-	manager = nm_arping_manager_new (fixture->ifindex0);
+	manager = nm_arping_manager_new (NM_PLATFORM_GET, fixture->ifindex0);
 	g_assert (manager != NULL);
 
 	for (i = 0; info->addresses[i]; i++)
@@ -118,6 +117,115 @@ test_arping_2 (test_fixture *fixture, gconstpointer user_data)
 	test_arping_common (fixture, &info);
 }
 
+typedef struct {
+	GMainLoop *loop;
+	guint n_pending;
+} ManyData;
+
+static void
+_many_probe_terminated (NMArpingManager *arping_manager, ManyData *data)
+{
+	if (--data->n_pending == 0)
+		g_main_loop_quit (data->loop);
+}
+
+static void
+test_arping_many (test_fixture *fixture, gconstpointer user_data)
+{
+	gs_unref_object NMArpingManager *manager1 = NULL;
+	gs_unref_object NMArpingManager *manager2 = NULL;
+	ManyData data = { .n_pending = 2 };
+	guint i;
+
+	/* two managers probe many addresses on the same interface at the same
+	 * time, sharing one packet socket. */
+	manager1 = nm_arping_manager_new (NM_PLATFORM_GET, fixture->ifindex0);
+	manager2 = nm_arping_manager_new (NM_PLATFORM_GET, fixture->ifindex0);
+
+	for (i = 1; i <= 64; i++) {
+		in_addr_t addr = htonl (0x0a000000 + i);
+
+		g_assert (nm_arping_manager_add_address (i % 2 ? manager1 : manager2, addr));
+		if (i % 8 == 0) {
+			nmtstp_ip4_address_add (FALSE, fixture->ifindex1, addr,
+			                        24, 0, 3600, 1800, 0, NULL);
+		}
+	}
+
+	data.loop = g_main_loop_new (NULL, FALSE);
+	g_signal_connect (manager1, NM_ARPING_MANAGER_PROBE_TERMINATED,
+	                  G_CALLBACK (_many_probe_terminated), &data);
+	g_signal_connect (manager2, NM_ARPING_MANAGER_PROBE_TERMINATED,
+	                  G_CALLBACK (_many_probe_terminated), &data);
+	g_assert (nm_arping_manager_start_probe (manager1, 200, NULL));
+	g_assert (nm_arping_manager_start_probe (manager2, 300, NULL));
+	g_assert (nmtst_main_loop_run (data.loop, 1000));
+
+	for (i = 1; i <= 64; i++) {
+		g_assert_cmpint (nm_arping_manager_check_address (i % 2 ? manager1 : manager2, htonl (0x0a000000 + i)),
+		                 ==,
+		                 i % 8 != 0);
+	}
+
+	g_main_loop_unref (data.loop);
+}
+
+static void
+test_arping_announce (test_fixture *fixture, gconstpointer user_data)
+{
+	gs_unref_object NMArpingManager *manager = NULL;
+	union {
+		struct sockaddr sa;
+		struct sockaddr_ll ll;
+	} link = {
+		.ll.sll_family = AF_PACKET,
+		.ll.sll_protocol = htons (ETH_P_ARP),
+		.ll.sll_ifindex = fixture->ifindex1,
+	};
+	in_addr_t addresses[] = { ADDR1, ADDR2, ADDR3 };
+	guint n_seen[G_N_ELEMENTS (addresses)] = { 0 };
+	gint64 end_us;
+	int fd;
+	guint i;
+
+	/* listen on the peer for the gratuitous ARPs. */
+	fd = socket (PF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	g_assert_cmpint (fd, >=, 0);
+	g_assert_cmpint (bind (fd, &link.sa, sizeof (link.ll)), ==, 0);
+
+	manager = nm_arping_manager_new (NM_PLATFORM_GET, fixture->ifindex0);
+	for (i = 0; i < G_N_ELEMENTS (addresses); i++)
+		g_assert (nm_arping_manager_add_address (manager, addresses[i]));
+
+	nm_arping_manager_announce_addresses (manager);
+
+	/* the first round is sent right away. */
+	end_us = g_get_monotonic_time () + 500 * 1000;
+	while (g_get_monotonic_time () < end_us) {
+		struct ether_arp arp;
+		in_addr_t spa, tpa;
+
+		g_main_context_iteration (NULL, FALSE);
+
+		while (recv (fd, &arp, sizeof (arp), 0) == sizeof (arp)) {
+			memcpy (&spa, arp.arp_spa, sizeof (spa));
+			memcpy (&tpa, arp.arp_tpa, sizeof (tpa));
+			if (spa != tpa)
+				continue;
+			for (i = 0; i < G_N_ELEMENTS (addresses); i++) {
+				if (addresses[i] == spa)
+					n_seen[i]++;
+			}
+		}
+		g_usleep (10000);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (addresses); i++)
+		g_assert_cmpint (n_seen[i], ==, 1);
+
+	close (fd);
+}
+
 static void
 fixture_teardown (test_fixture *fixture, gconstpointer user_data)
 {
@@ -136,4 +244,6 @@ setup_tests (void)
 {
 	g_test_add ("/arping/1", test_fixture, NULL, fixture_setup, test_arping_1, fixture_teardown);
 	g_test_add ("/arping/2", test_fixture, NULL, fixture_setup, test_arping_2, fixture_teardown);
+	g_test_add ("/arping/many", test_fixture, NULL, fixture_setup, test_arping_many, fixture_teardown);
+	g_test_add ("/arping/announce", test_fixture, NULL, fixture_setup, test_arping_announce, fixture_teardown);
 }
@@ -94,6 +94,9 @@ struct _NMDeviceWifiPrivate {
 	gint8             invalid_strength_counter;
 
 	GHashTable *      aps;
+	GHashTable *      aps_by_supplicant_path;
+	GHashTable *      aps_by_ssid;    /* built on demand, NULL when stale */
+	GPtrArray *       aps_sorted;     /* built on demand, NULL when stale */
 	NMAccessPoint *   current_ap;
 	guint32           rate;
 	gboolean          enabled; /* rfkilled or not */
@@ -276,17 +279,61 @@ get_ap_by_path (NMDeviceWifi *self, const char *path)
 static NMAccessPoint *
 get_ap_by_supplicant_path (NMDeviceWifi *self, const char *path)
 {
-	GHashTableIter iter;
-	NMAccessPoint *ap;
-
 	g_return_val_if_fail (path != NULL, NULL);
+	return g_hash_table_lookup (NM_DEVICE_WIFI_GET_PRIVATE (self)->aps_by_supplicant_path, path);
+}
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-		if (g_strcmp0 (path, nm_ap_get_supplicant_path (ap)) == 0)
-			return ap;
+static GBytes *
+ssid_key_new (const guint8 *ssid, gsize len)
+{
+	/* Same as nm_utils_same_ssid() with @ignore_trailing_null */
+	if (len && ssid[len - 1] == '\0')
+		len--;
+	return g_bytes_new (ssid, len);
+}
+
+static GPtrArray *
+get_aps_by_ssid (NMDeviceWifi *self, GBytes *ssid)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	gs_unref_bytes GBytes *key = NULL;
+
+	if (!priv->aps_by_ssid) {
+		GHashTableIter iter;
+		NMAccessPoint *ap;
+		const GByteArray *ap_ssid;
+		GBytes *ap_key;
+		GPtrArray *aps;
+
+		priv->aps_by_ssid = g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+		                                           (GDestroyNotify) g_bytes_unref,
+		                                           (GDestroyNotify) g_ptr_array_unref);
+		g_hash_table_iter_init (&iter, priv->aps);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
+			ap_ssid = nm_ap_get_ssid (ap);
+			if (!ap_ssid)
+				continue;
+
+			ap_key = ssid_key_new (ap_ssid->data, ap_ssid->len);
+			aps = g_hash_table_lookup (priv->aps_by_ssid, ap_key);
+			if (aps)
+				g_bytes_unref (ap_key);
+			else {
+				aps = g_ptr_array_new ();
+				g_hash_table_insert (priv->aps_by_ssid, ap_key, aps);
+			}
+			g_ptr_array_add (aps, ap);
+		}
 	}
-	return NULL;
+
+	key = ssid_key_new (g_bytes_get_data (ssid, NULL), g_bytes_get_size (ssid));
+	return g_hash_table_lookup (priv->aps_by_ssid, key);
+}
+
+static void
+ap_ssid_changed_cb (NMAccessPoint *ap, GParamSpec *pspec, NMDeviceWifi *self)
+{
+	g_clear_pointer (&NM_DEVICE_WIFI_GET_PRIVATE (self)->aps_by_ssid, g_hash_table_unref);
 }
 
 static void
@@ -423,16 +470,32 @@ ap_add_remove (NMDeviceWifi *self,
 
 	nm_assert (NM_IN_SET (signum, ACCESS_POINT_ADDED, ACCESS_POINT_REMOVED));
 
+	/* The SSID index and the sorted view are rebuilt on next use */
+	g_clear_pointer (&priv->aps_by_ssid, g_hash_table_unref);
+	g_clear_pointer (&priv->aps_sorted, g_ptr_array_unref);
+
 	if (signum == ACCESS_POINT_ADDED) {
 		g_hash_table_insert (priv->aps,
 		                     (gpointer) nm_exported_object_export ((NMExportedObject *) ap),
 		                     g_object_ref (ap));
+		if (nm_ap_get_supplicant_path (ap)) {
+			g_hash_table_insert (priv->aps_by_supplicant_path,
+			                     (gpointer) nm_ap_get_supplicant_path (ap),
+			                     ap);
+		}
+		g_signal_connect (ap, "notify::" NM_AP_SSID, G_CALLBACK (ap_ssid_changed_cb), self);
 	}
 
 	g_signal_emit (self, signals[signum], 0, ap);
 	g_object_notify (G_OBJECT (self), NM_DEVICE_WIFI_ACCESS_POINTS);
 
 	if (signum == ACCESS_POINT_REMOVED) {
+		const char *supplicant_path = nm_ap_get_supplicant_path (ap);
+
+		if (   supplicant_path
+		    && g_hash_table_lookup (priv->aps_by_supplicant_path, supplicant_path) == ap)
+			g_hash_table_remove (priv->aps_by_supplicant_path, supplicant_path);
+		g_signal_handlers_disconnect_by_func (ap, G_CALLBACK (ap_ssid_changed_cb), self);
 		g_hash_table_remove (priv->aps, nm_exported_object_get_path ((NMExportedObject *) ap));
 		nm_exported_object_unexport ((NMExportedObject *) ap);
 		g_object_unref (ap);
@@ -615,14 +678,41 @@ find_first_compatible_ap (NMDeviceWifi *self,
                           NMConnection *connection,
                           gboolean allow_unstable_order)
 {
+	NMSettingWireless *s_wifi;
+	GBytes *ssid;
 	GHashTableIter iter;
+	GPtrArray *aps;
 	NMAccessPoint *ap;
 	NMAccessPoint *cand_ap = NULL;
+	guint i;
 
 	g_return_val_if_fail (connection != NULL, NULL);
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
+	s_wifi = nm_connection_get_setting_wireless (connection);
+	if (!s_wifi)
+		return NULL;
+
+	ssid = nm_setting_wireless_get_ssid (s_wifi);
+	if (!ssid) {
+		/* Only APs without SSID can match, which are not indexed */
+		g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
+			if (!nm_ap_check_compatible (ap, connection))
+				continue;
+			if (allow_unstable_order)
+				return ap;
+			if (!cand_ap || (nm_ap_get_id (cand_ap) < nm_ap_get_id (ap)))
+				cand_ap = ap;
+		}
+		return cand_ap;
+	}
+
+	aps = get_aps_by_ssid (self, ssid);
+	if (!aps)
+		return NULL;
+
+	for (i = 0; i < aps->len; i++) {
+		ap = aps->pdata[i];
 		if (!nm_ap_check_compatible (ap, connection))
 			continue;
 		if (allow_unstable_order)
@@ -958,44 +1048,50 @@ can_auto_connect (NMDevice *device,
 }
 
 static gint
-ap_id_compare (NMAccessPoint *a, NMAccessPoint *b)
+ap_id_compare (gconstpointer p_a, gconstpointer p_b)
 {
-	guint32 a_id = nm_ap_get_id (a);
-	guint32 b_id = nm_ap_get_id (b);
+	guint32 a_id = nm_ap_get_id (*((NMAccessPoint **) p_a));
+	guint32 b_id = nm_ap_get_id (*((NMAccessPoint **) p_b));
 
 	return a_id < b_id ? -1 : (a_id == b_id ? 0 : 1);
 }
 
-static GSList *
+/* Returns the APs sorted by id. The array is owned by @self and only
+ * rebuilt after the set of APs changed. */
+static const GPtrArray *
 get_sorted_ap_list (NMDeviceWifi *self)
 {
-	GSList *sorted = NULL;
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	GHashTableIter iter;
 	NMAccessPoint *ap;
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap))
-		sorted = g_slist_prepend (sorted, ap);
-	return g_slist_sort (sorted, (GCompareFunc) ap_id_compare);
+	if (!priv->aps_sorted) {
+		priv->aps_sorted = g_ptr_array_sized_new (g_hash_table_size (priv->aps));
+		g_hash_table_iter_init (&iter, priv->aps);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap))
+			g_ptr_array_add (priv->aps_sorted, ap);
+		g_ptr_array_sort (priv->aps_sorted, ap_id_compare);
+	}
+	return priv->aps_sorted;
 }
 
 static void
 impl_device_wifi_get_access_points (NMDeviceWifi *self,
                                     GDBusMethodInvocation *context)
 {
-	GSList *sorted, *iter;
+	const GPtrArray *sorted;
 	GPtrArray *paths;
+	guint i;
 
-	paths = g_ptr_array_new ();
 	sorted = get_sorted_ap_list (self);
-	for (iter = sorted; iter; iter = iter->next) {
-		NMAccessPoint *ap = NM_AP (iter->data);
+	paths = g_ptr_array_sized_new (sorted->len + 1);
+	for (i = 0; i < sorted->len; i++) {
+		NMAccessPoint *ap = NM_AP (sorted->pdata[i]);
 
 		if (nm_ap_get_ssid (ap))
 			g_ptr_array_add (paths, g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (ap))));
 	}
 	g_ptr_array_add (paths, NULL);
-	g_slist_free (sorted);
 
 	g_dbus_method_invocation_return_value (context, g_variant_new ("(^ao)", (char **) paths->pdata));
 	g_ptr_array_unref (paths);
@@ -1005,15 +1101,15 @@ static void
 impl_device_wifi_get_all_access_points (NMDeviceWifi *self,
                                         GDBusMethodInvocation *context)
 {
-	GSList *sorted, *iter;
+	const GPtrArray *sorted;
 	GPtrArray *paths;
+	guint i;
 
-	paths = g_ptr_array_new ();
 	sorted = get_sorted_ap_list (self);
-	for (iter = sorted; iter; iter = iter->next)
-		g_ptr_array_add (paths, g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (iter->data))));
+	paths = g_ptr_array_sized_new (sorted->len + 1);
+	for (i = 0; i < sorted->len; i++)
+		g_ptr_array_add (paths, g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (sorted->pdata[i]))));
 	g_ptr_array_add (paths, NULL);
-	g_slist_free (sorted);
 
 	g_dbus_method_invocation_return_value (context, g_variant_new ("(^ao)", (char **) paths->pdata));
 	g_ptr_array_unref (paths);
@@ -1430,7 +1526,8 @@ ap_list_dump (gpointer user_data)
 {
 	NMDeviceWifi *self = NM_DEVICE_WIFI (user_data);
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	GSList *sorted, *iter;
+	const GPtrArray *sorted;
+	guint i;
 
 	priv->ap_dump_id = 0;
 	_LOGD (LOGD_WIFI_SCAN, "APs: [now:%u last:%u next:%u]",
@@ -1438,9 +1535,8 @@ ap_list_dump (gpointer user_data)
 	       priv->last_scan,
 	       priv->scheduled_scan_time);
 	sorted = get_sorted_ap_list (self);
-	for (iter = sorted; iter; iter = iter->next)
-		nm_ap_dump (NM_AP (iter->data), "dump    ", nm_device_get_iface (NM_DEVICE (self)));
-	g_slist_free (sorted);
+	for (i = 0; i < sorted->len; i++)
+		nm_ap_dump (NM_AP (sorted->pdata[i]), "dump    ", nm_device_get_iface (NM_DEVICE (self)));
 	return G_SOURCE_REMOVE;
 }
 
@@ -2926,6 +3022,7 @@ nm_device_wifi_init (NMDeviceWifi *self)
 
 	priv->mode = NM_802_11_MODE_INFRA;
 	priv->aps = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->aps_by_supplicant_path = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -2954,8 +3051,12 @@ finalize (GObject *object)
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	nm_assert (g_hash_table_size (priv->aps) == 0);
+	nm_assert (g_hash_table_size (priv->aps_by_supplicant_path) == 0);
 
 	g_hash_table_unref (priv->aps);
+	g_hash_table_unref (priv->aps_by_supplicant_path);
+	g_clear_pointer (&priv->aps_by_ssid, g_hash_table_unref);
+	g_clear_pointer (&priv->aps_sorted, g_ptr_array_unref);
 
 	G_OBJECT_CLASS (nm_device_wifi_parent_class)->finalize (object);
 }
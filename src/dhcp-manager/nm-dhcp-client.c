@@ -745,12 +745,11 @@ maybe_add_option (GHashTable *hash,
 }
 
 gboolean
-nm_dhcp_client_handle_event (gpointer unused,
+nm_dhcp_client_handle_event (NMDhcpClient *self,
                              const char *iface,
                              gint pid,
                              GVariant *options,
-                             const char *reason,
-                             NMDhcpClient *self)
+                             const char *reason)
 {
 	NMDhcpClientPrivate *priv;
 	guint32 old_state;
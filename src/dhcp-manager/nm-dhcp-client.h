@@ -163,12 +163,11 @@ void nm_dhcp_client_set_state (NMDhcpClient *self,
                                GObject *ip_config,   /* NMIP4Config or NMIP6Config */
                                GHashTable *options); /* str:str hash */
 
-gboolean nm_dhcp_client_handle_event (gpointer unused,
+gboolean nm_dhcp_client_handle_event (NMDhcpClient *self,
                                       const char *iface,
                                       gint pid,
                                       GVariant *options,
-                                      const char *reason,
-                                      NMDhcpClient *self);
+                                      const char *reason);
 
 void nm_dhcp_client_set_client_id (NMDhcpClient *self, GBytes *client_id);
 
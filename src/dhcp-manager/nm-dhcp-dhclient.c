@@ -622,10 +622,8 @@ nm_dhcp_dhclient_init (NMDhcpDhclient *self)
 	if (!priv->def_leasefile)
 		priv->def_leasefile = SYSCONFDIR "/dhclient6.leases";
 
-	g_signal_connect (nm_dhcp_listener_get (),
-	                  NM_DHCP_LISTENER_EVENT,
-	                  G_CALLBACK (nm_dhcp_client_handle_event),
-	                  self);
+	/* dhclient reports its events through the helper; make sure they are received. */
+	nm_dhcp_listener_get ();
 }
 
 static void
@@ -633,10 +631,6 @@ dispose (GObject *object)
 {
 	NMDhcpDhclientPrivate *priv = NM_DHCP_DHCLIENT_GET_PRIVATE (object);
 
-	g_signal_handlers_disconnect_by_func (nm_dhcp_listener_get (),
-	                                      G_CALLBACK (nm_dhcp_client_handle_event),
-	                                      NM_DHCP_DHCLIENT (object));
-
 	g_free (priv->pid_file);
 	g_free (priv->conf_file);
 	g_free (priv->lease_file);
@@ -191,10 +191,8 @@ stop (NMDhcpClient *client, gboolean release, const GByteArray *duid)
 static void
 nm_dhcp_dhcpcd_init (NMDhcpDhcpcd *self)
 {
-	g_signal_connect (nm_dhcp_listener_get (),
-	                  NM_DHCP_LISTENER_EVENT,
-	                  G_CALLBACK (nm_dhcp_client_handle_event),
-	                  self);
+	/* dhcpcd reports its events through the helper; make sure they are received. */
+	nm_dhcp_listener_get ();
 }
 
 static void
@@ -202,10 +200,6 @@ dispose (GObject *object)
 {
 	NMDhcpDhcpcdPrivate *priv = NM_DHCP_DHCPCD_GET_PRIVATE (object);
 
-	g_signal_handlers_disconnect_by_func (nm_dhcp_listener_get (),
-	                                      G_CALLBACK (nm_dhcp_client_handle_event),
-	                                      NM_DHCP_DHCPCD (object));
-
 	g_free (priv->pid_file);
 
 	G_OBJECT_CLASS (nm_dhcp_dhcpcd_parent_class)->dispose (object);
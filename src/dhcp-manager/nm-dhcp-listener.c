@@ -28,6 +28,7 @@
 #include <unistd.h>
 
 #include "nm-dhcp-listener.h"
+#include "nm-dhcp-manager.h"
 #include "nm-core-internal.h"
 #include "nm-bus-manager.h"
 #include "NetworkManagerUtils.h"
@@ -47,12 +48,6 @@ typedef struct {
 
 G_DEFINE_TYPE (NMDhcpListener, nm_dhcp_listener, G_TYPE_OBJECT)
 
-enum {
-	EVENT,
-	LAST_SIGNAL
-};
-static guint signals[LAST_SIGNAL] = { 0 };
-
 /***************************************************/
 
 static char *
@@ -96,7 +91,7 @@ handle_event (GDBusConnection  *connection,
               GVariant         *parameters,
               gpointer          user_data)
 {
-	NMDhcpListener *self = NM_DHCP_LISTENER (user_data);
+	NMDhcpClient *client;
 	char *iface = NULL;
 	char *pid_str = NULL;
 	char *reason = NULL;
@@ -128,7 +123,13 @@ handle_event (GDBusConnection  *connection,
 		goto out;
 	}
 
-	g_signal_emit (self, signals[EVENT], 0, iface, pid, options, reason, &handled);
+	/* dispatch the event directly to the client owning the pid. */
+	client = nm_dhcp_manager_get_client_by_pid (nm_dhcp_manager_get (), pid);
+	if (client) {
+		g_object_ref (client);
+		handled = nm_dhcp_client_handle_event (client, iface, pid, options, reason);
+		g_object_unref (client);
+	}
 	if (!handled) {
 		if (g_ascii_strcasecmp (reason, "RELEASE") == 0) {
 			/* Ignore event when the dhcp client gets killed and we receive its last message */
@@ -228,18 +229,4 @@ nm_dhcp_listener_class_init (NMDhcpListenerClass *listener_class)
 
 	/* virtual methods */
 	object_class->dispose = dispose;
-
-	/* signals */
-	signals[EVENT] =
-		g_signal_new (NM_DHCP_LISTENER_EVENT,
-		              G_OBJECT_CLASS_TYPE (object_class),
-		              G_SIGNAL_RUN_LAST, 0,
-		              g_signal_accumulator_true_handled,
-		              NULL, NULL,
-		              G_TYPE_BOOLEAN,     /* listeners return TRUE if handled */
-		              4,
-		              G_TYPE_STRING,      /* iface */
-		              G_TYPE_INT,         /* pid */
-		              G_TYPE_VARIANT,     /* options */
-		              G_TYPE_STRING);     /* reason */
 }
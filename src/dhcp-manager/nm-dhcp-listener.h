@@ -26,8 +26,6 @@
 #define NM_IS_DHCP_LISTENER(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NM_TYPE_DHCP_LISTENER))
 #define NM_DHCP_LISTENER_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), NM_TYPE_DHCP_LISTENER, NMDhcpListenerClass))
 
-#define NM_DHCP_LISTENER_EVENT "event"
-
 typedef GObject NMDhcpListener;
 typedef GObjectClass NMDhcpListenerClass;
 
@@ -50,8 +50,18 @@ typedef struct {
 	GType               client_type;
 	GHashTable *        clients;
 	char *              default_hostname;
+
+	/* Lookup indexes into @clients, so that events of the DHCP helper
+	 * and restarts don't need to iterate over all clients. */
+	GHashTable *        clients_by_pid;
+	GHashTable *        clients_by_ifindex;
 } NMDhcpManagerPrivate;
 
+typedef struct {
+	NMDhcpClient *client;
+	pid_t pid;
+} ClientData;
+
 #define NM_DHCP_MANAGER_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_DHCP_MANAGER, NMDhcpManagerPrivate))
 
 G_DEFINE_TYPE (NMDhcpManager, nm_dhcp_manager, G_TYPE_OBJECT)
@@ -126,28 +136,28 @@ is_client_enabled (const char *name)
 
 /***************************************************/
 
+#define CLIENT_IFINDEX_KEY(ifindex, ip6) GINT_TO_POINTER (((ifindex) << 1) | (!!(ip6)))
+
+static void
+client_data_free (gpointer data)
+{
+	ClientData *client_data = data;
+
+	g_object_unref (client_data->client);
+	g_slice_free (ClientData, client_data);
+}
+
 static NMDhcpClient *
 get_client_for_ifindex (NMDhcpManager *manager, int ifindex, gboolean ip6)
 {
 	NMDhcpManagerPrivate *priv;
-	GHashTableIter iter;
-	gpointer value;
 
 	g_return_val_if_fail (NM_IS_DHCP_MANAGER (manager), NULL);
 	g_return_val_if_fail (ifindex > 0, NULL);
 
 	priv = NM_DHCP_MANAGER_GET_PRIVATE (manager);
 
-	g_hash_table_iter_init (&iter, priv->clients);
-	while (g_hash_table_iter_next (&iter, NULL, &value)) {
-		NMDhcpClient *candidate = NM_DHCP_CLIENT (value);
-
-		if (   nm_dhcp_client_get_ifindex (candidate) == ifindex
-		    && nm_dhcp_client_get_ipv6 (candidate) == ip6)
-			return candidate;
-	}
-
-	return NULL;
+	return g_hash_table_lookup (priv->clients_by_ifindex, CLIENT_IFINDEX_KEY (ifindex, ip6));
 }
 
 static void client_state_changed (NMDhcpClient *client,
@@ -160,6 +170,10 @@ static void client_state_changed (NMDhcpClient *client,
 static void
 remove_client (NMDhcpManager *self, NMDhcpClient *client)
 {
+	NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE (self);
+	ClientData *client_data;
+	gpointer key;
+
 	g_signal_handlers_disconnect_by_func (client, client_state_changed, self);
 
 	/* Stopping the client is left up to the controlling device
@@ -167,7 +181,19 @@ remove_client (NMDhcpManager *self, NMDhcpClient *client)
 	 * the DHCP client.
 	 */
 
-	g_hash_table_remove (NM_DHCP_MANAGER_GET_PRIVATE (self)->clients, client);
+	client_data = g_hash_table_lookup (priv->clients, client);
+	if (!client_data)
+		return;
+
+	if (   client_data->pid > 0
+	    && g_hash_table_lookup (priv->clients_by_pid, GINT_TO_POINTER (client_data->pid)) == client)
+		g_hash_table_remove (priv->clients_by_pid, GINT_TO_POINTER (client_data->pid));
+
+	key = CLIENT_IFINDEX_KEY (nm_dhcp_client_get_ifindex (client), nm_dhcp_client_get_ipv6 (client));
+	if (g_hash_table_lookup (priv->clients_by_ifindex, key) == client)
+		g_hash_table_remove (priv->clients_by_ifindex, key);
+
+	g_hash_table_remove (priv->clients, client);
 }
 
 static void
@@ -202,6 +228,7 @@ client_start (NMDhcpManager *self,
 {
 	NMDhcpManagerPrivate *priv;
 	NMDhcpClient *client;
+	ClientData *client_data;
 	gboolean success = FALSE;
 
 	g_return_val_if_fail (self, NULL);
@@ -234,7 +261,10 @@ client_start (NMDhcpManager *self,
 	                       NM_DHCP_CLIENT_PRIORITY, priority,
 	                       NM_DHCP_CLIENT_TIMEOUT, timeout ? timeout : DHCP_TIMEOUT,
 	                       NULL);
-	g_hash_table_insert (NM_DHCP_MANAGER_GET_PRIVATE (self)->clients, client, g_object_ref (client));
+	client_data = g_slice_new0 (ClientData);
+	client_data->client = g_object_ref (client);
+	g_hash_table_insert (priv->clients, client, client_data);
+	g_hash_table_insert (priv->clients_by_ifindex, CLIENT_IFINDEX_KEY (ifindex, ipv6), client);
 	g_signal_connect (client, NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED, G_CALLBACK (client_state_changed), self);
 
 	if (ipv6)
@@ -245,6 +275,11 @@ client_start (NMDhcpManager *self,
 	if (!success) {
 		remove_client (self, client);
 		client = NULL;
+	} else {
+		/* external clients report their events with the pid of the daemon. */
+		client_data->pid = nm_dhcp_client_get_pid (client);
+		if (client_data->pid > 0)
+			g_hash_table_insert (priv->clients_by_pid, GINT_TO_POINTER (client_data->pid), client);
 	}
 
 	return client;
@@ -330,6 +365,24 @@ nm_dhcp_manager_set_default_hostname (NMDhcpManager *manager, const char *hostna
 	priv->default_hostname = g_strdup (hostname);
 }
 
+/**
+ * nm_dhcp_manager_get_client_by_pid:
+ * @self: the #NMDhcpManager
+ * @pid: the process id of an external DHCP client
+ *
+ * Returns: (transfer none): the #NMDhcpClient that runs the DHCP client
+ *   process @pid, or %NULL.
+ */
+NMDhcpClient *
+nm_dhcp_manager_get_client_by_pid (NMDhcpManager *self, pid_t pid)
+{
+	g_return_val_if_fail (NM_IS_DHCP_MANAGER (self), NULL);
+
+	if (pid <= 0)
+		return NULL;
+	return g_hash_table_lookup (NM_DHCP_MANAGER_GET_PRIVATE (self)->clients_by_pid, GINT_TO_POINTER (pid));
+}
+
 GSList *
 nm_dhcp_manager_get_lease_ip_configs (NMDhcpManager *self,
                                       const char *iface,
@@ -405,21 +458,22 @@ nm_dhcp_manager_init (NMDhcpManager *self)
 
 	priv->client_type = type;
 	priv->clients = g_hash_table_new_full (g_direct_hash, g_direct_equal,
-	                                       NULL,
-	                                       (GDestroyNotify) g_object_unref);
+	                                       NULL, client_data_free);
+	priv->clients_by_pid = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->clients_by_ifindex = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 static void
 dispose (GObject *object)
 {
 	NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE (object);
-	GList *values, *iter;
+	GList *clients, *iter;
 
 	if (priv->clients) {
-		values = g_hash_table_get_values (priv->clients);
-		for (iter = values; iter; iter = g_list_next (iter))
+		clients = g_hash_table_get_keys (priv->clients);
+		for (iter = clients; iter; iter = g_list_next (iter))
 			remove_client (NM_DHCP_MANAGER (object), NM_DHCP_CLIENT (iter->data));
-		g_list_free (values);
+		g_list_free (clients);
 	}
 
 	G_OBJECT_CLASS (nm_dhcp_manager_parent_class)->dispose (object);
@@ -434,6 +488,8 @@ finalize (GObject *object)
 
 	if (priv->clients)
 		g_hash_table_destroy (priv->clients);
+	g_clear_pointer (&priv->clients_by_pid, g_hash_table_destroy);
+	g_clear_pointer (&priv->clients_by_ifindex, g_hash_table_destroy);
 
 	G_OBJECT_CLASS (nm_dhcp_manager_parent_class)->finalize (object);
 }
@@ -85,6 +85,8 @@ GSList *       nm_dhcp_manager_get_lease_ip_configs (NMDhcpManager *self,
                                                      gboolean ipv6,
                                                      guint32 default_route_metric);
 
+NMDhcpClient * nm_dhcp_manager_get_client_by_pid (NMDhcpManager *self, pid_t pid);
+
 /* For testing only */
 extern const char* nm_dhcp_helper_path;
 
@@ -33,10 +33,13 @@
 #include "nm-dhcp-utils.h"
 #include "NetworkManagerUtils.h"
 #include "nm-platform.h"
+#include "nmp-netns.h"
+#include "nm-sd.h"
 #include "nm-dhcp-client-logging.h"
 
 #include "sd-dhcp-client.h"
 #include "sd-dhcp6-client.h"
+#include "sd-event.h"
 
 #include "nm-sd-adapt.h"
 #include "dhcp-lease-internal.h"
@@ -45,9 +48,12 @@ G_DEFINE_TYPE (NMDhcpSystemd, nm_dhcp_systemd, NM_TYPE_DHCP_CLIENT)
 
 #define NM_DHCP_SYSTEMD_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_DHCP_SYSTEMD, NMDhcpSystemdPrivate))
 
+typedef struct _DhcpEngine DhcpEngine;
+
 typedef struct {
 	sd_dhcp_client *client4;
 	sd_dhcp6_client *client6;
+	DhcpEngine *engine;
 	char *lease_file;
 
 	guint request_count;
@@ -58,6 +64,91 @@ typedef struct {
 
 /************************************************************/
 
+/* The sd_event loop that the internal DHCP clients of a network namespace
+ * attach to. For the initial namespace, that is the default sd_event that
+ * gets attached to the main loop on startup, as before. Each other namespace
+ * gets its own sd_event with its own main loop source, whose events are
+ * dispatched inside the namespace, so that the sockets sd-dhcp opens when
+ * (re)starting a transaction are created there. Every client still opens
+ * its own sockets. */
+struct _DhcpEngine {
+	NMPNetns *netns;
+	sd_event *event;
+	guint source_id;
+	guint n_clients;
+};
+
+static GHashTable *engines;
+
+static gboolean
+engine_enter (gpointer user_data)
+{
+	DhcpEngine *engine = user_data;
+
+	return nmp_netns_push (engine->netns);
+}
+
+static void
+engine_leave (gpointer user_data)
+{
+	DhcpEngine *engine = user_data;
+
+	nmp_netns_pop (engine->netns);
+}
+
+static DhcpEngine *
+engine_acquire (void)
+{
+	NMPNetns *netns = NULL;
+	DhcpEngine *engine;
+	int r;
+
+	if (!nmp_netns_is_initial ())
+		netns = nmp_netns_get_current ();
+
+	if (G_UNLIKELY (!engines))
+		engines = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	engine = g_hash_table_lookup (engines, netns);
+	if (engine) {
+		engine->n_clients++;
+		return engine;
+	}
+
+	engine = g_slice_new0 (DhcpEngine);
+	engine->n_clients = 1;
+	if (netns) {
+		r = sd_event_new (&engine->event);
+		if (r < 0) {
+			nm_log_warn (LOGD_DHCP, "dhcp: failed to create event loop for network namespace (%d)", r);
+			g_slice_free (DhcpEngine, engine);
+			return NULL;
+		}
+		engine->netns = g_object_ref (netns);
+		engine->source_id = nm_sd_event_attach (engine->event, NULL, engine_enter, engine_leave, engine);
+	}
+	g_hash_table_insert (engines, netns, engine);
+	return engine;
+}
+
+static void
+engine_release (DhcpEngine *engine)
+{
+	g_return_if_fail (engine && engine->n_clients > 0);
+
+	if (--engine->n_clients > 0)
+		return;
+
+	g_hash_table_remove (engines, engine->netns);
+	nm_clear_g_source (&engine->source_id);
+	if (engine->event)
+		sd_event_unref (engine->event);
+	g_clear_object (&engine->netns);
+	g_slice_free (DhcpEngine, engine);
+}
+
+/************************************************************/
+
 #define DHCP_OPTION_NIS_DOMAIN         40
 #define DHCP_OPTION_NIS_SERVERS        41
 #define DHCP_OPTION_DOMAIN_SEARCH     119
@@ -576,7 +667,12 @@ ip4_start (NMDhcpClient *client, const char *dhcp_anycast_addr, const char *last
 		return FALSE;
 	}
 
-	r = sd_dhcp_client_attach_event (priv->client4, NULL, 0);
+	if (!priv->engine)
+		priv->engine = engine_acquire ();
+	if (!priv->engine)
+		goto error;
+
+	r = sd_dhcp_client_attach_event (priv->client4, priv->engine->event, 0);
 	if (r < 0) {
 		_LOGW ("failed to attach event (%d)", r);
 		goto error;
@@ -702,8 +798,10 @@ ip4_start (NMDhcpClient *client, const char *dhcp_anycast_addr, const char *last
 
 error:
 	sd_dhcp_lease_unref (lease);
-	if (!success)
+	if (!success) {
 		priv->client4 = sd_dhcp_client_unref (priv->client4);
+		g_clear_pointer (&priv->engine, engine_release);
+	}
 	return success;
 }
 
@@ -904,7 +1002,12 @@ ip6_start (NMDhcpClient *client,
 		return FALSE;
 	}
 
-	r = sd_dhcp6_client_attach_event (priv->client6, NULL, 0);
+	if (!priv->engine)
+		priv->engine = engine_acquire ();
+	if (!priv->engine)
+		goto error;
+
+	r = sd_dhcp6_client_attach_event (priv->client6, priv->engine->event, 0);
 	if (r < 0) {
 		_LOGW ("failed to attach event (%d)", r);
 		goto error;
@@ -957,6 +1060,7 @@ ip6_start (NMDhcpClient *client,
 error:
 	sd_dhcp6_client_unref (priv->client6);
 	priv->client6 = NULL;
+	g_clear_pointer (&priv->engine, engine_release);
 	return FALSE;
 }
 
@@ -1005,6 +1109,8 @@ dispose (GObject *object)
 		priv->client6 = NULL;
 	}
 
+	g_clear_pointer (&priv->engine, engine_release);
+
 	G_OBJECT_CLASS (nm_dhcp_systemd_parent_class)->dispose (object);
 }
 
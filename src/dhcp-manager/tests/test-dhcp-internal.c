@@ -0,0 +1,339 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <net/ethernet.h>
+
+#include "nm-dhcp-systemd.h"
+#include "nm-core-utils.h"
+#include "nmp-netns.h"
+#include "nm-sd.h"
+#include "test-common.h"
+
+#define IFACE_BRIDGE "nm-dhcp-br"
+#define IFACE_VETH   "nm-dhcp%u"
+#define IFACE_PEER   "nm-dhcp%up"
+
+#define N_CLIENTS    64
+
+typedef struct {
+	guint n_clients;
+	guint n_bound;
+	guint n_failed;
+	GMainLoop *loop;
+} BoundData;
+
+static void
+state_changed_cb (NMDhcpClient *client,
+                  NMDhcpState state,
+                  GObject *ip_config,
+                  GHashTable *options,
+                  const char *event_id,
+                  gpointer user_data)
+{
+	BoundData *data = user_data;
+
+	switch (state) {
+	case NM_DHCP_STATE_BOUND:
+		data->n_bound++;
+		break;
+	case NM_DHCP_STATE_TIMEOUT:
+	case NM_DHCP_STATE_FAIL:
+		data->n_failed++;
+		break;
+	default:
+		return;
+	}
+
+	/* Each client only reports its first result. */
+	g_signal_handlers_disconnect_by_func (client, state_changed_cb, data);
+
+	if (data->n_bound + data->n_failed == data->n_clients)
+		g_main_loop_quit (data->loop);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+	g_main_loop_quit (user_data);
+	return G_SOURCE_REMOVE;
+}
+
+typedef struct {
+	char *tmpdir;
+	int ifindex_bridge;
+	GPid dnsmasq_pid;
+} TestEnv;
+
+/* Creates a bridge with a dnsmasq DHCP server in the current namespace.
+ * Clients get connected through veth pairs, with the peers enslaved. */
+static gboolean
+env_setup (TestEnv *env)
+{
+	const NMPlatformLink *plink;
+	GError *error = NULL;
+
+	memset (env, 0, sizeof (*env));
+
+	if (nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-dhcp-internal");
+		g_test_skip ("Skip long running test");
+		return FALSE;
+	}
+
+	if (!nm_utils_find_helper ("dnsmasq", NULL, NULL)) {
+		g_test_skip ("dnsmasq not found");
+		return FALSE;
+	}
+
+	env->tmpdir = g_dir_make_tmp ("test-dhcp-internal-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	nmtstp_run_command_check ("ip link add " IFACE_BRIDGE " type bridge forward_delay 0");
+	plink = nmtstp_assert_wait_for_link (NM_PLATFORM_GET, IFACE_BRIDGE, NM_LINK_TYPE_BRIDGE, 100);
+	env->ifindex_bridge = plink->ifindex;
+	nmtstp_ip4_address_add (-1, env->ifindex_bridge, nmtst_inet4_from_string ("172.25.0.1"), 16,
+	                        nmtst_inet4_from_string ("172.25.0.1"), NM_PLATFORM_LIFETIME_PERMANENT,
+	                        NM_PLATFORM_LIFETIME_PERMANENT, 0, NULL);
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, env->ifindex_bridge, NULL));
+
+	{
+		gs_free char *arg_leasefile = g_strdup_printf ("--dhcp-leasefile=%s/dnsmasq.leases", env->tmpdir);
+		gs_free char *arg_pidfile = g_strdup_printf ("--pid-file=%s/dnsmasq.pid", env->tmpdir);
+		const char *argv[] = {
+			nm_utils_find_helper ("dnsmasq", NULL, NULL),
+			"--no-daemon",
+			"--conf-file=/dev/null",
+			"--bind-interfaces",
+			"--interface=" IFACE_BRIDGE,
+			"--except-interface=lo",
+			"--dhcp-range=172.25.1.1,172.25.255.254,60m",
+			"--dhcp-lease-max=65535",
+			"--port=0",
+			"--user=root",
+			arg_leasefile,
+			arg_pidfile,
+			NULL,
+		};
+
+		if (!g_spawn_async (NULL, (char **) argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD,
+		                    NULL, NULL, &env->dnsmasq_pid, &error))
+			g_error ("failed to spawn dnsmasq: %s", error->message);
+	}
+
+	return TRUE;
+}
+
+static void
+env_teardown (TestEnv *env)
+{
+	gs_free char *lease_file = g_strdup_printf ("%s/dnsmasq.leases", env->tmpdir);
+	gs_free char *pid_file = g_strdup_printf ("%s/dnsmasq.pid", env->tmpdir);
+
+	kill (env->dnsmasq_pid, SIGTERM);
+	waitpid (env->dnsmasq_pid, NULL, 0);
+	g_spawn_close_pid (env->dnsmasq_pid);
+
+	unlink (lease_file);
+	unlink (pid_file);
+	rmdir (env->tmpdir);
+	g_free (env->tmpdir);
+
+	nm_platform_link_delete (NM_PLATFORM_GET, env->ifindex_bridge);
+}
+
+static NMDhcpClient *
+client_start (NMPlatform *platform, const char *iface, guint i, BoundData *data)
+{
+	gs_free char *uuid = g_strdup_printf ("f0e8a9e4-0000-4000-8000-%012u", i);
+	NMDhcpClient *client;
+	GByteArray *hwaddr;
+	gconstpointer addr;
+	size_t addr_len;
+	int ifindex;
+
+	ifindex = nm_platform_link_get_ifindex (platform, iface);
+	g_assert_cmpint (ifindex, >, 0);
+	addr = nm_platform_link_get_address (platform, ifindex, &addr_len);
+	g_assert (addr && addr_len == ETH_ALEN);
+
+	hwaddr = g_byte_array_sized_new (addr_len);
+	g_byte_array_append (hwaddr, addr, addr_len);
+
+	client = g_object_new (NM_TYPE_DHCP_SYSTEMD,
+	                       NM_DHCP_CLIENT_INTERFACE, iface,
+	                       NM_DHCP_CLIENT_IFINDEX, ifindex,
+	                       NM_DHCP_CLIENT_HWADDR, hwaddr,
+	                       NM_DHCP_CLIENT_IPV6, FALSE,
+	                       NM_DHCP_CLIENT_UUID, uuid,
+	                       NM_DHCP_CLIENT_PRIORITY, (guint) 0,
+	                       NM_DHCP_CLIENT_TIMEOUT, (guint) 60,
+	                       NULL);
+	g_byte_array_unref (hwaddr);
+
+	g_signal_connect (client, NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED,
+	                  G_CALLBACK (state_changed_cb), data);
+	g_assert (nm_dhcp_client_start_ip4 (client, NULL, NULL, NULL, NULL, NULL));
+	return client;
+}
+
+static void
+client_stop (NMDhcpClient *client, BoundData *data)
+{
+	g_signal_handlers_disconnect_by_func (client, state_changed_cb, data);
+	nm_dhcp_client_stop (client, FALSE);
+	g_object_unref (client);
+}
+
+static void
+run_until_done (BoundData *data)
+{
+	guint id;
+
+	data->loop = g_main_loop_new (NULL, FALSE);
+	id = g_timeout_add_seconds (90, timeout_cb, data->loop);
+	g_main_loop_run (data->loop);
+	nm_clear_g_source (&id);
+	g_main_loop_unref (data->loop);
+	data->loop = NULL;
+}
+
+static void
+test_dhcp_internal_many (void)
+{
+	NMDhcpClient *clients[N_CLIENTS] = { };
+	BoundData data = { .n_clients = N_CLIENTS };
+	TestEnv env;
+	gint64 start;
+	double elapsed;
+	guint i;
+
+	if (!env_setup (&env))
+		return;
+
+	for (i = 0; i < N_CLIENTS; i++) {
+		nmtstp_run_command_check ("ip link add " IFACE_VETH " type veth peer name " IFACE_PEER, i, i);
+		nmtstp_run_command_check ("ip link set " IFACE_PEER " master " IFACE_BRIDGE " up", i);
+		nmtstp_run_command_check ("ip link set " IFACE_VETH " up", i);
+	}
+	nm_platform_process_events (NM_PLATFORM_GET);
+
+	start = nm_utils_get_monotonic_timestamp_ns ();
+
+	for (i = 0; i < N_CLIENTS; i++) {
+		gs_free char *iface = g_strdup_printf (IFACE_VETH, i);
+
+		clients[i] = client_start (NM_PLATFORM_GET, iface, i, &data);
+	}
+
+	run_until_done (&data);
+
+	elapsed = (nm_utils_get_monotonic_timestamp_ns () - start) / (double) NM_UTILS_NS_PER_SECOND;
+	g_print ("%u leases in %.3f s (%.1f leases/s)\n", data.n_bound, elapsed,
+	         elapsed > 0 ? data.n_bound / elapsed : 0.0);
+
+	for (i = 0; i < N_CLIENTS; i++)
+		client_stop (clients[i], &data);
+
+	for (i = 0; i < N_CLIENTS; i++)
+		nmtstp_run_command ("ip link del " IFACE_VETH, i);
+	env_teardown (&env);
+
+	g_assert_cmpint (data.n_failed, ==, 0);
+	g_assert_cmpint (data.n_bound, ==, N_CLIENTS);
+}
+
+/* Starts one client in the initial namespace and one in a second namespace.
+ * The latter only gets a lease if its sockets are created inside that
+ * namespace, that is, if it runs on the namespace's own event loop. */
+static void
+test_dhcp_internal_netns (void)
+{
+	gs_unref_object NMPNetns *netns2 = NULL;
+	gs_unref_object NMPlatform *platform2 = NULL;
+	NMDhcpClient *client1, *client2;
+	BoundData data = { .n_clients = 2 };
+	TestEnv env;
+	int ifindex;
+
+	if (!nmp_netns_get_current ()) {
+		g_test_skip ("No netns support");
+		return;
+	}
+
+	if (!env_setup (&env))
+		return;
+
+	netns2 = nmp_netns_new ();
+	g_assert (netns2);
+	platform2 = g_object_new (NM_TYPE_LINUX_PLATFORM, NM_PLATFORM_NETNS_SUPPORT, TRUE, NULL);
+	nmp_netns_pop (netns2);
+
+	nmtstp_run_command_check ("ip link add " IFACE_VETH " type veth peer name " IFACE_PEER, 0, 0);
+	nmtstp_run_command_check ("ip link set " IFACE_PEER " master " IFACE_BRIDGE " up", 0);
+	nmtstp_run_command_check ("ip link set " IFACE_VETH " up", 0);
+	nmtstp_run_command_check ("ip link add " IFACE_VETH " type veth peer name " IFACE_PEER, 1, 1);
+	nmtstp_run_command_check ("ip link set " IFACE_PEER " master " IFACE_BRIDGE " up", 1);
+
+	ifindex = nmtstp_assert_wait_for_link (NM_PLATFORM_GET, "nm-dhcp1", NM_LINK_TYPE_VETH, 100)->ifindex;
+	g_assert (nm_platform_link_set_netns (NM_PLATFORM_GET, ifindex, nmp_netns_get_fd_net (netns2)));
+
+	client1 = client_start (NM_PLATFORM_GET, "nm-dhcp0", 0, &data);
+
+	{
+		nm_auto_pop_netns NMPNetns *netns_pop = NULL;
+
+		g_assert (nm_platform_netns_push (platform2, &netns_pop));
+		ifindex = nmtstp_assert_wait_for_link (platform2, "nm-dhcp1", NM_LINK_TYPE_VETH, 100)->ifindex;
+		g_assert (nm_platform_link_set_up (platform2, ifindex, NULL));
+		client2 = client_start (platform2, "nm-dhcp1", 1, &data);
+	}
+
+	run_until_done (&data);
+
+	client_stop (client1, &data);
+	client_stop (client2, &data);
+
+	nmtstp_run_command ("ip link del " IFACE_VETH, 0);
+	nmtstp_run_command ("ip link del " IFACE_PEER, 1);
+	env_teardown (&env);
+
+	g_assert_cmpint (data.n_failed, ==, 0);
+	g_assert_cmpint (data.n_bound, ==, 2);
+}
+
+/*****************************************************************************/
+
+void
+init_tests (int *argc, char ***argv)
+{
+	nmtst_init_with_logging (argc, argv, "WARN", "DHCP");
+}
+
+void
+setup_tests (void)
+{
+	nm_sd_event_attach_default ();
+
+	g_test_add_func ("/dhcp/internal/many", test_dhcp_internal_many);
+	g_test_add_func ("/dhcp/internal/netns", test_dhcp_internal_netns);
+}
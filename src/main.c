@@ -48,6 +48,7 @@
 #include "nm-session-monitor.h"
 #include "nm-dispatcher.h"
 #include "nm-settings.h"
+#include "nm-state-db.h"
 #include "nm-auth-manager.h"
 #include "nm-core-internal.h"
 #include "nm-exported-object.h"
@@ -444,7 +445,15 @@ main (int argc, char *argv[])
 	}
 
 	/* Set up platform interaction layer */
-	nm_linux_platform_setup ();
+	{
+		gs_free char *ignore_route_protocols = NULL;
+
+		ignore_route_protocols = nm_config_data_get_value (nm_config_get_data_orig (config),
+		                                                   NM_CONFIG_KEYFILE_GROUP_MAIN,
+		                                                   NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_ROUTE_PROTOCOLS,
+		                                                   NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+		nm_linux_platform_setup_full (ignore_route_protocols);
+	}
 
 	/* Set up network namespace controller */
 	if (!nm_netns_controller_setup ()) {
@@ -489,6 +498,9 @@ done:
 
 	nm_manager_stop (nm_manager_get ());
 
+	/* write out timestamps and seen-bssids still pending */
+	nm_state_db_flush_all ();
+
 	if (global_opt.pidfile && wrote_pidfile)
 		unlink (global_opt.pidfile);
 
@@ -150,44 +150,176 @@ namespace_destroy (gpointer data)
 	nm_exported_object_clear_and_unexport (&netns);
 }
 
+/*
+ * Creating a namespace is split into two steps, so that many namespaces
+ * can be created in a pipelined fashion: _namespace_prepare() unshares
+ * the namespace and sends the initial netlink dumps without waiting for
+ * the replies. _namespace_finish() collects the replies, enumerates the
+ * devices and exports the object.
+ */
 static NMNetns *
-create_new_namespace (NMNetnsController *self, const char *netnsname)
+_namespace_prepare (NMNetnsController *self, const char *netnsname)
 {
-	NMNetnsControllerPrivate *priv = NM_NETNS_CONTROLLER_GET_PRIVATE (self);
+	NMPNetns *netnsp;
 	NMNetns *netns;
-	nm_auto_pop_netns NMPNetns *netnsp = NULL;
-	const char *path;
 
+	/* nmp_netns_new() leaves us inside the new namespace, which is
+	 * taken over by the NMNetns instance. */
 	netnsp = nmp_netns_new ();
 	if (!netnsp) {
 		nm_log_err (LOGD_NETNS, "error creating namespace");
 		return NULL;
 	}
 
-	if (!nmp_netns_push (netnsp)) {
-		g_object_unref (netnsp);
-		return NULL;
-	}
-
 	netns = nm_netns_new (netnsname);
 
-	if (!nm_netns_setup (netns)) {
-		nm_log_dbg (LOGD_NETNS, "error setting up namespace %s ", netnsname);
+	if (!nm_netns_prepare (netns)) {
+		nm_log_dbg (LOGD_NETNS, "error preparing namespace %s ", netnsname);
+		nmp_netns_pop (netnsp);
 		g_object_unref (netns);
 		return NULL;
 	}
 
 	nmp_netns_pop (netnsp);
 
+	return netns;
+}
+
+static gboolean
+_namespace_finish (NMNetnsController *self, NMNetns *netns)
+{
+	NMNetnsControllerPrivate *priv = NM_NETNS_CONTROLLER_GET_PRIVATE (self);
+	nm_auto_pop_netns NMPNetns *netnsp = NULL;
+	const char *path;
+
+	if (!nm_netns_push (netns, &netnsp))
+		return FALSE;
+
+	if (!nm_netns_setup (netns)) {
+		nm_log_dbg (LOGD_NETNS, "error setting up namespace %s ", nm_netns_get_name (netns));
+		return FALSE;
+	}
+
 	path = nm_exported_object_export (NM_EXPORTED_OBJECT (netns));
 	g_hash_table_insert (priv->network_namespaces, g_strdup (path), netns);
 
 	g_signal_emit (self, signals[NETNS_ADDED], 0, netns);
+
+	return TRUE;
+}
+
+static NMNetns *
+create_new_namespace (NMNetnsController *self, const char *netnsname)
+{
+	NMNetns *netns;
+
+	netns = _namespace_prepare (self, netnsname);
+	if (!netns)
+		return NULL;
+
+	if (!_namespace_finish (self, netns)) {
+		nm_netns_stop (netns);
+		g_object_unref (netns);
+		return NULL;
+	}
+
 	_notify (self, PROP_NETWORK_NAMESPACES);
 
 	return netns;
 }
 
+/**
+ * nm_netns_controller_new_netns_multiple:
+ * @self: the #NMNetnsController instance
+ * @netns_names: %NULL terminated list of names
+ * @error: location to store error, or %NULL
+ *
+ * Creates a network namespace for each name in @netns_names. First all
+ * namespaces are unshared and their netlink dumps requested, then the
+ * replies are processed one namespace after the other. Either all
+ * namespaces are created, or none.
+ *
+ * Returns: (transfer container): the array of the new #NMNetns instances
+ *   in the order of @netns_names, or %NULL on error.
+ */
+GPtrArray *
+nm_netns_controller_new_netns_multiple (NMNetnsController *self,
+                                        const char *const *netns_names,
+                                        GError **error)
+{
+	GPtrArray *netnses;
+	guint i, j, n;
+	guint n_finished = 0;
+
+	g_return_val_if_fail (NM_IS_NETNS_CONTROLLER (self), NULL);
+	g_return_val_if_fail (netns_names, NULL);
+
+	n = g_strv_length ((char **) netns_names);
+
+	for (i = 0; i < n; i++) {
+		if (!netns_names[i][0]) {
+			g_set_error (error, NM_NETNS_ERROR, NM_NETNS_ERROR_FAILED,
+			             "Invalid empty network namespace name");
+			return NULL;
+		}
+		if (nm_netns_controller_find_netns_by_name (netns_names[i])) {
+			g_set_error (error, NM_NETNS_ERROR, NM_NETNS_ERROR_FAILED,
+			             "Network namespace %s already exists", netns_names[i]);
+			return NULL;
+		}
+		for (j = 0; j < i; j++) {
+			if (!strcmp (netns_names[i], netns_names[j])) {
+				g_set_error (error, NM_NETNS_ERROR, NM_NETNS_ERROR_FAILED,
+				             "Network namespace %s requested twice", netns_names[i]);
+				return NULL;
+			}
+		}
+	}
+
+	netnses = g_ptr_array_sized_new (n);
+
+	for (i = 0; i < n; i++) {
+		NMNetns *netns;
+
+		netns = _namespace_prepare (self, netns_names[i]);
+		if (!netns) {
+			g_set_error (error, NM_NETNS_ERROR, NM_NETNS_ERROR_FAILED,
+			             "Error creating network namespace %s", netns_names[i]);
+			goto fail;
+		}
+		g_ptr_array_add (netnses, netns);
+	}
+
+	for (n_finished = 0; n_finished < n; n_finished++) {
+		if (!_namespace_finish (self, netnses->pdata[n_finished])) {
+			g_set_error (error, NM_NETNS_ERROR, NM_NETNS_ERROR_FAILED,
+			             "Error setting up network namespace %s", netns_names[n_finished]);
+			goto fail;
+		}
+	}
+
+	nm_log_dbg (LOGD_NETNS, "Created %u network namespaces", n);
+	_notify (self, PROP_NETWORK_NAMESPACES);
+	return netnses;
+
+fail:
+	/* the finished ones are owned by the hash table, the others by us. */
+	for (i = 0; i < netnses->len; i++) {
+		NMNetns *netns = netnses->pdata[i];
+
+		if (i < n_finished)
+			nm_netns_controller_remove_netns (self, netns);
+		else {
+			nm_netns_stop (netns);
+			g_object_unref (netns);
+		}
+	}
+	g_ptr_array_unref (netnses);
+	if (n_finished > 0)
+		_notify (self, PROP_NETWORK_NAMESPACES);
+	return NULL;
+}
+
 NMNetns *
 nm_netns_controller_new_netns (const char *netns_name)
 {
@@ -258,6 +390,31 @@ impl_netns_controller_add_namespace (NMNetnsController *self,
 	}
 }
 
+static void
+impl_netns_controller_add_namespaces (NMNetnsController *self,
+                                      GDBusMethodInvocation *context,
+                                      const char *const *netnsnames)
+{
+	gs_unref_ptrarray GPtrArray *netnses = NULL;
+	gs_free const char **paths = NULL;
+	GError *error = NULL;
+	guint i;
+
+	netnses = nm_netns_controller_new_netns_multiple (self, netnsnames, &error);
+	if (!netnses) {
+		g_dbus_method_invocation_take_error (context, error);
+		return;
+	}
+
+	paths = g_new (const char *, netnses->len + 1);
+	for (i = 0; i < netnses->len; i++)
+		paths[i] = nm_exported_object_get_path (netnses->pdata[i]);
+	paths[i] = NULL;
+
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(^ao)", paths));
+}
+
 static void
 impl_netns_controller_remove_namespace (NMNetnsController *self,
                                         GDBusMethodInvocation *context,
@@ -442,6 +599,7 @@ nm_netns_controller_class_init (NMNetnsControllerClass *klass)
 	                                        NMDBUS_TYPE_NETWORK_NAMESPACES_CONTROLLER_SKELETON,
 	                                        "ListNetworkNamespaces", impl_netns_controller_list_namespaces,
 	                                        "AddNetworkNamespace", impl_netns_controller_add_namespace,
+	                                        "AddNetworkNamespaces", impl_netns_controller_add_namespaces,
 	                                        "RemoveNetworkNamespace", impl_netns_controller_remove_namespace,
 	                                        NULL);
 }
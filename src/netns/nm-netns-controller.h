@@ -62,6 +62,10 @@ NMDevice * nm_netns_controller_find_device_by_path (const char *device_path);
 
 NMNetns * nm_netns_controller_new_netns (const char *netns_name);
 
+GPtrArray *nm_netns_controller_new_netns_multiple (NMNetnsController *self,
+                                                   const char *const *netns_names,
+                                                   GError **error);
+
 void nm_netns_controller_remove_netns (NMNetnsController *self, NMNetns *netns);
 
 NMNetnsController *nm_netns_controller_new (void);
@@ -167,12 +167,12 @@ typedef struct {
 	GSList *devices;
 
 	/*
-	 * List of callbacks for devices that are waited for in this namespace
-	 * due to the network namespace switch.
+	 * Callbacks for devices that are waited for in this namespace
+	 * due to the network namespace switch, indexed by ifindex.
 	 *
-	 * It is expected that each element of this list has a unique ifindex.
+	 * Only one waiter per ifindex is allowed.
 	 */
-	GSList *devices_change_list;
+	GHashTable *devices_change;
 
 	/*
 	 * Default route manager instance for the namespace
@@ -260,14 +260,20 @@ nm_netns_push (NMNetns *self, NMPNetns **netnsp)
  */
 
 /*
- * Remove callback structure from a list.
+ * Default time to wait for a device to appear in a network namespace
+ * when caller didn't specify one.
+ */
+#define DEVICE_CHANGE_TIMEOUT_DEFAULT_MS 5000
+
+/*
+ * Remove callback structure from the waiter table.
  */
 static void
 _device_change_callback_remove(NMNetns *self, DeviceChangeData *dc)
 {
 	NMNetnsPrivate *priv = NM_NETNS_GET_PRIVATE (self);
 
-	priv->devices_change_list = g_slist_remove (priv->devices_change_list, dc);
+	g_hash_table_remove (priv->devices_change, GINT_TO_POINTER (dc->ifindex));
 
 	g_object_unref(dc->netns);
 
@@ -299,52 +305,49 @@ _device_change_timeout_cb(gpointer user_data)
 
 /*
  * Add new callback structure and also add timeout for the given
- * callback structure.
+ * callback structure. @timeout is in milliseconds, if it is not
+ * positive a default value is used.
  *
- * TODO: Timeout should be a configurable value! We currently wait
- * for 2000ms fixed!
+ * Returns NULL if someone is already waiting for @ifindex.
  */
 static DeviceChangeData *
 _device_change_callback_add(NMNetns *self,
                             int ifindex,
+                            int timeout,
                             void (*callback)(gpointer user_data, gboolean timeout),
                             gpointer user_data)
 {
 	NMNetnsPrivate *priv = NM_NETNS_GET_PRIVATE (self);
 	DeviceChangeData *dc;
 
+	if (g_hash_table_contains (priv->devices_change, GINT_TO_POINTER (ifindex)))
+		return NULL;
+
 	dc = g_slice_new (DeviceChangeData);
 	dc->callback = callback;
 	dc->user_data = user_data;
 	dc->ifindex = ifindex;
 	dc->netns = g_object_ref(self);
 
-	dc->timeout_id = g_timeout_add (5000, _device_change_timeout_cb, dc);
+	dc->timeout_id = g_timeout_add (timeout > 0 ? timeout : DEVICE_CHANGE_TIMEOUT_DEFAULT_MS,
+	                                _device_change_timeout_cb, dc);
 
-	priv->devices_change_list = g_slist_prepend (priv->devices_change_list, dc);
+	g_hash_table_insert (priv->devices_change, GINT_TO_POINTER (ifindex), dc);
 
 	return dc;
 }
 
 /*
- * Search list of DeviceChangeData structures by interface index
- * and return a pointer, or NULL if none.
+ * Find DeviceChangeData structure by interface index of
+ * the device and return a pointer, or NULL if none.
  */
 static DeviceChangeData *
 _device_change_find (NMNetns *self, NMDevice *device)
 {
 	NMNetnsPrivate *priv = NM_NETNS_GET_PRIVATE (self);
-	int ifindex;
-	GSList *iter;
 
-	ifindex = nm_device_get_ifindex (device);
-
-	for (iter = priv->devices_change_list; iter; iter = iter->next) {
-		if (((DeviceChangeData *) iter->data)->ifindex == ifindex)
-			return iter->data;
-	}
-
-	return NULL;
+	return g_hash_table_lookup (priv->devices_change,
+	                            GINT_TO_POINTER (nm_device_get_ifindex (device)));
 }
 
 /*
@@ -404,6 +407,33 @@ nm_netns_get_ns (NMNetns *self)
 	return NM_NETNS_GET_PRIVATE (self)->nmp_netns;
 }
 
+static gboolean
+_platform_create (NMNetns *self, gboolean deferred)
+{
+	NMNetnsPrivate *priv = NM_NETNS_GET_PRIVATE (self);
+
+	nm_assert (!priv->platform);
+
+	if (G_UNLIKELY (!priv->nmp_netns))
+		return FALSE;
+
+	/* Each namespace still gets its own platform instance, with its own
+	 * netlink socket and cache. What the instances share is the event
+	 * source, the udev client and the object allocator. */
+	if (!nmp_netns_push (priv->nmp_netns))
+		return FALSE;
+	priv->platform = deferred
+	                 ? nm_linux_platform_new_deferred ()
+	                 : nm_linux_platform_new ();
+	nmp_netns_pop (priv->nmp_netns);
+
+	g_signal_connect (priv->platform,
+	                  NM_PLATFORM_SIGNAL_LINK_CHANGED,
+	                  G_CALLBACK (platform_link_cb),
+	                  self);
+	return TRUE;
+}
+
 NMPlatform *
 nm_netns_get_platform (NMNetns *self)
 {
@@ -414,23 +444,35 @@ nm_netns_get_platform (NMNetns *self)
 	priv = NM_NETNS_GET_PRIVATE (self);
 
 	if (G_UNLIKELY (!priv->platform)) {
-		if (G_UNLIKELY (!priv->nmp_netns))
+		if (!_platform_create (self, FALSE))
 			return NULL;
-
-		if (!nmp_netns_push (priv->nmp_netns))
-			return NULL;
-		priv->platform = nm_linux_platform_new ();
-		nmp_netns_pop (priv->nmp_netns);
-
-		g_signal_connect (priv->platform,
-		                  NM_PLATFORM_SIGNAL_LINK_CHANGED,
-		                  G_CALLBACK (platform_link_cb),
-		                  self);
 	}
 
 	return priv->platform;
 }
 
+/**
+ * nm_netns_prepare:
+ * @self: the #NMNetns instance
+ *
+ * Creates the platform instance of the namespace and sends the initial
+ * netlink dump requests, without waiting for the replies. The replies are
+ * processed by nm_netns_setup(). Doing that for many namespaces before
+ * setting up any of them lets the kernel work on all the dumps at once.
+ *
+ * Returns: %TRUE if the platform instance exists afterwards.
+ */
+gboolean
+nm_netns_prepare (NMNetns *self)
+{
+	g_return_val_if_fail (NM_IS_NETNS (self), FALSE);
+
+	if (NM_NETNS_GET_PRIVATE (self)->platform)
+		return TRUE;
+
+	return _platform_create (self, TRUE);
+}
+
 NMDefaultRouteManager *
 nm_netns_get_default_route_manager (NMNetns *self)
 {
@@ -548,7 +590,14 @@ nm_netns_take_device(NMNetns *self,
 	/*
 	 * Add callback structure and associated timeout
 	 */
-	dc = _device_change_callback_add (self, nm_device_get_ifindex (device), callback, user_data);
+	dc = _device_change_callback_add (self, nm_device_get_ifindex (device), timeout, callback, user_data);
+	if (!dc) {
+		nm_log_dbg (LOGD_NETNS, "Device %s (%d) is already being moved to network namespace %s",
+		            nm_device_get_iface (device),
+		            nm_device_get_ifindex (device),
+		            nm_netns_get_name (self));
+		return FALSE;
+	}
 
 	/*
 	 * Initiate change of network namespace for device
@@ -1032,6 +1081,12 @@ nm_netns_setup (NMNetns *self)
 		return TRUE;
 	}
 
+	/*
+	 * Collect pending replies in case nm_netns_prepare() only
+	 * requested the dumps.
+	 */
+	nm_platform_process_events (nm_netns_get_platform (self));
+
 	/*
 	 * Enumerate all existing devices in the network namespace
 	 *
@@ -1270,8 +1325,157 @@ impl_netns_take_device (NMNetns *self,
 		                                       NM_NETNS_ERROR,
 		                                       NM_NETNS_ERROR_FAILED,
 		                                       "Error moving device to target namespace");
+		g_object_unref (td->netns);
+		g_slice_free (_take_device_data, td);
+		return;
+	}
+}
+
+/*
+ * State shared by all devices moved by a single TakeDevices call.
+ * The reply is sent once the last device arrives, or on the first
+ * failure, after which the remaining completions are only counted.
+ */
+typedef struct {
+	NMNetns *netns;
+	GDBusMethodInvocation *context;
+	guint pending;
+	gboolean replied;
+} _take_devices_batch;
+
+typedef struct {
+	_take_devices_batch *batch;
+	int ifindex;
+} _take_devices_item;
+
+static void
+_take_devices_batch_fail (_take_devices_batch *batch, const char *message)
+{
+	if (batch->replied)
+		return;
+
+	batch->replied = TRUE;
+	g_dbus_method_invocation_return_error_literal (batch->context,
+	                                               NM_NETNS_ERROR,
+	                                               NM_NETNS_ERROR_FAILED,
+	                                               message);
+}
+
+static void
+_take_devices_batch_unref (_take_devices_batch *batch)
+{
+	if (--batch->pending > 0)
+		return;
+
+	if (!batch->replied)
+		g_dbus_method_invocation_return_value (batch->context, NULL);
+
+	g_object_unref (batch->netns);
+	g_slice_free (_take_devices_batch, batch);
+}
+
+static void
+_take_devices_cb (gpointer user_data, gboolean timeout)
+{
+	_take_devices_item *item = user_data;
+	_take_devices_batch *batch = item->batch;
+
+	if (timeout) {
+		nm_log_dbg (LOGD_NETNS, "Timeout while waiting for device %d to appear in network namespace %s",
+		            item->ifindex, nm_netns_get_name (batch->netns));
+		_take_devices_batch_fail (batch, "Timeout while waiting for device to appear in the target namespace.");
+	} else if (!nm_netns_get_device_by_ifindex (batch->netns, item->ifindex)) {
+		nm_log_dbg (LOGD_NETNS, "Device %d not found in the target network namespace %s",
+		            item->ifindex, nm_netns_get_name (batch->netns));
+		_take_devices_batch_fail (batch, "Device didn't appear in the network namespace.");
+	}
+
+	g_slice_free (_take_devices_item, item);
+	_take_devices_batch_unref (batch);
+}
+
+static void
+impl_netns_take_devices (NMNetns *self,
+                         GDBusMethodInvocation *context,
+                         const char *const *device_paths,
+                         int timeout)
+{
+	gs_unref_ptrarray GPtrArray *devices = NULL;
+	_take_devices_batch *batch;
+	guint i;
+
+	/*
+	 * Validate all devices before moving any of them so that
+	 * a bad path doesn't leave the set half moved.
+	 */
+	devices = g_ptr_array_new ();
+	for (i = 0; device_paths && device_paths[i]; i++) {
+		NMDevice *device;
+
+		device = nm_netns_controller_find_device_by_path (device_paths[i]);
+		if (!device) {
+			g_dbus_method_invocation_return_error (context,
+			                                       NM_NETNS_ERROR,
+			                                       NM_NETNS_ERROR_UNKNOWN_DEVICE,
+			                                       "Device %s not found.",
+			                                       device_paths[i]);
+			return;
+		}
+
+		if (nm_device_get_netns (device) == self) {
+			g_dbus_method_invocation_return_error (context,
+			                                       NM_NETNS_ERROR,
+			                                       NM_NETNS_ERROR_DEVICE_ALREADY_IN_NETNS,
+			                                       "Device %s already in target namespace.",
+			                                       device_paths[i]);
+			return;
+		}
+
+		if (_nm_utils_ptrarray_find_first (devices->pdata, devices->len, device) >= 0) {
+			g_dbus_method_invocation_return_error (context,
+			                                       NM_NETNS_ERROR,
+			                                       NM_NETNS_ERROR_FAILED,
+			                                       "Device %s given more than once.",
+			                                       device_paths[i]);
+			return;
+		}
+
+		g_ptr_array_add (devices, device);
+	}
+
+	if (devices->len == 0) {
+		g_dbus_method_invocation_return_value (context, NULL);
 		return;
 	}
+
+	batch = g_slice_new0 (_take_devices_batch);
+	batch->netns = g_object_ref (self);
+	batch->context = context;
+
+	/*
+	 * Hold one extra reference while issuing the moves so that
+	 * devices that arrive synchronously can't complete the batch early.
+	 */
+	batch->pending = 1;
+
+	for (i = 0; i < devices->len; i++) {
+		NMDevice *device = devices->pdata[i];
+		_take_devices_item *item;
+
+		item = g_slice_new (_take_devices_item);
+		item->batch = batch;
+		item->ifindex = nm_device_get_ifindex (device);
+
+		batch->pending++;
+		if (!nm_netns_take_device (self, device, timeout, _take_devices_cb, item)) {
+			g_slice_free (_take_devices_item, item);
+			batch->pending--;
+			_take_devices_batch_fail (batch, "Error moving device to target namespace");
+			break;
+		}
+	}
+
+	_take_devices_batch_unref (batch);
 }
 
 /**
@@ -3219,6 +3423,8 @@ nm_netns_init (NMNetns *self)
 	/* Take network namespace to manage/use */
 	priv->nmp_netns = nmp_netns_get_current();
 
+	priv->devices_change = g_hash_table_new (g_direct_hash, g_direct_equal);
+
 	/* Load VPN plugins */
 	priv->vpn_manager = g_object_ref (nm_vpn_manager_get ());
 }
@@ -3252,6 +3458,9 @@ finalize (GObject *object)
 
 	g_free (priv->name);
 
+	/* Every pending waiter holds a reference, so the table is empty here */
+	g_hash_table_unref (priv->devices_change);
+
 	g_clear_object (&priv->platform);
 	g_clear_object (&priv->default_route_manager);
 	g_clear_object (&priv->route_manager);
@@ -3400,6 +3609,7 @@ nm_netns_class_init (NMNetnsClass *klass)
 	                                        "GetDevices", impl_netns_get_devices,
 	                                        "GetAllDevices", impl_netns_get_all_devices,
 	                                        "TakeDevice", impl_netns_take_device,
+	                                        "TakeDevices", impl_netns_take_devices,
 	                                        "ActivateConnection", impl_netns_activate_connection,
 	                                        NULL);
 }
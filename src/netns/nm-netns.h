@@ -76,6 +76,7 @@ GType nm_netns_get_type (void);
 
 NMNetns *nm_netns_new (const char *name);
 
+gboolean nm_netns_prepare (NMNetns *netns);
 gboolean nm_netns_setup (NMNetns *netns);
 
 void nm_netns_stop (NMNetns *netns);
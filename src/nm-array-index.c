@@ -0,0 +1,250 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-array-index.h"
+
+#include <string.h>
+
+struct NMArrayIndex {
+	NMArrayIndexFuncHash hash_fcn;
+	NMArrayIndexFuncEqual equal_fcn;
+
+	/* the array and the number of its elements that are currently
+	 * indexed. Only used to detect a stale index, never dereferenced
+	 * outside of a lookup. */
+	const GArray *array;
+	guint len;
+
+	/* open addressing table with linear probing. Each slot holds
+	 * the position of an element in the array plus one, zero means
+	 * the slot is empty. @n_slots is a power of two. */
+	guint *slots;
+	guint n_slots;
+	guint elem_size;
+
+	bool valid:1;
+};
+
+/******************************************************************************************/
+
+#define _ELEM(array, elem_size, pos) ((gconstpointer) &((array)->data[(gsize) (pos) * (elem_size)]))
+
+static guint
+_hash_mix (guint h)
+{
+	/* the table is masked to its low bits, so spread the
+	 * caller's hash which might be weak there. */
+	h ^= h >> 16;
+	h *= 0x45d9f3bu;
+	h ^= h >> 16;
+	return h;
+}
+
+static guint *
+_slot_find (const NMArrayIndex *index, const GArray *array, gconstpointer needle)
+{
+	guint mask = index->n_slots - 1;
+	guint i;
+
+	for (i = _hash_mix (index->hash_fcn (needle)) & mask; index->slots[i]; i = (i + 1) & mask) {
+		if (index->equal_fcn (_ELEM (array, index->elem_size, index->slots[i] - 1), needle))
+			break;
+	}
+	return &index->slots[i];
+}
+
+static void
+_slot_add (NMArrayIndex *index, const GArray *array, guint pos)
+{
+	guint *slot;
+
+	slot = _slot_find (index, array, _ELEM (array, index->elem_size, pos));
+
+	/* keep the first occurrence for elements that compare equal. */
+	if (!*slot)
+		*slot = pos + 1;
+}
+
+static void
+_rebuild (NMArrayIndex *index, const GArray *array)
+{
+	guint n_slots = 8;
+	guint i;
+
+	while (n_slots < array->len * 2)
+		n_slots <<= 1;
+
+	if (n_slots != index->n_slots) {
+		g_free (index->slots);
+		index->slots = g_new0 (guint, n_slots);
+		index->n_slots = n_slots;
+	} else
+		memset (index->slots, 0, sizeof (guint) * n_slots);
+
+	index->array = array;
+	index->elem_size = g_array_get_element_size ((GArray *) array);
+	for (i = 0; i < array->len; i++)
+		_slot_add (index, array, i);
+	index->len = array->len;
+	index->valid = TRUE;
+}
+
+/******************************************************************************************/
+
+/**
+ * nm_array_index_invalidate:
+ * @index: the #NMArrayIndex
+ *
+ * Marks the index as stale after the array was modified in any other way
+ * than by appending a single element.
+ */
+void
+nm_array_index_invalidate (NMArrayIndex *index)
+{
+	g_return_if_fail (index);
+
+	index->valid = FALSE;
+}
+
+/**
+ * nm_array_index_append:
+ * @index: the #NMArrayIndex
+ * @array: the indexed array, after appending one element to it
+ *
+ * Adds the last element of @array to the index. If the index is not
+ * up to date, it is left stale and rebuilt on the next lookup.
+ */
+void
+nm_array_index_append (NMArrayIndex *index, const GArray *array)
+{
+	g_return_if_fail (index);
+	g_return_if_fail (array);
+
+	if (   !index->valid
+	    || index->array != array
+	    || index->len + 1 != array->len) {
+		index->valid = FALSE;
+		return;
+	}
+
+	if (array->len * 2 > index->n_slots) {
+		_rebuild (index, array);
+		return;
+	}
+
+	_slot_add (index, array, array->len - 1);
+	index->len = array->len;
+}
+
+/**
+ * nm_array_index_lookup:
+ * @index: the #NMArrayIndex
+ * @array: the indexed array
+ * @needle: the element to search for
+ *
+ * Returns: the position of the first element in @array that equals
+ *   @needle, or -1 if there is none.
+ */
+gssize
+nm_array_index_lookup (NMArrayIndex *index, const GArray *array, gconstpointer needle)
+{
+	guint pos;
+
+	g_return_val_if_fail (index, -1);
+	g_return_val_if_fail (array, -1);
+	g_return_val_if_fail (needle, -1);
+
+	if (array->len == 0)
+		return -1;
+
+	if (   !index->valid
+	    || index->array != array
+	    || index->len != array->len)
+		_rebuild (index, array);
+
+	pos = *_slot_find (index, array, needle);
+	return pos ? (gssize) (pos - 1) : -1;
+}
+
+/**
+ * nm_array_index_remove_flagged:
+ * @index: the #NMArrayIndex
+ * @array: the indexed array
+ * @flags: an array with one entry per element of @array
+ *
+ * Removes all elements of @array whose entry in @flags is non-zero in
+ * a single pass, keeping the order of the remaining elements.
+ *
+ * Returns: whether any element was removed.
+ */
+gboolean
+nm_array_index_remove_flagged (NMArrayIndex *index, GArray *array, const guint8 *flags)
+{
+	guint elem_size;
+	guint i, j;
+
+	g_return_val_if_fail (index, FALSE);
+	g_return_val_if_fail (array, FALSE);
+	g_return_val_if_fail (flags || array->len == 0, FALSE);
+
+	elem_size = g_array_get_element_size (array);
+	for (i = 0, j = 0; i < array->len; i++) {
+		if (flags[i])
+			continue;
+		if (i != j)
+			memcpy (&array->data[(gsize) j * elem_size], &array->data[(gsize) i * elem_size], elem_size);
+		j++;
+	}
+
+	if (j == array->len)
+		return FALSE;
+
+	g_array_set_size (array, j);
+	index->valid = FALSE;
+	return TRUE;
+}
+
+/******************************************************************************************/
+
+NMArrayIndex *
+nm_array_index_new (NMArrayIndexFuncHash hash_fcn,
+                    NMArrayIndexFuncEqual equal_fcn)
+{
+	NMArrayIndex *index;
+
+	g_return_val_if_fail (hash_fcn, NULL);
+	g_return_val_if_fail (equal_fcn, NULL);
+
+	index = g_slice_new0 (NMArrayIndex);
+	index->hash_fcn = hash_fcn;
+	index->equal_fcn = equal_fcn;
+	return index;
+}
+
+void
+nm_array_index_free (NMArrayIndex *index)
+{
+	g_return_if_fail (index);
+
+	g_free (index->slots);
+	g_slice_free (NMArrayIndex, index);
+}
@@ -0,0 +1,63 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#ifndef __NM_ARRAY_INDEX__
+#define __NM_ARRAY_INDEX__
+
+#include "nm-default.h"
+
+G_BEGIN_DECLS
+
+/* NMArrayIndex is a hash index on top of a GArray of fixed size elements.
+ * The array stays the owner of the data and keeps its order, the index only
+ * maps an element (by the identity given by @hash_fcn/@equal_fcn) to the
+ * position of its first occurrence in the array.
+ *
+ * Appending to the array is tracked incrementally with nm_array_index_append().
+ * Any other modification of the array (removal, sorting, replacing) requires a
+ * call to nm_array_index_invalidate(); the index is then rebuilt lazily on the
+ * next lookup. */
+
+typedef struct NMArrayIndex NMArrayIndex;
+
+typedef guint (*NMArrayIndexFuncHash) (gconstpointer elem);
+typedef gboolean (*NMArrayIndexFuncEqual) (gconstpointer elem_a, gconstpointer elem_b);
+
+NMArrayIndex *nm_array_index_new (NMArrayIndexFuncHash hash_fcn,
+                                  NMArrayIndexFuncEqual equal_fcn);
+
+void nm_array_index_free (NMArrayIndex *index);
+
+void nm_array_index_invalidate (NMArrayIndex *index);
+
+void nm_array_index_append (NMArrayIndex *index,
+                            const GArray *array);
+
+gssize nm_array_index_lookup (NMArrayIndex *index,
+                              const GArray *array,
+                              gconstpointer needle);
+
+gboolean nm_array_index_remove_flagged (NMArrayIndex *index,
+                                        GArray *array,
+                                        const guint8 *flags);
+
+G_END_DECLS
+
+#endif /* __NM_ARRAY_INDEX__ */
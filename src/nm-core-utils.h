@@ -279,6 +279,45 @@ void nm_utils_strbuf_append (char **buf, gsize *len, const char *format, ...) __
 void nm_utils_strbuf_append_c (char **buf, gsize *len, char c);
 void nm_utils_strbuf_append_str (char **buf, gsize *len, const char *str);
 
+/*****************************************************************************/
+
+/* A cheap 64 bit FNV-1a hash, for fingerprinting objects so that
+ * unequal ones can be told apart without comparing them in full. */
+
+#define NM_HASH64_INIT ((guint64) 14695981039346656037ull)
+
+static inline guint64
+nm_hash64_update (guint64 h, gconstpointer data, gsize len)
+{
+	const guint8 *p = data;
+	gsize i;
+
+	for (i = 0; i < len; i++) {
+		h ^= p[i];
+		h *= (guint64) 1099511628211ull;
+	}
+	return h;
+}
+
+static inline guint64
+nm_hash64_update_u32 (guint64 h, guint32 n)
+{
+	return nm_hash64_update (h, &n, sizeof (n));
+}
+
+static inline guint64
+nm_hash64_update_str (guint64 h, const char *s)
+{
+	/* include the terminating NUL so that "ab","c" and "a","bc" differ. */
+	if (!s)
+		return h;
+	do {
+		h ^= (guint8) *s;
+		h *= (guint64) 1099511628211ull;
+	} while (*s++);
+	return h;
+}
+
 const char *nm_utils_get_ip_config_method (NMConnection *connection,
                                            GType         ip_setting_type);
 
@@ -25,6 +25,7 @@
 
 #include "nm-exported-object.h"
 #include "nm-bus-manager.h"
+#include "nm-core-utils.h"
 
 static GHashTable *prefix_counters;
 static gboolean quitting = FALSE;
@@ -44,8 +45,12 @@ typedef struct {
 	NMBusManager *bus_mgr;
 	char *path;
 
-	GVariantBuilder pending_notifies;
+	/* properties that changed since the last PropertiesChanged signal,
+	 * mapping the GParamSpec to its D-Bus name. The values are only
+	 * read and serialized when the signal is emitted. */
+	GHashTable *pending_notifies;
 	guint notify_idle_id;
+	gint64 notify_last_emit_ms;
 
 #ifdef _ASSERT_NO_EARLY_EXPORT
 	gboolean _constructed;
@@ -659,8 +664,7 @@ nm_exported_object_unexport (NMExportedObject *self)
 	if (nm_clear_g_source (&priv->notify_idle_id)) {
 		/* We had a notification queued. Since we removed all interfaces,
 		 * the notification is obsolete and must be cleaned up. */
-		g_variant_builder_clear (&priv->pending_notifies);
-		g_variant_builder_init (&priv->pending_notifies, G_VARIANT_TYPE_VARDICT);
+		g_hash_table_remove_all (priv->pending_notifies);
 	}
 }
 
@@ -719,7 +723,62 @@ nm_exported_object_init (NMExportedObject *self)
 {
 	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
 
-	g_variant_builder_init (&priv->pending_notifies, G_VARIANT_TYPE_VARDICT);
+	priv->pending_notifies = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+static const GVariantType *
+find_dbus_property_type (GDBusInterfaceSkeleton *skel,
+                         const char *dbus_property_name)
+{
+	GDBusInterfaceInfo *iinfo;
+	int i;
+
+	iinfo = g_dbus_interface_skeleton_get_info (skel);
+	for (i = 0; iinfo->properties[i]; i++) {
+		if (!strcmp (iinfo->properties[i]->name, dbus_property_name))
+			return G_VARIANT_TYPE (iinfo->properties[i]->signature);
+	}
+
+	return NULL;
+}
+
+static GVariant *
+_pending_notifies_serialize (NMExportedObject *self)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+	GVariantBuilder builder;
+	GHashTableIter hiter;
+	GParamSpec *pspec;
+	const char *dbus_property_name;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+	g_hash_table_iter_init (&hiter, priv->pending_notifies);
+	while (g_hash_table_iter_next (&hiter, (gpointer *) &pspec, (gpointer *) &dbus_property_name)) {
+		GValue value = G_VALUE_INIT;
+		const GVariantType *vtype = NULL;
+		GVariant *variant;
+		GSList *iter;
+
+		for (iter = priv->interfaces; iter && !vtype; iter = iter->next)
+			vtype = find_dbus_property_type (iter->data, dbus_property_name);
+		if (!vtype) {
+			g_warn_if_reached ();
+			continue;
+		}
+
+		g_value_init (&value, pspec->value_type);
+		g_object_get_property (G_OBJECT (self), pspec->name, &value);
+		variant = g_dbus_gvalue_to_gvariant (&value, vtype);
+		g_variant_builder_add (&builder, "{sv}",
+		                       dbus_property_name,
+		                       variant);
+		g_value_unset (&value);
+		g_variant_unref (variant);
+	}
+	g_hash_table_remove_all (priv->pending_notifies);
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
 }
 
 static gboolean
@@ -732,9 +791,6 @@ idle_emit_properties_changed (gpointer self)
 	guint signal_id = 0;
 
 	priv->notify_idle_id = 0;
-	notifies = g_variant_builder_end (&priv->pending_notifies);
-	g_variant_ref_sink (notifies);
-	g_variant_builder_init (&priv->pending_notifies, G_VARIANT_TYPE_VARDICT);
 
 	for (iter = priv->interfaces; iter; iter = iter->next) {
 		signal_id = g_signal_lookup ("properties-changed", G_OBJECT_TYPE (iter->data));
@@ -743,7 +799,14 @@ idle_emit_properties_changed (gpointer self)
 			break;
 		}
 	}
-	g_return_val_if_fail (signal_id != 0, FALSE);
+	if (signal_id == 0) {
+		g_hash_table_remove_all (priv->pending_notifies);
+		g_return_val_if_reached (FALSE);
+	}
+
+	/* Each property is serialized only once, with its latest value, no
+	 * matter how often it was notified since the last emission. */
+	notifies = _pending_notifies_serialize (self);
 
 	if (nm_logging_enabled (LOGL_DEBUG, LOGD_DBUS_PROPS)) {
 		char *notification;
@@ -754,26 +817,38 @@ idle_emit_properties_changed (gpointer self)
 		g_free (notification);
 	}
 
+	if (NM_EXPORTED_OBJECT_GET_CLASS (self)->properties_changed_min_interval)
+		priv->notify_last_emit_ms = nm_utils_get_monotonic_timestamp_ms ();
+
 	g_signal_emit (interface, signal_id, 0, notifies);
 	g_variant_unref (notifies);
 
 	return FALSE;
 }
 
-static const GVariantType *
-find_dbus_property_type (GDBusInterfaceSkeleton *skel,
-                         const char *dbus_property_name)
+static void
+_schedule_emit_properties_changed (NMExportedObject *self)
 {
-	GDBusInterfaceInfo *iinfo;
-	int i;
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+	guint interval;
+	gint64 now;
 
-	iinfo = g_dbus_interface_skeleton_get_info (skel);
-	for (i = 0; iinfo->properties[i]; i++) {
-		if (!strcmp (iinfo->properties[i]->name, dbus_property_name))
-			return G_VARIANT_TYPE (iinfo->properties[i]->signature);
+	if (priv->notify_idle_id)
+		return;
+
+	/* rate limit objects that change a lot: after an emission, wait
+	 * at least the class' interval before sending the next one. */
+	interval = NM_EXPORTED_OBJECT_GET_CLASS (self)->properties_changed_min_interval;
+	if (interval && priv->notify_last_emit_ms) {
+		now = nm_utils_get_monotonic_timestamp_ms ();
+		if (now < priv->notify_last_emit_ms + interval) {
+			priv->notify_idle_id = g_timeout_add (priv->notify_last_emit_ms + interval - now,
+			                                      idle_emit_properties_changed, self);
+			return;
+		}
 	}
 
-	return NULL;
+	priv->notify_idle_id = g_idle_add (idle_emit_properties_changed, self);
 }
 
 static void
@@ -783,10 +858,6 @@ nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 	NMExportedObjectClassInfo *classinfo;
 	GType type;
 	const char *dbus_property_name = NULL;
-	GValue value = G_VALUE_INIT;
-	const GVariantType *vtype;
-	GVariant *variant;
-	GSList *iter;
 
 	if (!priv->interfaces)
 		return;
@@ -806,23 +877,8 @@ nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 		return;
 	}
 
-	g_value_init (&value, pspec->value_type);
-	g_object_get_property (G_OBJECT (object), pspec->name, &value);
-
-	vtype = NULL;
-	for (iter = priv->interfaces; iter && !vtype; iter = iter->next)
-		vtype = find_dbus_property_type (iter->data, dbus_property_name);
-	g_return_if_fail (vtype != NULL);
-
-	variant = g_dbus_gvalue_to_gvariant (&value, vtype);
-	g_variant_builder_add (&priv->pending_notifies, "{sv}",
-	                       dbus_property_name,
-	                       variant);
-	g_value_unset (&value);
-	g_variant_unref (variant);
-
-	if (!priv->notify_idle_id)
-		priv->notify_idle_id = g_idle_add (idle_emit_properties_changed, object);
+	g_hash_table_insert (priv->pending_notifies, pspec, (gpointer) dbus_property_name);
+	_schedule_emit_properties_changed ((NMExportedObject *) object);
 }
 
 static void
@@ -858,12 +914,22 @@ nm_exported_object_dispose (GObject *object)
 	} else
 		g_clear_pointer (&priv->path, g_free);
 
-	g_variant_builder_clear (&priv->pending_notifies);
+	g_hash_table_remove_all (priv->pending_notifies);
 	nm_clear_g_source (&priv->notify_idle_id);
 
 	G_OBJECT_CLASS (nm_exported_object_parent_class)->dispose (object);
 }
 
+static void
+nm_exported_object_finalize (GObject *object)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (object);
+
+	g_hash_table_unref (priv->pending_notifies);
+
+	G_OBJECT_CLASS (nm_exported_object_parent_class)->finalize (object);
+}
+
 static void
 nm_exported_object_class_init (NMExportedObjectClass *klass)
 {
@@ -874,6 +940,7 @@ nm_exported_object_class_init (NMExportedObjectClass *klass)
 	object_class->constructed = constructed;
 	object_class->notify = nm_exported_object_notify;
 	object_class->dispose = nm_exported_object_dispose;
+	object_class->finalize = nm_exported_object_finalize;
 }
 
 void
@@ -60,6 +60,10 @@ typedef struct {
 
 	const char *export_path;
 	char export_on_construction;
+
+	/* minimum time in milliseconds between two PropertiesChanged
+	 * signals of an object, 0 for no rate limiting. */
+	guint properties_changed_min_interval;
 } NMExportedObjectClass;
 
 GType nm_exported_object_get_type (void);
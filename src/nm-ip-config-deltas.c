@@ -0,0 +1,203 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-ip-config-deltas.h"
+
+#include <string.h>
+
+void
+nm_ip_config_deltas_clear (NMIPConfigDeltas *deltas)
+{
+	if (deltas->routes) {
+		g_array_unref (deltas->routes);
+		deltas->routes = NULL;
+	}
+}
+
+void
+nm_ip_config_deltas_reset (NMIPConfigDeltas *deltas, gboolean need_full)
+{
+	if (deltas->routes)
+		g_array_set_size (deltas->routes, 0);
+	deltas->need_full = need_full;
+}
+
+void
+nm_ip_config_deltas_add_route (NMIPConfigDeltas *deltas,
+                               NMPlatformSignalChangeType change_type,
+                               gconstpointer route,
+                               gsize route_size)
+{
+	NMIPRouteDelta *delta;
+
+	nm_assert (route_size == sizeof (NMPlatformIP4Route) || route_size == sizeof (NMPlatformIP6Route));
+
+	if (deltas->need_full)
+		return;
+
+	/* default routes determine the gateway and the route metric of the
+	 * captured configuration. */
+	if (   NM_PLATFORM_IP_ROUTE_IS_DEFAULT (route)
+	    || (deltas->routes && deltas->routes->len >= NM_IP_CONFIG_DELTAS_MAX)) {
+		nm_ip_config_deltas_reset (deltas, TRUE);
+		return;
+	}
+
+	if (!deltas->routes)
+		deltas->routes = g_array_new (FALSE, FALSE, sizeof (NMIPRouteDelta));
+	g_array_set_size (deltas->routes, deltas->routes->len + 1);
+	delta = &g_array_index (deltas->routes, NMIPRouteDelta, deltas->routes->len - 1);
+	memset (delta, 0, sizeof (*delta));
+	delta->change_type = change_type;
+	memcpy (&delta->rx, route, route_size);
+}
+
+/**
+ * nm_ip_config_deltas_replay_ip4:
+ * @deltas: the recorded route changes
+ * @captured: the configuration captured before the changes
+ *
+ * Brings @captured up to date with the recorded route changes. Gives up
+ * whenever the result could differ from what nm_ip4_config_capture()
+ * returns: for routes that have the same destination as another one (the
+ * configuration keeps only one of them) and for the host route to the
+ * gateway. @captured must then be discarded.
+ *
+ * Returns: %TRUE if @captured is up to date, %FALSE if a full capture
+ *   is needed.
+ */
+gboolean
+nm_ip_config_deltas_replay_ip4 (const NMIPConfigDeltas *deltas, NMIP4Config *captured)
+{
+	guint i;
+
+	if (deltas->need_full)
+		return FALSE;
+	if (!deltas->routes)
+		return TRUE;
+
+	for (i = 0; i < deltas->routes->len; i++) {
+		const NMIPRouteDelta *delta = &g_array_index (deltas->routes, NMIPRouteDelta, i);
+		const NMPlatformIP4Route *route = &delta->r4;
+		const NMPlatformIP4Route *existing;
+
+		if (route->source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL) {
+			if (delta->change_type == NM_PLATFORM_SIGNAL_CHANGED)
+				return FALSE;
+			continue;
+		}
+		if (   route->plen == 32
+		    && !route->gateway
+		    && nm_ip4_config_has_gateway (captured)
+		    && route->network == nm_ip4_config_get_gateway (captured))
+			return FALSE;
+
+		existing = nm_ip4_config_lookup_route (captured, route);
+		switch (delta->change_type) {
+		case NM_PLATFORM_SIGNAL_ADDED:
+			if (existing)
+				return FALSE;
+			nm_ip4_config_add_route (captured, route);
+			break;
+		case NM_PLATFORM_SIGNAL_CHANGED:
+			if (!existing || existing->metric != route->metric)
+				return FALSE;
+			nm_ip4_config_add_route (captured, route);
+			break;
+		case NM_PLATFORM_SIGNAL_REMOVED:
+			if (!existing || existing->metric != route->metric)
+				return FALSE;
+			nm_ip4_config_remove_route (captured, route);
+			if (nm_ip4_config_lookup_route (captured, route))
+				return FALSE;
+			break;
+		default:
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * nm_ip_config_deltas_replay_ip6:
+ * @deltas: the recorded route changes
+ * @captured: the configuration captured before the changes
+ *
+ * The IPv6 variant of nm_ip_config_deltas_replay_ip4().
+ *
+ * Returns: %TRUE if @captured is up to date, %FALSE if a full capture
+ *   is needed.
+ */
+gboolean
+nm_ip_config_deltas_replay_ip6 (const NMIPConfigDeltas *deltas, NMIP6Config *captured)
+{
+	const struct in6_addr *gateway;
+	guint i;
+
+	if (deltas->need_full)
+		return FALSE;
+	if (!deltas->routes)
+		return TRUE;
+
+	gateway = nm_ip6_config_get_gateway (captured);
+
+	for (i = 0; i < deltas->routes->len; i++) {
+		const NMIPRouteDelta *delta = &g_array_index (deltas->routes, NMIPRouteDelta, i);
+		const NMPlatformIP6Route *route = &delta->r6;
+		const NMPlatformIP6Route *existing;
+
+		if (route->source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL) {
+			if (delta->change_type == NM_PLATFORM_SIGNAL_CHANGED)
+				return FALSE;
+			continue;
+		}
+		if (   route->plen == 128
+		    && IN6_IS_ADDR_UNSPECIFIED (&route->gateway)
+		    && gateway
+		    && IN6_ARE_ADDR_EQUAL (&route->network, gateway))
+			return FALSE;
+
+		existing = nm_ip6_config_lookup_route (captured, route);
+		switch (delta->change_type) {
+		case NM_PLATFORM_SIGNAL_ADDED:
+			if (existing)
+				return FALSE;
+			nm_ip6_config_add_route (captured, route);
+			break;
+		case NM_PLATFORM_SIGNAL_CHANGED:
+			if (!existing || existing->metric != route->metric)
+				return FALSE;
+			nm_ip6_config_add_route (captured, route);
+			break;
+		case NM_PLATFORM_SIGNAL_REMOVED:
+			if (!existing || existing->metric != route->metric)
+				return FALSE;
+			nm_ip6_config_remove_route (captured, route);
+			if (nm_ip6_config_lookup_route (captured, route))
+				return FALSE;
+			break;
+		default:
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
@@ -0,0 +1,76 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#ifndef __NM_IP_CONFIG_DELTAS_H__
+#define __NM_IP_CONFIG_DELTAS_H__
+
+#include "nm-default.h"
+
+#include "nm-platform.h"
+#include "nm-ip4-config.h"
+#include "nm-ip6-config.h"
+
+G_BEGIN_DECLS
+
+/* NMIPConfigDeltas records the route changes of an interface since its
+ * configuration was last captured from platform, so that the captured
+ * configuration can be brought up to date without capturing it again.
+ * Whenever the result could differ from a new capture, the deltas are
+ * dropped and @need_full is set instead. */
+
+/* Beyond this number of pending route changes, a full capture is cheaper
+ * than replaying them one by one. */
+#define NM_IP_CONFIG_DELTAS_MAX 64
+
+typedef struct {
+	NMPlatformSignalChangeType change_type;
+	union {
+		NMPlatformIPRoute rx;
+		NMPlatformIP4Route r4;
+		NMPlatformIP6Route r6;
+	};
+} NMIPRouteDelta;
+
+typedef struct {
+	GArray *routes; /* NMIPRouteDelta */
+
+	/* set when a change happened that can only be handled by capturing the
+	 * whole configuration from platform again. */
+	bool need_full:1;
+
+	/* set while the external configuration is being updated. */
+	bool updating:1;
+} NMIPConfigDeltas;
+
+void nm_ip_config_deltas_clear (NMIPConfigDeltas *deltas);
+
+void nm_ip_config_deltas_reset (NMIPConfigDeltas *deltas, gboolean need_full);
+
+void nm_ip_config_deltas_add_route (NMIPConfigDeltas *deltas,
+                                    NMPlatformSignalChangeType change_type,
+                                    gconstpointer route,
+                                    gsize route_size);
+
+gboolean nm_ip_config_deltas_replay_ip4 (const NMIPConfigDeltas *deltas, NMIP4Config *captured);
+gboolean nm_ip_config_deltas_replay_ip6 (const NMIPConfigDeltas *deltas, NMIP6Config *captured);
+
+G_END_DECLS
+
+#endif /* __NM_IP_CONFIG_DELTAS_H__ */
@@ -34,6 +34,7 @@
 #include "nm-core-internal.h"
 #include "nm-macros-internal.h"
 #include "nm-netns-controller.h"
+#include "nm-array-index.h"
 
 #include "nmdbus-ip4-config.h"
 
@@ -47,6 +48,8 @@ typedef struct _NMIP4ConfigPrivate {
 	gboolean has_gateway;
 	GArray *addresses;
 	GArray *routes;
+	NMArrayIndex *addresses_idx;
+	NMArrayIndex *routes_idx;
 	GArray *nameservers;
 	GPtrArray *domains;
 	GPtrArray *searches;
@@ -60,13 +63,17 @@ typedef struct _NMIP4ConfigPrivate {
 	int ifindex;
 	gint64 route_metric;
 	gboolean metered;
+
+	/* cached result of _fingerprint_get(), see nm_ip4_config_equal(). */
+	guint64 fingerprint;
+	bool fingerprint_valid:1;
 } NMIP4ConfigPrivate;
 
 /* internal guint32 are assigned to gobject properties of type uint. Ensure, that uint is large enough */
 G_STATIC_ASSERT (sizeof (uint) >= sizeof (guint32));
 G_STATIC_ASSERT (G_MAXUINT >= 0xFFFFFFFF);
 
-NM_GOBJECT_PROPERTIES_DEFINE (NMIP4Config,
+NM_GOBJECT_PROPERTIES_DEFINE_BASE (
 	PROP_IFINDEX,
 	PROP_ADDRESS_DATA,
 	PROP_ADDRESSES,
@@ -80,6 +87,17 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMIP4Config,
 	PROP_WINS_SERVERS,
 );
 
+static void
+_notify (NMIP4Config *self, _PropertyEnums prop)
+{
+	nm_assert ((gsize) prop < G_N_ELEMENTS (obj_properties));
+
+	/* all changes that affect nm_ip4_config_equal() are notified,
+	 * except for NIS which invalidates the fingerprint on its own. */
+	NM_IP4_CONFIG_GET_PRIVATE (self)->fingerprint_valid = FALSE;
+	g_object_notify_by_pspec ((GObject *) self, obj_properties[prop]);
+}
+
 NMIP4Config *
 nm_ip4_config_new (int ifindex)
 {
@@ -89,6 +107,18 @@ nm_ip4_config_new (int ifindex)
 	                                     NULL);
 }
 
+NMIP4Config *
+nm_ip4_config_new_cloned (const NMIP4Config *src)
+{
+	NMIP4Config *new;
+
+	g_return_val_if_fail (NM_IS_IP4_CONFIG (src), NULL);
+
+	new = nm_ip4_config_new (nm_ip4_config_get_ifindex (src));
+	nm_ip4_config_replace (new, src, NULL);
+	return new;
+}
+
 int
 nm_ip4_config_get_ifindex (const NMIP4Config *config)
 {
@@ -185,6 +215,41 @@ routes_are_duplicate (const NMPlatformIP4Route *a, const NMPlatformIP4Route *b,
 	       (!consider_gateway_and_metric || (a->gateway == b->gateway && a->metric == b->metric));
 }
 
+/* hash and equality functions for the address and route indexes. They must
+ * agree with addresses_are_duplicate() and routes_are_duplicate(). */
+
+static guint
+_addresses_idx_hash (gconstpointer elem)
+{
+	const NMPlatformIP4Address *a = elem;
+	guint h;
+
+	h = a->address;
+	h = (h * 33) + a->plen;
+	h = (h * 33) + (a->peer_address & nm_utils_ip4_prefix_to_netmask (a->plen));
+	return h;
+}
+
+static gboolean
+_addresses_idx_equal (gconstpointer elem_a, gconstpointer elem_b)
+{
+	return addresses_are_duplicate (elem_a, elem_b);
+}
+
+static guint
+_routes_idx_hash (gconstpointer elem)
+{
+	const NMPlatformIP4Route *r = elem;
+
+	return (((guint) r->network) * 33) + r->plen;
+}
+
+static gboolean
+_routes_idx_equal (gconstpointer elem_a, gconstpointer elem_b)
+{
+	return routes_are_duplicate (elem_a, elem_b, FALSE);
+}
+
 /*****************************************************************************/
 
 static gint
@@ -242,6 +307,7 @@ nm_ip4_config_addresses_sort (NMIP4Config *self)
 		g_free (data_pre);
 
 		if (changed) {
+			nm_array_index_invalidate (priv->addresses_idx);
 			_notify (self, PROP_ADDRESS_DATA);
 			_notify (self, PROP_ADDRESSES);
 			return TRUE;
@@ -274,6 +340,7 @@ nm_ip4_config_capture (NMNetns *netns, int ifindex, gboolean capture_resolv_conf
 
 	priv->addresses = nm_platform_ip4_address_get_all (nm_netns_get_platform(netns), ifindex);
 	priv->routes = nm_platform_ip4_route_get_all (nm_netns_get_platform(netns), ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+	nm_array_index_invalidate (priv->addresses_idx);
 
 	/* Extract gateway from default route */
 	old_gateway = priv->gateway;
@@ -313,6 +380,7 @@ nm_ip4_config_capture (NMNetns *netns, int ifindex, gboolean capture_resolv_conf
 			}
 		}
 	}
+	nm_array_index_invalidate (priv->routes_idx);
 
 	/* If the interface has the default route, and has IPv4 addresses, capture
 	 * nameservers from /etc/resolv.conf.
@@ -730,15 +798,8 @@ static int
 _addresses_get_index (const NMIP4Config *self, const NMPlatformIP4Address *addr)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->addresses->len; i++) {
-		const NMPlatformIP4Address *a = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
 
-		if (addresses_are_duplicate (addr, a))
-			return (int) i;
-	}
-	return -1;
+	return nm_array_index_lookup (priv->addresses_idx, priv->addresses, addr);
 }
 
 static int
@@ -760,16 +821,8 @@ static int
 _routes_get_index (const NMIP4Config *self, const NMPlatformIP4Route *route)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->routes->len; i++) {
-		const NMPlatformIP4Route *r = &g_array_index (priv->routes, NMPlatformIP4Route, i);
 
-		if (   route->network == r->network
-		    && route->plen == r->plen)
-			return (int) i;
-	}
-	return -1;
+	return nm_array_index_lookup (priv->routes_idx, priv->routes, route);
 }
 
 static int
@@ -859,19 +912,31 @@ _wins_get_index (const NMIP4Config *self, guint32 wins_server)
 void
 nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 {
+	NMIP4ConfigPrivate *dst_priv;
 	guint32 i;
 	gint idx;
 
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP4_CONFIG_GET_PRIVATE (dst);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
-	/* addresses */
-	for (i = 0; i < nm_ip4_config_get_num_addresses (src); i++) {
-		idx = _addresses_get_index (dst, nm_ip4_config_get_address (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_address (dst, idx);
+	/* addresses: flag the matches first and drop them in one pass, so
+	 * that the index of @dst stays valid during the lookups. */
+	if (nm_ip4_config_get_num_addresses (dst) && nm_ip4_config_get_num_addresses (src)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip4_config_get_num_addresses (dst));
+
+		for (i = 0; i < nm_ip4_config_get_num_addresses (src); i++) {
+			idx = _addresses_get_index (dst, nm_ip4_config_get_address (src, i));
+			if (idx >= 0)
+				flags[idx] = TRUE;
+		}
+		if (nm_array_index_remove_flagged (dst_priv->addresses_idx, dst_priv->addresses, flags)) {
+			_notify (dst, PROP_ADDRESS_DATA);
+			_notify (dst, PROP_ADDRESSES);
+		}
 	}
 
 	/* nameservers */
@@ -892,10 +957,18 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 	/* ignore route_metric */
 
 	/* routes */
-	for (i = 0; i < nm_ip4_config_get_num_routes (src); i++) {
-		idx = _routes_get_index (dst, nm_ip4_config_get_route (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_route (dst, idx);
+	if (nm_ip4_config_get_num_routes (dst) && nm_ip4_config_get_num_routes (src)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip4_config_get_num_routes (dst));
+
+		for (i = 0; i < nm_ip4_config_get_num_routes (src); i++) {
+			idx = _routes_get_index (dst, nm_ip4_config_get_route (src, i));
+			if (idx >= 0)
+				flags[idx] = TRUE;
+		}
+		if (nm_array_index_remove_flagged (dst_priv->routes_idx, dst_priv->routes, flags)) {
+			_notify (dst, PROP_ROUTE_DATA);
+			_notify (dst, PROP_ROUTES);
+		}
 	}
 
 	/* domains */
@@ -950,21 +1023,26 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 void
 nm_ip4_config_intersect (NMIP4Config *dst, const NMIP4Config *src)
 {
+	NMIP4ConfigPrivate *dst_priv;
 	guint32 i;
-	gint idx;
 
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP4_CONFIG_GET_PRIVATE (dst);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip4_config_get_num_addresses (dst); ) {
-		idx = _addresses_get_index (src, nm_ip4_config_get_address (dst, i));
-		if (idx < 0)
-			nm_ip4_config_del_address (dst, i);
-		else
-			i++;
+	if (nm_ip4_config_get_num_addresses (dst)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip4_config_get_num_addresses (dst));
+
+		for (i = 0; i < nm_ip4_config_get_num_addresses (dst); i++)
+			flags[i] = _addresses_get_index (src, nm_ip4_config_get_address (dst, i)) < 0;
+		if (nm_array_index_remove_flagged (dst_priv->addresses_idx, dst_priv->addresses, flags)) {
+			_notify (dst, PROP_ADDRESS_DATA);
+			_notify (dst, PROP_ADDRESSES);
+		}
 	}
 
 	/* ignore route_metric */
@@ -978,12 +1056,15 @@ nm_ip4_config_intersect (NMIP4Config *dst, const NMIP4Config *src)
 	}
 
 	/* routes */
-	for (i = 0; i < nm_ip4_config_get_num_routes (dst); ) {
-		idx = _routes_get_index (src, nm_ip4_config_get_route (dst, i));
-		if (idx < 0)
-			nm_ip4_config_del_route (dst, i);
-		else
-			i++;
+	if (nm_ip4_config_get_num_routes (dst)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip4_config_get_num_routes (dst));
+
+		for (i = 0; i < nm_ip4_config_get_num_routes (dst); i++)
+			flags[i] = _routes_get_index (src, nm_ip4_config_get_route (dst, i)) < 0;
+		if (nm_array_index_remove_flagged (dst_priv->routes_idx, dst_priv->routes, flags)) {
+			_notify (dst, PROP_ROUTE_DATA);
+			_notify (dst, PROP_ROUTES);
+		}
 	}
 
 	/* ignore domains */
@@ -1440,6 +1521,7 @@ nm_ip4_config_reset_addresses (NMIP4Config *config)
 
 	if (priv->addresses->len != 0) {
 		g_array_set_size (priv->addresses, 0);
+		nm_array_index_invalidate (priv->addresses_idx);
 		_notify (config, PROP_ADDRESS_DATA);
 		_notify (config, PROP_ADDRESSES);
 	}
@@ -1464,39 +1546,39 @@ nm_ip4_config_add_address (NMIP4Config *config, const NMPlatformIP4Address *new)
 
 	g_return_if_fail (new != NULL);
 
-	for (i = 0; i < priv->addresses->len; i++ ) {
+	i = _addresses_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP4Address *item = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
 
-		if (addresses_are_duplicate (item, new)) {
-			if (nm_platform_ip4_address_cmp (item, new) == 0)
-				return;
-
-			/* remember the old values. */
-			item_old = *item;
-			/* Copy over old item to get new lifetime, timestamp, preferred */
-			*item = *new;
-
-			/* But restore highest priority source */
-			item->source = MAX (item_old.source, new->source);
-
-			/* for addresses that we read from the kernel, we keep the timestamps as defined
-			 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
-			 * with "what should be" and the kernel values are "what turned out after configuring it".
-			 *
-			 * For other sources, the longer lifetime wins. */
-			if (   (new->source == NM_IP_CONFIG_SOURCE_KERNEL && new->source != item_old.source)
-			    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
-				item->timestamp = item_old.timestamp;
-				item->lifetime = item_old.lifetime;
-				item->preferred = item_old.preferred;
-			}
-			if (nm_platform_ip4_address_cmp (&item_old, item) == 0)
-				return;
-			goto NOTIFY;
+		if (nm_platform_ip4_address_cmp (item, new) == 0)
+			return;
+
+		/* remember the old values. */
+		item_old = *item;
+		/* Copy over old item to get new lifetime, timestamp, preferred */
+		*item = *new;
+
+		/* But restore highest priority source */
+		item->source = MAX (item_old.source, new->source);
+
+		/* for addresses that we read from the kernel, we keep the timestamps as defined
+		 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
+		 * with "what should be" and the kernel values are "what turned out after configuring it".
+		 *
+		 * For other sources, the longer lifetime wins. */
+		if (   (new->source == NM_IP_CONFIG_SOURCE_KERNEL && new->source != item_old.source)
+		    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
+			item->timestamp = item_old.timestamp;
+			item->lifetime = item_old.lifetime;
+			item->preferred = item_old.preferred;
 		}
+		if (nm_platform_ip4_address_cmp (&item_old, item) == 0)
+			return;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->addresses, *new);
+	nm_array_index_append (priv->addresses_idx, priv->addresses);
 NOTIFY:
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
@@ -1510,6 +1592,7 @@ nm_ip4_config_del_address (NMIP4Config *config, guint i)
 	g_return_if_fail (i < priv->addresses->len);
 
 	g_array_remove_index (priv->addresses, i);
+	nm_array_index_invalidate (priv->addresses_idx);
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
 }
@@ -1546,6 +1629,7 @@ nm_ip4_config_reset_routes (NMIP4Config *config)
 
 	if (priv->routes->len != 0) {
 		g_array_set_size (priv->routes, 0);
+		nm_array_index_invalidate (priv->routes_idx);
 		_notify (config, PROP_ROUTE_DATA);
 		_notify (config, PROP_ROUTES);
 	}
@@ -1572,23 +1656,23 @@ nm_ip4_config_add_route (NMIP4Config *config, const NMPlatformIP4Route *new)
 	g_return_if_fail (new->plen > 0);
 	g_assert (priv->ifindex);
 
-	for (i = 0; i < priv->routes->len; i++ ) {
+	i = _routes_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP4Route *item = &g_array_index (priv->routes, NMPlatformIP4Route, i);
 
-		if (routes_are_duplicate (item, new, FALSE)) {
-			if (nm_platform_ip4_route_cmp (item, new) == 0)
-				return;
-			old_source = item->source;
-			memcpy (item, new, sizeof (*item));
-			/* Restore highest priority source */
-			item->source = MAX (old_source, new->source);
-			item->ifindex = priv->ifindex;
-			goto NOTIFY;
-		}
+		if (nm_platform_ip4_route_cmp (item, new) == 0)
+			return;
+		old_source = item->source;
+		memcpy (item, new, sizeof (*item));
+		/* Restore highest priority source */
+		item->source = MAX (old_source, new->source);
+		item->ifindex = priv->ifindex;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->routes, *new);
 	g_array_index (priv->routes, NMPlatformIP4Route, priv->routes->len - 1).ifindex = priv->ifindex;
+	nm_array_index_append (priv->routes_idx, priv->routes);
 NOTIFY:
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
@@ -1602,10 +1686,34 @@ nm_ip4_config_del_route (NMIP4Config *config, guint i)
 	g_return_if_fail (i < priv->routes->len);
 
 	g_array_remove_index (priv->routes, i);
+	nm_array_index_invalidate (priv->routes_idx);
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
 }
 
+/**
+ * nm_ip4_config_remove_route:
+ * @config: the #NMIP4Config
+ * @route: the route to remove
+ *
+ * Removes the route that has the same destination as @route.
+ *
+ * Returns: whether a route was removed.
+ */
+gboolean
+nm_ip4_config_remove_route (NMIP4Config *config, const NMPlatformIP4Route *route)
+{
+	int i;
+
+	g_return_val_if_fail (route != NULL, FALSE);
+
+	i = _routes_get_index (config, route);
+	if (i < 0)
+		return FALSE;
+	nm_ip4_config_del_route (config, i);
+	return TRUE;
+}
+
 guint
 nm_ip4_config_get_num_routes (const NMIP4Config *config)
 {
@@ -1622,6 +1730,27 @@ nm_ip4_config_get_route (const NMIP4Config *config, guint i)
 	return &g_array_index (priv->routes, NMPlatformIP4Route, i);
 }
 
+/**
+ * nm_ip4_config_lookup_route:
+ * @config: the #NMIP4Config
+ * @route: the route to search for
+ *
+ * Returns: the route in @config that has the same destination as @route,
+ *   or %NULL if there is none. Routes are identified by network and
+ *   prefix length only, so the returned route might differ from @route
+ *   in its other fields.
+ */
+const NMPlatformIP4Route *
+nm_ip4_config_lookup_route (const NMIP4Config *config, const NMPlatformIP4Route *route)
+{
+	int i;
+
+	g_return_val_if_fail (route != NULL, NULL);
+
+	i = _routes_get_index (config, route);
+	return i >= 0 ? nm_ip4_config_get_route (config, i) : NULL;
+}
+
 const NMPlatformIP4Route *
 nm_ip4_config_get_direct_route_for_host (const NMIP4Config *config, guint32 host)
 {
@@ -1920,6 +2049,7 @@ nm_ip4_config_reset_nis_servers (NMIP4Config *config)
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (config);
 
 	g_array_set_size (priv->nis, 0);
+	priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1933,6 +2063,7 @@ nm_ip4_config_add_nis_server (NMIP4Config *config, guint32 nis)
 			return;
 
 	g_array_append_val (priv->nis, nis);
+	priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1943,6 +2074,7 @@ nm_ip4_config_del_nis_server (NMIP4Config *config, guint i)
 	g_return_if_fail (i < priv->nis->len);
 
 	g_array_remove_index (priv->nis, i);
+	priv->fingerprint_valid = FALSE;
 }
 
 guint32
@@ -1968,6 +2100,7 @@ nm_ip4_config_set_nis_domain (NMIP4Config *config, const char *domain)
 
 	g_free (priv->nis_domain);
 	priv->nis_domain = g_strdup (domain);
+	priv->fingerprint_valid = FALSE;
 }
 
 const char *
@@ -2150,6 +2283,128 @@ nm_ip4_config_hash (const NMIP4Config *config, GChecksum *sum, gboolean dns_only
 
 }
 
+/* The fingerprint covers the same fields as nm_ip4_config_hash() with
+ * @dns_only=FALSE, in the same order, and exactly the fields compared
+ * by _equal_full(). */
+static guint64
+_fingerprint_get (const NMIP4Config *self)
+{
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+	guint64 h = NM_HASH64_INIT;
+	guint i;
+
+	if (priv->fingerprint_valid)
+		return priv->fingerprint;
+
+	h = nm_hash64_update_u32 (h, priv->has_gateway);
+	h = nm_hash64_update_u32 (h, priv->gateway);
+
+	h = nm_hash64_update_u32 (h, priv->addresses->len);
+	for (i = 0; i < priv->addresses->len; i++) {
+		const NMPlatformIP4Address *address = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
+
+		h = nm_hash64_update_u32 (h, address->address);
+		h = nm_hash64_update_u32 (h, address->plen);
+		h = nm_hash64_update_u32 (h, address->peer_address & nm_utils_ip4_prefix_to_netmask (address->plen));
+	}
+
+	h = nm_hash64_update_u32 (h, priv->routes->len);
+	for (i = 0; i < priv->routes->len; i++) {
+		const NMPlatformIP4Route *route = &g_array_index (priv->routes, NMPlatformIP4Route, i);
+
+		h = nm_hash64_update_u32 (h, route->network);
+		h = nm_hash64_update_u32 (h, route->plen);
+		h = nm_hash64_update_u32 (h, route->gateway);
+		h = nm_hash64_update_u32 (h, route->metric);
+	}
+
+	/* prefix each list with its length, so that e.g. a domain is
+	 * not mistaken for a search. */
+	h = nm_hash64_update_u32 (h, priv->nis->len);
+	h = nm_hash64_update (h, priv->nis->data, priv->nis->len * sizeof (guint32));
+	h = nm_hash64_update_u32 (h, !!priv->nis_domain);
+	h = nm_hash64_update_str (h, priv->nis_domain);
+	h = nm_hash64_update_u32 (h, priv->nameservers->len);
+	h = nm_hash64_update (h, priv->nameservers->data, priv->nameservers->len * sizeof (guint32));
+	h = nm_hash64_update_u32 (h, priv->wins->len);
+	h = nm_hash64_update (h, priv->wins->data, priv->wins->len * sizeof (guint32));
+
+	h = nm_hash64_update_u32 (h, priv->domains->len);
+	for (i = 0; i < priv->domains->len; i++)
+		h = nm_hash64_update_str (h, priv->domains->pdata[i]);
+	h = nm_hash64_update_u32 (h, priv->searches->len);
+	for (i = 0; i < priv->searches->len; i++)
+		h = nm_hash64_update_str (h, priv->searches->pdata[i]);
+	h = nm_hash64_update_u32 (h, priv->dns_options->len);
+	for (i = 0; i < priv->dns_options->len; i++)
+		h = nm_hash64_update_str (h, priv->dns_options->pdata[i]);
+
+	priv->fingerprint = h;
+	priv->fingerprint_valid = TRUE;
+	return h;
+}
+
+static gboolean
+_equal_strv (const GPtrArray *a, const GPtrArray *b)
+{
+	guint i;
+
+	if (a->len != b->len)
+		return FALSE;
+	for (i = 0; i < a->len; i++) {
+		if (strcmp (a->pdata[i], b->pdata[i]) != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+_equal_guint32_array (const GArray *a, const GArray *b)
+{
+	return    a->len == b->len
+	       && memcmp (a->data, b->data, a->len * sizeof (guint32)) == 0;
+}
+
+static gboolean
+_equal_full (const NMIP4Config *a, const NMIP4Config *b)
+{
+	NMIP4ConfigPrivate *a_priv = NM_IP4_CONFIG_GET_PRIVATE (a);
+	NMIP4ConfigPrivate *b_priv = NM_IP4_CONFIG_GET_PRIVATE (b);
+	guint i;
+
+	if (   a_priv->has_gateway != b_priv->has_gateway
+	    || a_priv->gateway != b_priv->gateway)
+		return FALSE;
+
+	if (a_priv->addresses->len != b_priv->addresses->len)
+		return FALSE;
+	for (i = 0; i < a_priv->addresses->len; i++) {
+		const NMPlatformIP4Address *a_addr = &g_array_index (a_priv->addresses, NMPlatformIP4Address, i);
+		const NMPlatformIP4Address *b_addr = &g_array_index (b_priv->addresses, NMPlatformIP4Address, i);
+
+		if (!addresses_are_duplicate (a_addr, b_addr))
+			return FALSE;
+	}
+
+	if (a_priv->routes->len != b_priv->routes->len)
+		return FALSE;
+	for (i = 0; i < a_priv->routes->len; i++) {
+		const NMPlatformIP4Route *a_route = &g_array_index (a_priv->routes, NMPlatformIP4Route, i);
+		const NMPlatformIP4Route *b_route = &g_array_index (b_priv->routes, NMPlatformIP4Route, i);
+
+		if (!routes_are_duplicate (a_route, b_route, TRUE))
+			return FALSE;
+	}
+
+	return    _equal_guint32_array (a_priv->nis, b_priv->nis)
+	       && g_strcmp0 (a_priv->nis_domain, b_priv->nis_domain) == 0
+	       && _equal_guint32_array (a_priv->nameservers, b_priv->nameservers)
+	       && _equal_guint32_array (a_priv->wins, b_priv->wins)
+	       && _equal_strv (a_priv->domains, b_priv->domains)
+	       && _equal_strv (a_priv->searches, b_priv->searches)
+	       && _equal_strv (a_priv->dns_options, b_priv->dns_options);
+}
+
 /**
  * nm_ip4_config_equal:
  * @a: first config to compare
@@ -2166,28 +2421,18 @@ nm_ip4_config_hash (const NMIP4Config *config, GChecksum *sum, gboolean dns_only
 gboolean
 nm_ip4_config_equal (const NMIP4Config *a, const NMIP4Config *b)
 {
-	GChecksum *a_checksum = g_checksum_new (G_CHECKSUM_SHA1);
-	GChecksum *b_checksum = g_checksum_new (G_CHECKSUM_SHA1);
-	gsize a_len = g_checksum_type_get_length (G_CHECKSUM_SHA1);
-	gsize b_len = g_checksum_type_get_length (G_CHECKSUM_SHA1);
-	guchar a_data[a_len], b_data[b_len];
-	gboolean equal;
-
-	if (a)
-		nm_ip4_config_hash (a, a_checksum, FALSE);
-	if (b)
-		nm_ip4_config_hash (b, b_checksum, FALSE);
-
-	g_checksum_get_digest (a_checksum, a_data, &a_len);
-	g_checksum_get_digest (b_checksum, b_data, &b_len);
-
-	g_assert (a_len == b_len);
-	equal = !memcmp (a_data, b_data, a_len);
+	if (a == b)
+		return TRUE;
+	if (!a || !b)
+		return FALSE;
 
-	g_checksum_free (a_checksum);
-	g_checksum_free (b_checksum);
+	/* the fingerprints are cached and cover every compared field, so
+	 * a mismatch rejects cheaply. A match can be a collision, so it is
+	 * confirmed by the full comparison. */
+	if (_fingerprint_get (a) != _fingerprint_get (b))
+		return FALSE;
 
-	return equal;
+	return _equal_full (a, b);
 }
 
 /******************************************************************/
@@ -2202,6 +2447,8 @@ nm_ip4_config_init (NMIP4Config *config)
 
 	priv->addresses = g_array_new (FALSE, FALSE, sizeof (NMPlatformIP4Address));
 	priv->routes = g_array_new (FALSE, FALSE, sizeof (NMPlatformIP4Route));
+	priv->addresses_idx = nm_array_index_new (_addresses_idx_hash, _addresses_idx_equal);
+	priv->routes_idx = nm_array_index_new (_routes_idx_hash, _routes_idx_equal);
 	priv->nameservers = g_array_new (FALSE, FALSE, sizeof (guint32));
 	priv->domains = g_ptr_array_new_with_free_func (g_free);
 	priv->searches = g_ptr_array_new_with_free_func (g_free);
@@ -2219,6 +2466,8 @@ finalize (GObject *object)
 
 	g_array_unref (priv->addresses);
 	g_array_unref (priv->routes);
+	nm_array_index_free (priv->addresses_idx);
+	nm_array_index_free (priv->routes_idx);
 	g_array_unref (priv->nameservers);
 	g_ptr_array_unref (priv->domains);
 	g_ptr_array_unref (priv->searches);
@@ -2424,6 +2673,9 @@ nm_ip4_config_class_init (NMIP4ConfigClass *config_class)
 
 	exported_object_class->export_path = NM_DBUS_PATH "/IP4Config/%u";
 
+	/* route lists can be large and change often, throttle their notifications. */
+	exported_object_class->properties_changed_min_interval = 100;
+
 	object_class->get_property = get_property;
 	object_class->set_property = set_property;
 	object_class->finalize = finalize;
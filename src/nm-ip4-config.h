@@ -66,6 +66,7 @@ GType nm_ip4_config_get_type (void);
 
 
 NMIP4Config * nm_ip4_config_new (int ifindex);
+NMIP4Config * nm_ip4_config_new_cloned (const NMIP4Config *src);
 
 int nm_ip4_config_get_ifindex (const NMIP4Config *config);
 
@@ -105,8 +106,10 @@ gboolean nm_ip4_config_addresses_sort (NMIP4Config *config);
 void nm_ip4_config_reset_routes (NMIP4Config *config);
 void nm_ip4_config_add_route (NMIP4Config *config, const NMPlatformIP4Route *route);
 void nm_ip4_config_del_route (NMIP4Config *config, guint i);
+gboolean nm_ip4_config_remove_route (NMIP4Config *config, const NMPlatformIP4Route *route);
 guint32 nm_ip4_config_get_num_routes (const NMIP4Config *config);
 const NMPlatformIP4Route *nm_ip4_config_get_route (const NMIP4Config *config, guint32 i);
+const NMPlatformIP4Route *nm_ip4_config_lookup_route (const NMIP4Config *config, const NMPlatformIP4Route *route);
 
 const NMPlatformIP4Route *nm_ip4_config_get_direct_route_for_host (const NMIP4Config *config, guint32 host);
 
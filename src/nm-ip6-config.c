@@ -33,6 +33,7 @@
 #include "nm-route-manager.h"
 #include "nm-core-internal.h"
 #include "NetworkManagerUtils.h"
+#include "nm-array-index.h"
 
 #include "nmdbus-ip6-config.h"
 
@@ -45,6 +46,8 @@ typedef struct _NMIP6ConfigPrivate {
 	struct in6_addr gateway;
 	GArray *addresses;
 	GArray *routes;
+	NMArrayIndex *addresses_idx;
+	NMArrayIndex *routes_idx;
 	GArray *nameservers;
 	GPtrArray *domains;
 	GPtrArray *searches;
@@ -52,10 +55,14 @@ typedef struct _NMIP6ConfigPrivate {
 	guint32 mss;
 	int ifindex;
 	gint64 route_metric;
+
+	/* cached result of _fingerprint_get(), see nm_ip6_config_equal(). */
+	guint64 fingerprint;
+	bool fingerprint_valid:1;
 } NMIP6ConfigPrivate;
 
 
-NM_GOBJECT_PROPERTIES_DEFINE (NMIP6Config,
+NM_GOBJECT_PROPERTIES_DEFINE_BASE (
 	PROP_IFINDEX,
 	PROP_ADDRESS_DATA,
 	PROP_ADDRESSES,
@@ -68,6 +75,16 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMIP6Config,
 	PROP_DNS_OPTIONS,
 );
 
+static void
+_notify (NMIP6Config *self, _PropertyEnums prop)
+{
+	nm_assert ((gsize) prop < G_N_ELEMENTS (obj_properties));
+
+	/* all changes that affect nm_ip6_config_equal() are notified. */
+	NM_IP6_CONFIG_GET_PRIVATE (self)->fingerprint_valid = FALSE;
+	g_object_notify_by_pspec ((GObject *) self, obj_properties[prop]);
+}
+
 NMIP6Config *
 nm_ip6_config_new (int ifindex)
 {
@@ -196,6 +213,46 @@ routes_are_duplicate (const NMPlatformIP6Route *a, const NMPlatformIP6Route *b,
 	            && nm_utils_ip6_route_metric_normalize (a->metric) == nm_utils_ip6_route_metric_normalize (b->metric)));
 }
 
+/* hash and equality functions for the address and route indexes. They must
+ * agree with addresses_are_duplicate() and routes_are_duplicate(). */
+
+static guint
+_in6_addr_hash (const struct in6_addr *addr)
+{
+	guint h = 5381;
+	guint i;
+
+	for (i = 0; i < sizeof (addr->s6_addr); i++)
+		h = (h * 33) + addr->s6_addr[i];
+	return h;
+}
+
+static guint
+_addresses_idx_hash (gconstpointer elem)
+{
+	return _in6_addr_hash (&((const NMPlatformIP6Address *) elem)->address);
+}
+
+static gboolean
+_addresses_idx_equal (gconstpointer elem_a, gconstpointer elem_b)
+{
+	return addresses_are_duplicate (elem_a, elem_b);
+}
+
+static guint
+_routes_idx_hash (gconstpointer elem)
+{
+	const NMPlatformIP6Route *r = elem;
+
+	return (_in6_addr_hash (&r->network) * 33) + r->plen;
+}
+
+static gboolean
+_routes_idx_equal (gconstpointer elem_a, gconstpointer elem_b)
+{
+	return routes_are_duplicate (elem_a, elem_b, FALSE);
+}
+
 static gint
 _addresses_sort_cmp_get_prio (const struct in6_addr *addr)
 {
@@ -296,6 +353,7 @@ nm_ip6_config_addresses_sort (NMIP6Config *self, NMSettingIP6ConfigPrivacy use_t
 		g_free (data_pre);
 
 		if (changed) {
+			nm_array_index_invalidate (priv->addresses_idx);
 			_notify (self, PROP_ADDRESS_DATA);
 			_notify (self, PROP_ADDRESSES);
 			return TRUE;
@@ -365,6 +423,7 @@ nm_ip6_config_capture (NMNetns *netns, int ifindex, gboolean capture_resolv_conf
 			}
 		}
 	}
+	nm_array_index_invalidate (priv->routes_idx);
 
 	/* If the interface has the default route, and has IPv6 addresses, capture
 	 * nameservers from /etc/resolv.conf.
@@ -375,6 +434,7 @@ nm_ip6_config_capture (NMNetns *netns, int ifindex, gboolean capture_resolv_conf
 		                                                        NULL);
 
 	g_array_sort_with_data (priv->addresses, _addresses_sort_cmp, GINT_TO_POINTER (use_temporary));
+	nm_array_index_invalidate (priv->addresses_idx);
 
 	/* actually, nobody should be connected to the signal, just to be sure, notify */
 	if (notify_nameservers)
@@ -732,15 +792,8 @@ static int
 _addresses_get_index (const NMIP6Config *self, const NMPlatformIP6Address *addr)
 {
 	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->addresses->len; i++) {
-		const NMPlatformIP6Address *a = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
 
-		if (addresses_are_duplicate (a, addr))
-			return (int) i;
-	}
-	return -1;
+	return nm_array_index_lookup (priv->addresses_idx, priv->addresses, addr);
 }
 
 static int
@@ -762,15 +815,8 @@ static int
 _routes_get_index (const NMIP6Config *self, const NMPlatformIP6Route *route)
 {
 	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->routes->len; i++) {
-		const NMPlatformIP6Route *r = &g_array_index (priv->routes, NMPlatformIP6Route, i);
 
-		if (routes_are_duplicate (route, r, FALSE))
-			return (int) i;
-	}
-	return -1;
+	return nm_array_index_lookup (priv->routes_idx, priv->routes, route);
 }
 
 static int
@@ -830,6 +876,7 @@ _dns_options_get_index (const NMIP6Config *self, const char *option)
 void
 nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 {
+	NMIP6ConfigPrivate *dst_priv;
 	guint i;
 	gint idx;
 	const struct in6_addr *dst_tmp, *src_tmp;
@@ -837,13 +884,24 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
-	/* addresses */
-	for (i = 0; i < nm_ip6_config_get_num_addresses (src); i++) {
-		idx = _addresses_get_index (dst, nm_ip6_config_get_address (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_address (dst, idx);
+	/* addresses: flag the matches first and drop them in one pass, so
+	 * that the index of @dst stays valid during the lookups. */
+	if (nm_ip6_config_get_num_addresses (dst) && nm_ip6_config_get_num_addresses (src)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip6_config_get_num_addresses (dst));
+
+		for (i = 0; i < nm_ip6_config_get_num_addresses (src); i++) {
+			idx = _addresses_get_index (dst, nm_ip6_config_get_address (src, i));
+			if (idx >= 0)
+				flags[idx] = TRUE;
+		}
+		if (nm_array_index_remove_flagged (dst_priv->addresses_idx, dst_priv->addresses, flags)) {
+			_notify (dst, PROP_ADDRESS_DATA);
+			_notify (dst, PROP_ADDRESSES);
+		}
 	}
 
 	/* nameservers */
@@ -865,10 +923,18 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 	/* ignore route_metric */
 
 	/* routes */
-	for (i = 0; i < nm_ip6_config_get_num_routes (src); i++) {
-		idx = _routes_get_index (dst, nm_ip6_config_get_route (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_route (dst, idx);
+	if (nm_ip6_config_get_num_routes (dst) && nm_ip6_config_get_num_routes (src)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip6_config_get_num_routes (dst));
+
+		for (i = 0; i < nm_ip6_config_get_num_routes (src); i++) {
+			idx = _routes_get_index (dst, nm_ip6_config_get_route (src, i));
+			if (idx >= 0)
+				flags[idx] = TRUE;
+		}
+		if (nm_array_index_remove_flagged (dst_priv->routes_idx, dst_priv->routes, flags)) {
+			_notify (dst, PROP_ROUTE_DATA);
+			_notify (dst, PROP_ROUTES);
+		}
 	}
 
 	/* domains */
@@ -901,22 +967,27 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 void
 nm_ip6_config_intersect (NMIP6Config *dst, const NMIP6Config *src)
 {
+	NMIP6ConfigPrivate *dst_priv;
 	guint i;
-	gint idx;
 	const struct in6_addr *dst_tmp, *src_tmp;
 
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip6_config_get_num_addresses (dst); ) {
-		idx = _addresses_get_index (src, nm_ip6_config_get_address (dst, i));
-		if (idx < 0)
-			nm_ip6_config_del_address (dst, i);
-		else
-			i++;
+	if (nm_ip6_config_get_num_addresses (dst)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip6_config_get_num_addresses (dst));
+
+		for (i = 0; i < nm_ip6_config_get_num_addresses (dst); i++)
+			flags[i] = _addresses_get_index (src, nm_ip6_config_get_address (dst, i)) < 0;
+		if (nm_array_index_remove_flagged (dst_priv->addresses_idx, dst_priv->addresses, flags)) {
+			_notify (dst, PROP_ADDRESS_DATA);
+			_notify (dst, PROP_ADDRESSES);
+		}
 	}
 
 	/* ignore route_metric */
@@ -933,12 +1004,15 @@ nm_ip6_config_intersect (NMIP6Config *dst, const NMIP6Config *src)
 	}
 
 	/* routes */
-	for (i = 0; i < nm_ip6_config_get_num_routes (dst); ) {
-		idx = _routes_get_index (src, nm_ip6_config_get_route (dst, i));
-		if (idx < 0)
-			nm_ip6_config_del_route (dst, i);
-		else
-			i++;
+	if (nm_ip6_config_get_num_routes (dst)) {
+		gs_free guint8 *flags = g_new0 (guint8, nm_ip6_config_get_num_routes (dst));
+
+		for (i = 0; i < nm_ip6_config_get_num_routes (dst); i++)
+			flags[i] = _routes_get_index (src, nm_ip6_config_get_route (dst, i)) < 0;
+		if (nm_array_index_remove_flagged (dst_priv->routes_idx, dst_priv->routes, flags)) {
+			_notify (dst, PROP_ROUTE_DATA);
+			_notify (dst, PROP_ROUTES);
+		}
 	}
 
 	/* ignore domains */
@@ -1265,6 +1339,7 @@ nm_ip6_config_reset_addresses (NMIP6Config *config)
 
 	if (priv->addresses->len != 0) {
 		g_array_set_size (priv->addresses, 0);
+		nm_array_index_invalidate (priv->addresses_idx);
 		_notify (config, PROP_ADDRESS_DATA);
 		_notify (config, PROP_ADDRESSES);
 	}
@@ -1289,39 +1364,39 @@ nm_ip6_config_add_address (NMIP6Config *config, const NMPlatformIP6Address *new)
 
 	g_return_if_fail (new != NULL);
 
-	for (i = 0; i < priv->addresses->len; i++ ) {
+	i = _addresses_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP6Address *item = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
 
-		if (addresses_are_duplicate (item, new)) {
-			if (nm_platform_ip6_address_cmp (item, new) == 0)
-				return;
-
-			/* remember the old values. */
-			item_old = *item;
-			/* Copy over old item to get new lifetime, timestamp, preferred */
-			*item = *new;
-
-			/* But restore highest priority source */
-			item->source = MAX (item_old.source, new->source);
-
-			/* for addresses that we read from the kernel, we keep the timestamps as defined
-			 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
-			 * with "what should be" and the kernel values are "what turned out after configuring it".
-			 *
-			 * For other sources, the longer lifetime wins. */
-			if (   (new->source == NM_IP_CONFIG_SOURCE_KERNEL && new->source != item_old.source)
-			    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
-				item->timestamp = item_old.timestamp;
-				item->lifetime = item_old.lifetime;
-				item->preferred = item_old.preferred;
-			}
-			if (nm_platform_ip6_address_cmp (&item_old, item) == 0)
-				return;
-			goto NOTIFY;
+		if (nm_platform_ip6_address_cmp (item, new) == 0)
+			return;
+
+		/* remember the old values. */
+		item_old = *item;
+		/* Copy over old item to get new lifetime, timestamp, preferred */
+		*item = *new;
+
+		/* But restore highest priority source */
+		item->source = MAX (item_old.source, new->source);
+
+		/* for addresses that we read from the kernel, we keep the timestamps as defined
+		 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
+		 * with "what should be" and the kernel values are "what turned out after configuring it".
+		 *
+		 * For other sources, the longer lifetime wins. */
+		if (   (new->source == NM_IP_CONFIG_SOURCE_KERNEL && new->source != item_old.source)
+		    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
+			item->timestamp = item_old.timestamp;
+			item->lifetime = item_old.lifetime;
+			item->preferred = item_old.preferred;
 		}
+		if (nm_platform_ip6_address_cmp (&item_old, item) == 0)
+			return;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->addresses, *new);
+	nm_array_index_append (priv->addresses_idx, priv->addresses);
 NOTIFY:
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
@@ -1335,6 +1410,7 @@ nm_ip6_config_del_address (NMIP6Config *config, guint i)
 	g_return_if_fail (i < priv->addresses->len);
 
 	g_array_remove_index (priv->addresses, i);
+	nm_array_index_invalidate (priv->addresses_idx);
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
 }
@@ -1394,6 +1470,7 @@ nm_ip6_config_reset_routes (NMIP6Config *config)
 
 	if (priv->routes->len != 0) {
 		g_array_set_size (priv->routes, 0);
+		nm_array_index_invalidate (priv->routes_idx);
 		_notify (config, PROP_ROUTE_DATA);
 		_notify (config, PROP_ROUTES);
 	}
@@ -1420,23 +1497,23 @@ nm_ip6_config_add_route (NMIP6Config *config, const NMPlatformIP6Route *new)
 	g_return_if_fail (new->plen > 0);
 	g_assert (priv->ifindex);
 
-	for (i = 0; i < priv->routes->len; i++ ) {
+	i = _routes_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP6Route *item = &g_array_index (priv->routes, NMPlatformIP6Route, i);
 
-		if (routes_are_duplicate (item, new, FALSE)) {
-			if (nm_platform_ip6_route_cmp (item, new) == 0)
-				return;
-			old_source = item->source;
-			*item = *new;
-			/* Restore highest priority source */
-			item->source = MAX (old_source, new->source);
-			item->ifindex = priv->ifindex;
-			goto NOTIFY;
-		}
+		if (nm_platform_ip6_route_cmp (item, new) == 0)
+			return;
+		old_source = item->source;
+		*item = *new;
+		/* Restore highest priority source */
+		item->source = MAX (old_source, new->source);
+		item->ifindex = priv->ifindex;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->routes, *new);
 	g_array_index (priv->routes, NMPlatformIP6Route, priv->routes->len - 1).ifindex = priv->ifindex;
+	nm_array_index_append (priv->routes_idx, priv->routes);
 NOTIFY:
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
@@ -1450,10 +1527,34 @@ nm_ip6_config_del_route (NMIP6Config *config, guint i)
 	g_return_if_fail (i < priv->routes->len);
 
 	g_array_remove_index (priv->routes, i);
+	nm_array_index_invalidate (priv->routes_idx);
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
 }
 
+/**
+ * nm_ip6_config_remove_route:
+ * @config: the #NMIP6Config
+ * @route: the route to remove
+ *
+ * Removes the route that has the same destination as @route.
+ *
+ * Returns: whether a route was removed.
+ */
+gboolean
+nm_ip6_config_remove_route (NMIP6Config *config, const NMPlatformIP6Route *route)
+{
+	int i;
+
+	g_return_val_if_fail (route != NULL, FALSE);
+
+	i = _routes_get_index (config, route);
+	if (i < 0)
+		return FALSE;
+	nm_ip6_config_del_route (config, i);
+	return TRUE;
+}
+
 guint
 nm_ip6_config_get_num_routes (const NMIP6Config *config)
 {
@@ -1470,6 +1571,27 @@ nm_ip6_config_get_route (const NMIP6Config *config, guint i)
 	return &g_array_index (priv->routes, NMPlatformIP6Route, i);
 }
 
+/**
+ * nm_ip6_config_lookup_route:
+ * @config: the #NMIP6Config
+ * @route: the route to search for
+ *
+ * Returns: the route in @config that has the same destination as @route,
+ *   or %NULL if there is none. Routes are identified by network and
+ *   prefix length only, so the returned route might differ from @route
+ *   in its other fields.
+ */
+const NMPlatformIP6Route *
+nm_ip6_config_lookup_route (const NMIP6Config *config, const NMPlatformIP6Route *route)
+{
+	int i;
+
+	g_return_val_if_fail (route != NULL, NULL);
+
+	i = _routes_get_index (config, route);
+	return i >= 0 ? nm_ip6_config_get_route (config, i) : NULL;
+}
+
 const NMPlatformIP6Route *
 nm_ip6_config_get_direct_route_for_host (const NMIP6Config *config, const struct in6_addr *host)
 {
@@ -1858,6 +1980,118 @@ nm_ip6_config_hash (const NMIP6Config *config, GChecksum *sum, gboolean dns_only
 
 }
 
+/* The fingerprint covers the same fields as nm_ip6_config_hash() with
+ * @dns_only=FALSE, in the same order, and exactly the fields compared
+ * by _equal_full(). */
+static guint64
+_fingerprint_get (const NMIP6Config *self)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	guint64 h = NM_HASH64_INIT;
+	guint i;
+
+	if (priv->fingerprint_valid)
+		return priv->fingerprint;
+
+	h = nm_hash64_update (h, &priv->gateway, sizeof (priv->gateway));
+
+	h = nm_hash64_update_u32 (h, priv->addresses->len);
+	for (i = 0; i < priv->addresses->len; i++) {
+		const NMPlatformIP6Address *address = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
+
+		h = nm_hash64_update (h, &address->address, sizeof (address->address));
+		h = nm_hash64_update_u32 (h, address->plen);
+	}
+
+	h = nm_hash64_update_u32 (h, priv->routes->len);
+	for (i = 0; i < priv->routes->len; i++) {
+		const NMPlatformIP6Route *route = &g_array_index (priv->routes, NMPlatformIP6Route, i);
+
+		h = nm_hash64_update (h, &route->network, sizeof (route->network));
+		h = nm_hash64_update_u32 (h, route->plen);
+		h = nm_hash64_update (h, &route->gateway, sizeof (route->gateway));
+		h = nm_hash64_update_u32 (h, route->metric);
+	}
+
+	/* prefix each list with its length, so that e.g. a domain is
+	 * not mistaken for a search. */
+	h = nm_hash64_update_u32 (h, priv->nameservers->len);
+	h = nm_hash64_update (h, priv->nameservers->data, priv->nameservers->len * sizeof (struct in6_addr));
+
+	h = nm_hash64_update_u32 (h, priv->domains->len);
+	for (i = 0; i < priv->domains->len; i++)
+		h = nm_hash64_update_str (h, priv->domains->pdata[i]);
+	h = nm_hash64_update_u32 (h, priv->searches->len);
+	for (i = 0; i < priv->searches->len; i++)
+		h = nm_hash64_update_str (h, priv->searches->pdata[i]);
+	h = nm_hash64_update_u32 (h, priv->dns_options->len);
+	for (i = 0; i < priv->dns_options->len; i++)
+		h = nm_hash64_update_str (h, priv->dns_options->pdata[i]);
+
+	priv->fingerprint = h;
+	priv->fingerprint_valid = TRUE;
+	return h;
+}
+
+static gboolean
+_equal_strv (const GPtrArray *a, const GPtrArray *b)
+{
+	guint i;
+
+	if (a->len != b->len)
+		return FALSE;
+	for (i = 0; i < a->len; i++) {
+		if (strcmp (a->pdata[i], b->pdata[i]) != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+_equal_full (const NMIP6Config *a, const NMIP6Config *b)
+{
+	NMIP6ConfigPrivate *a_priv = NM_IP6_CONFIG_GET_PRIVATE (a);
+	NMIP6ConfigPrivate *b_priv = NM_IP6_CONFIG_GET_PRIVATE (b);
+	guint i;
+
+	if (!IN6_ARE_ADDR_EQUAL (&a_priv->gateway, &b_priv->gateway))
+		return FALSE;
+
+	if (a_priv->addresses->len != b_priv->addresses->len)
+		return FALSE;
+	for (i = 0; i < a_priv->addresses->len; i++) {
+		const NMPlatformIP6Address *a_addr = &g_array_index (a_priv->addresses, NMPlatformIP6Address, i);
+		const NMPlatformIP6Address *b_addr = &g_array_index (b_priv->addresses, NMPlatformIP6Address, i);
+
+		if (   !IN6_ARE_ADDR_EQUAL (&a_addr->address, &b_addr->address)
+		    || a_addr->plen != b_addr->plen)
+			return FALSE;
+	}
+
+	/* unlike routes_are_duplicate(), don't normalize the metric. */
+	if (a_priv->routes->len != b_priv->routes->len)
+		return FALSE;
+	for (i = 0; i < a_priv->routes->len; i++) {
+		const NMPlatformIP6Route *a_route = &g_array_index (a_priv->routes, NMPlatformIP6Route, i);
+		const NMPlatformIP6Route *b_route = &g_array_index (b_priv->routes, NMPlatformIP6Route, i);
+
+		if (   !IN6_ARE_ADDR_EQUAL (&a_route->network, &b_route->network)
+		    || a_route->plen != b_route->plen
+		    || !IN6_ARE_ADDR_EQUAL (&a_route->gateway, &b_route->gateway)
+		    || a_route->metric != b_route->metric)
+			return FALSE;
+	}
+
+	if (   a_priv->nameservers->len != b_priv->nameservers->len
+	    || memcmp (a_priv->nameservers->data, b_priv->nameservers->data,
+	               a_priv->nameservers->len * sizeof (struct in6_addr)) != 0)
+		return FALSE;
+
+	return    _equal_strv (a_priv->domains, b_priv->domains)
+	       && _equal_strv (a_priv->searches, b_priv->searches)
+	       && _equal_strv (a_priv->dns_options, b_priv->dns_options);
+}
+
 /**
  * nm_ip6_config_equal:
  * @a: first config to compare
@@ -1874,28 +2108,18 @@ nm_ip6_config_hash (const NMIP6Config *config, GChecksum *sum, gboolean dns_only
 gboolean
 nm_ip6_config_equal (const NMIP6Config *a, const NMIP6Config *b)
 {
-	GChecksum *a_checksum = g_checksum_new (G_CHECKSUM_SHA1);
-	GChecksum *b_checksum = g_checksum_new (G_CHECKSUM_SHA1);
-	gsize a_len = g_checksum_type_get_length (G_CHECKSUM_SHA1);
-	gsize b_len = g_checksum_type_get_length (G_CHECKSUM_SHA1);
-	guchar a_data[a_len], b_data[b_len];
-	gboolean equal;
-
-	if (a)
-		nm_ip6_config_hash (a, a_checksum, FALSE);
-	if (b)
-		nm_ip6_config_hash (b, b_checksum, FALSE);
-
-	g_checksum_get_digest (a_checksum, a_data, &a_len);
-	g_checksum_get_digest (b_checksum, b_data, &b_len);
-
-	g_assert (a_len == b_len);
-	equal = !memcmp (a_data, b_data, a_len);
+	if (a == b)
+		return TRUE;
+	if (!a || !b)
+		return FALSE;
 
-	g_checksum_free (a_checksum);
-	g_checksum_free (b_checksum);
+	/* the fingerprints are cached and cover every compared field, so
+	 * a mismatch rejects cheaply. A match can be a collision, so it is
+	 * confirmed by the full comparison. */
+	if (_fingerprint_get (a) != _fingerprint_get (b))
+		return FALSE;
 
-	return equal;
+	return _equal_full (a, b);
 }
 
 /******************************************************************/
@@ -1910,6 +2134,8 @@ nm_ip6_config_init (NMIP6Config *config)
 
 	priv->addresses = g_array_new (FALSE, TRUE, sizeof (NMPlatformIP6Address));
 	priv->routes = g_array_new (FALSE, TRUE, sizeof (NMPlatformIP6Route));
+	priv->addresses_idx = nm_array_index_new (_addresses_idx_hash, _addresses_idx_equal);
+	priv->routes_idx = nm_array_index_new (_routes_idx_hash, _routes_idx_equal);
 	priv->nameservers = g_array_new (FALSE, TRUE, sizeof (struct in6_addr));
 	priv->domains = g_ptr_array_new_with_free_func (g_free);
 	priv->searches = g_ptr_array_new_with_free_func (g_free);
@@ -1925,6 +2151,8 @@ finalize (GObject *object)
 
 	g_array_unref (priv->addresses);
 	g_array_unref (priv->routes);
+	nm_array_index_free (priv->addresses_idx);
+	nm_array_index_free (priv->routes_idx);
 	g_array_unref (priv->nameservers);
 	g_ptr_array_unref (priv->domains);
 	g_ptr_array_unref (priv->searches);
@@ -2130,6 +2358,9 @@ nm_ip6_config_class_init (NMIP6ConfigClass *config_class)
 
 	exported_object_class->export_path = NM_DBUS_PATH "/IP6Config/%u";
 
+	/* route lists can be large and change often, throttle their notifications. */
+	exported_object_class->properties_changed_min_interval = 100;
+
 	/* virtual methods */
 	object_class->get_property = get_property;
 	object_class->set_property = set_property;
@@ -105,8 +105,10 @@ gboolean nm_ip6_config_addresses_sort (NMIP6Config *config, NMSettingIP6ConfigPr
 void nm_ip6_config_reset_routes (NMIP6Config *config);
 void nm_ip6_config_add_route (NMIP6Config *config, const NMPlatformIP6Route *route);
 void nm_ip6_config_del_route (NMIP6Config *config, guint i);
+gboolean nm_ip6_config_remove_route (NMIP6Config *config, const NMPlatformIP6Route *route);
 guint32 nm_ip6_config_get_num_routes (const NMIP6Config *config);
 const NMPlatformIP6Route *nm_ip6_config_get_route (const NMIP6Config *config, guint32 i);
+const NMPlatformIP6Route *nm_ip6_config_lookup_route (const NMIP6Config *config, const NMPlatformIP6Route *route);
 
 const NMPlatformIP6Route *nm_ip6_config_get_direct_route_for_host (const NMIP6Config *config, const struct in6_addr *host);
 const NMPlatformIP6Address *nm_ip6_config_get_subnet_for_host (const NMIP6Config *config, const struct in6_addr *host);
@@ -33,6 +33,7 @@
 #include "nm-device.h"
 #include "nm-device-generic.h"
 #include "nm-platform.h"
+#include "nmp-object.h"
 #include "nm-netns.h"
 #include "nm-netns-controller.h"
 #include "nm-rfkill-manager.h"
@@ -4333,6 +4334,15 @@ impl_manager_get_logging (NMManager *manager,
 	                                                      nm_logging_domains_to_string ()));
 }
 
+static void
+impl_manager_get_memory_stats (NMManager *manager,
+                               GDBusMethodInvocation *context)
+{
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(@a{sa{st}})",
+	                                                      nmp_object_get_memory_stats ()));
+}
+
 static void
 connectivity_check_done (GObject *object,
                          GAsyncResult *result,
@@ -5831,6 +5841,7 @@ nm_manager_class_init (NMManagerClass *manager_class)
 	                                        "GetPermissions", impl_manager_get_permissions,
 	                                        "SetLogging", impl_manager_set_logging,
 	                                        "GetLogging", impl_manager_get_logging,
+	                                        "GetMemoryStats", impl_manager_get_memory_stats,
 	                                        "CheckConnectivity", impl_manager_check_connectivity,
 	                                        "state", impl_manager_get_state,
 	                                        NULL);
@@ -32,14 +32,21 @@ struct NMMultiIndex {
 
 typedef struct {
 	/* when storing the first item for a multi-index id, we don't yet create
-	 * the hashtable @index. Instead we store it inplace to @value0. Note that
-	 * &values_data->value0 is a NULL terminated array with one item that is
-	 * suitable to be returned directly from nm_multi_index_lookup(). */
+	 * the array and the hashtable @index. Instead we store it inplace to @value0.
+	 * Note that &values_data->value0 is a NULL terminated array with one item
+	 * that is suitable to be returned directly from nm_multi_index_lookup().
+	 *
+	 * Otherwise, @values is a dense, NULL terminated array of @len values
+	 * and @index maps each value to its position in @values (plus one).
+	 * Values are appended at the end. On removal, the last value takes the
+	 * place of the removed one, so the array never needs to be rebuilt. */
 	union {
 		gpointer value0;
 		gpointer *values;
 	};
 	GHashTable *index;
+	guint len;
+	guint alloc;
 } ValuesData;
 
 /******************************************************************************************/
@@ -67,10 +74,6 @@ _values_data_get_data (ValuesData *values_data,
                        void *const**out_data,
                        guint *out_len)
 {
-	guint i, len;
-	gpointer *values;
-	GHashTableIter iter;
-
 	nm_assert (values_data);
 
 	if (!values_data->index) {
@@ -79,24 +82,87 @@ _values_data_get_data (ValuesData *values_data,
 		return;
 	}
 
-	nm_assert (values_data->index && g_hash_table_size (values_data->index) > 0);
+	nm_assert (values_data->len > 0);
+	nm_assert (values_data->len == g_hash_table_size (values_data->index));
+	nm_assert (!values_data->values[values_data->len]);
+
+	NM_SET_OUT (out_data, values_data->values);
+	NM_SET_OUT (out_len, values_data->len);
+}
+
+static gboolean
+_values_data_add (ValuesData *values_data, gconstpointer value)
+{
+	if (!values_data->index) {
+		gpointer value0 = values_data->value0;
 
-	if (!values_data->values) {
-		len = g_hash_table_size (values_data->index);
-		values = g_new (gpointer, len + 1);
+		if (value0 == value)
+			return FALSE;
 
-		g_hash_table_iter_init (&iter, values_data->index);
-		for (i = 0; g_hash_table_iter_next (&iter, &values[i], NULL); i++)
-			nm_assert (i < len);
-		nm_assert (i == len);
-		values[i] = NULL;
+		values_data->alloc = 4;
+		values_data->values = g_new (gpointer, values_data->alloc);
+		values_data->values[0] = value0;
+		values_data->len = 1;
+		values_data->index = g_hash_table_new (NULL, NULL);
+		g_hash_table_insert (values_data->index, value0, GUINT_TO_POINTER (1));
+	} else if (g_hash_table_contains (values_data->index, value))
+		return FALSE;
 
-		values_data->values = values;
-		NM_SET_OUT (out_len, len);
-	} else if (out_len)
-		NM_SET_OUT (out_len, g_hash_table_size (values_data->index));
+	if (values_data->len + 1 >= values_data->alloc) {
+		values_data->alloc *= 2;
+		values_data->values = g_renew (gpointer, values_data->values, values_data->alloc);
+	}
 
-	NM_SET_OUT (out_data, values_data->values);
+	values_data->values[values_data->len] = (gpointer) value;
+	values_data->len++;
+	values_data->values[values_data->len] = NULL;
+	g_hash_table_insert (values_data->index, (gpointer) value, GUINT_TO_POINTER (values_data->len));
+	return TRUE;
+}
+
+/* Returns FALSE if @value was not found. Otherwise, set @out_empty to
+ * indicate whether the last value was removed and @values_data must
+ * be destroyed by the caller. */
+static gboolean
+_values_data_remove (ValuesData *values_data, gconstpointer value, gboolean *out_empty)
+{
+	guint pos, last;
+
+	if (!values_data->index) {
+		if (values_data->value0 != value)
+			return FALSE;
+		*out_empty = TRUE;
+		return TRUE;
+	}
+
+	pos = GPOINTER_TO_UINT (g_hash_table_lookup (values_data->index, value));
+	if (!pos)
+		return FALSE;
+
+	if (values_data->len == 1) {
+		*out_empty = TRUE;
+		return TRUE;
+	}
+
+	pos--;
+	last = values_data->len - 1;
+	g_hash_table_remove (values_data->index, value);
+	if (pos != last) {
+		values_data->values[pos] = values_data->values[last];
+		g_hash_table_insert (values_data->index, values_data->values[pos], GUINT_TO_POINTER (pos + 1));
+	}
+	values_data->len = last;
+	values_data->values[last] = NULL;
+
+	/* give memory back after a large group shrank. */
+	if (   values_data->alloc > 16
+	    && values_data->len < values_data->alloc / 4) {
+		values_data->alloc /= 2;
+		values_data->values = g_renew (gpointer, values_data->values, values_data->alloc);
+	}
+
+	*out_empty = FALSE;
+	return TRUE;
 }
 
 /******************************************************************************************/
@@ -109,7 +175,8 @@ _values_data_get_data (ValuesData *values_data,
  *   that are returned.
  *
  * Returns: (transfer none): %NULL if there are no values
- *   or a %NULL terminated array of pointers.
+ *   or a %NULL terminated array of pointers. The array is not
+ *   a copy and is only valid until the next modification of @id.
  */
 void *const*
 nm_multi_index_lookup (const NMMultiIndex *index,
@@ -251,15 +318,12 @@ nm_multi_index_id_iter_init (NMMultiIndexIdIter *iter,
 	g_return_if_fail (id);
 
 	values_data = g_hash_table_lookup (index->hash, id);
-	if (!values_data)
-		iter->_state = 2;
-	else if (values_data->index) {
-		iter->_state = 1;
-		g_hash_table_iter_init (&iter->_iter, values_data->index);
-	} else {
-		iter->_state = 0;
-		iter->_value = values_data->value0;
-	}
+	if (!values_data) {
+		iter->_values = NULL;
+		iter->_len = 0;
+	} else
+		_values_data_get_data (values_data, &iter->_values, &iter->_len);
+	iter->_pos = 0;
 }
 
 gboolean
@@ -268,19 +332,11 @@ nm_multi_index_id_iter_next (NMMultiIndexIdIter *iter,
 {
 	g_return_val_if_fail (iter, FALSE);
 
-	switch (iter->_state) {
-	case 0:
-		iter->_state = 2;
-		NM_SET_OUT (out_value, iter->_value);
-		return TRUE;
-	case 1:
-		return g_hash_table_iter_next (&iter->_iter, out_value, NULL);
-	case 2:
-		iter->_state = 3;
+	if (iter->_pos >= iter->_len)
 		return FALSE;
-	default:
-		g_return_val_if_reached (FALSE);
-	}
+
+	NM_SET_OUT (out_value, iter->_values[iter->_pos++]);
+	return TRUE;
 }
 
 /******************************************************************************************/
@@ -313,21 +369,9 @@ _do_add (NMMultiIndex *index,
 		values_data->value0 = (gpointer) value;
 
 		g_hash_table_insert (index->hash, id_new, values_data);
-	} else {
-		if (!values_data->index) {
-			if (values_data->value0 == value)
-				return FALSE;
-			values_data->index = g_hash_table_new (NULL, NULL);
-			g_hash_table_replace (values_data->index, (gpointer) value, (gpointer) value);
-			g_hash_table_replace (values_data->index, values_data->value0, values_data->value0);
-			values_data->values = NULL;
-		} else {
-			if (!nm_g_hash_table_replace (values_data->index, (gpointer) value, (gpointer) value))
-				return FALSE;
-			g_clear_pointer (&values_data->values, g_free);
-		}
+		return TRUE;
 	}
-	return TRUE;
+	return _values_data_add (values_data, value);
 }
 
 static gboolean
@@ -336,24 +380,16 @@ _do_remove (NMMultiIndex *index,
             gconstpointer value)
 {
 	ValuesData *values_data;
+	gboolean empty;
 
 	values_data = g_hash_table_lookup (index->hash, id);
 	if (!values_data)
 		return FALSE;
 
-	if (values_data->index) {
-		if (!g_hash_table_remove (values_data->index, value))
-			return FALSE;
-		if (g_hash_table_size (values_data->index) == 0)
-			g_hash_table_remove (index->hash, id);
-		else
-			g_clear_pointer (&values_data->values, g_free);
-	} else {
-		if (values_data->value0 != value)
-			return FALSE;
+	if (!_values_data_remove (values_data, value, &empty))
+		return FALSE;
+	if (empty)
 		g_hash_table_remove (index->hash, id);
-	}
-
 	return TRUE;
 }
 
@@ -39,11 +39,9 @@ typedef struct {
 } NMMultiIndexIter;
 
 typedef struct {
-	union {
-		GHashTableIter _iter;
-		gpointer _value;
-	};
-	guint _state;
+	void *const*_values;
+	guint _len;
+	guint _pos;
 } NMMultiIndexIdIter;
 
 typedef gboolean (*NMMultiIndexFuncEqual) (const NMMultiIndexId *id_a, const NMMultiIndexId *id_b);
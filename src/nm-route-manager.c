@@ -60,14 +60,43 @@ typedef struct {
 	NMPObject *obj;
 } IP4DeviceRoutePurgeEntry;
 
+typedef struct {
+	NMPlatformIfindexWatch *watch;
+
+	/* the non-default routes in platform on the interface, sorted by route_id_cmp()
+	 * and kept up to date from the platform events. Indexed by _VTABLE_IDX(),
+	 * %NULL until the first sync of the address family. */
+	GPtrArray *routes[2];
+} PlatRoutes;
+
+typedef struct {
+	int ifindex;
+	NMPObjectType obj_type;
+	NMPlatformSignalChangeType change_type;
+	NMPObject *obj;
+} PlatRoutesEvent;
+
 typedef struct {
 	NMPlatform *platform;
 
 	RouteEntries ip4_routes;
 	RouteEntries ip6_routes;
+
+	/* ifindex -> PlatRoutes, for each interface that was synced. */
+	GHashTable *plat_routes;
+
+	/* while syncing, the platform routes are iterated as they were at the beginning
+	 * of the sync. Events that arrive in the meantime are queued and applied
+	 * afterwards. */
+	GArray *plat_routes_events;
+	guint plat_routes_syncing;
 	struct {
 		GHashTable *entries;
 		guint gc_id;
+
+		/* ifindex -> NMPlatformIfindexWatch, for each interface that has
+		 * an entry. Only dropped once all entries are gone. */
+		GHashTable *watches;
 	} ip4_device_routes;
 } NMRouteManagerPrivate;
 
@@ -96,6 +125,8 @@ typedef struct {
 
 static const VTableIP vtable_v4, vtable_v6;
 
+#define _VTABLE_IDX(vtable) ((vtable)->vt->is_ip4 ? 0 : 1)
+
 #define VTABLE_ROUTE_INDEX(vtable, garray, idx) ((NMPlatformIPXRoute *) &((garray)->data[(idx) * (vtable)->vt->sizeof_route]))
 
 #define VTABLE_IS_DEVICE_ROUTE(vtable, route) ((vtable)->vt->is_ip4 \
@@ -407,17 +438,31 @@ _get_next_known_route (const VTableIP *vtable, const RouteIndex *index, gboolean
 }
 
 static const NMPlatformIPXRoute *
-_get_next_plat_route (const RouteIndex *index, gboolean start_at_zero, guint *cur_idx)
+_get_next_plat_route (const GPtrArray *plat_routes, gboolean ignore_kernel_routes, gboolean start_at_zero, guint *cur_idx)
 {
-	if (start_at_zero)
+	guint i;
+
+	if (!plat_routes) {
 		*cur_idx = 0;
+		return NULL;
+	}
+
+	if (start_at_zero)
+		i = 0;
 	else
-		++*cur_idx;
+		i = *cur_idx + 1;
 
-	/* get next route from the platform index. */
-	if (*cur_idx < index->len)
-		return index->entries[*cur_idx];
-	*cur_idx = index->len;
+	/* get next route from the platform routes. */
+	for (; i < plat_routes->len; i++) {
+		const NMPObject *obj = plat_routes->pdata[i];
+
+		if (   ignore_kernel_routes
+		    && obj->ipx_route.rx.source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL)
+			continue;
+		*cur_idx = i;
+		return &obj->ipx_route;
+	}
+	*cur_idx = plat_routes->len;
 	return NULL;
 }
 
@@ -430,13 +475,220 @@ _sort_indexes_cmp (guint *a, guint *b)
 
 /*********************************************************************************************/
 
+static int
+_plat_routes_cmp (const NMPObject *obj, const NMPObject *needle, const VTableIP *vtable)
+{
+	return vtable->route_id_cmp (&obj->ipx_route, &needle->ipx_route);
+}
+
+static int
+_plat_routes_cmp_indirect (const NMPObject **a, const NMPObject **b, const VTableIP *vtable)
+{
+	return vtable->route_id_cmp (&(*a)->ipx_route, &(*b)->ipx_route);
+}
+
+static void
+_plat_routes_update (const VTableIP *vtable, GPtrArray *routes, NMPlatformSignalChangeType change_type, NMPObject *obj)
+{
+	gssize idx;
+
+	idx = _nm_utils_ptrarray_find_binary_search (routes->pdata, routes->len, obj, (GCompareDataFunc) _plat_routes_cmp, (gpointer) vtable);
+
+	if (change_type == NM_PLATFORM_SIGNAL_REMOVED) {
+		if (idx >= 0)
+			g_ptr_array_remove_index (routes, idx);
+		return;
+	}
+
+	if (idx >= 0) {
+		nmp_object_unref (routes->pdata[idx]);
+		routes->pdata[idx] = nmp_object_ref (obj);
+		return;
+	}
+
+	idx = ~idx;
+	g_ptr_array_add (routes, NULL);
+	memmove (&routes->pdata[idx + 1], &routes->pdata[idx], sizeof (gpointer) * (routes->len - 1 - idx));
+	routes->pdata[idx] = nmp_object_ref (obj);
+}
+
+static void
+_plat_routes_free (PlatRoutes *plat_routes)
+{
+	if (plat_routes->routes[0])
+		g_ptr_array_unref (plat_routes->routes[0]);
+	if (plat_routes->routes[1])
+		g_ptr_array_unref (plat_routes->routes[1]);
+	g_slice_free (PlatRoutes, plat_routes);
+}
+
+static void
+_plat_routes_handle_event (NMRouteManager *self, int ifindex, NMPObjectType obj_type, NMPlatformSignalChangeType change_type, NMPObject *obj)
+{
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
+	PlatRoutes *plat_routes;
+	const VTableIP *vtable;
+
+	plat_routes = g_hash_table_lookup (priv->plat_routes, GINT_TO_POINTER (ifindex));
+	if (!plat_routes)
+		return;
+
+	if (obj_type == NMP_OBJECT_TYPE_LINK) {
+		/* the ifindex might be reused by another interface later. */
+		nm_platform_ifindex_watch_remove (priv->platform, plat_routes->watch);
+		g_hash_table_remove (priv->plat_routes, GINT_TO_POINTER (ifindex));
+		return;
+	}
+
+	vtable = obj_type == NMP_OBJECT_TYPE_IP4_ROUTE ? &vtable_v4 : &vtable_v6;
+	if (plat_routes->routes[_VTABLE_IDX (vtable)])
+		_plat_routes_update (vtable, plat_routes->routes[_VTABLE_IDX (vtable)], change_type, obj);
+}
+
+static void
+_plat_routes_platform_changed (NMPlatform *platform,
+                               NMPObjectType obj_type,
+                               int ifindex,
+                               gconstpointer platform_object,
+                               NMPlatformSignalChangeType change_type,
+                               gpointer user_data)
+{
+	NMRouteManager *self = user_data;
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
+	NMPObject *obj = NULL;
+
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_LINK:
+		if (change_type != NM_PLATFORM_SIGNAL_REMOVED)
+			return;
+		break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (platform_object))
+			return;
+		obj = nmp_object_new (obj_type, platform_object);
+		break;
+	default:
+		return;
+	}
+
+	if (priv->plat_routes_syncing) {
+		PlatRoutesEvent *event;
+
+		g_array_set_size (priv->plat_routes_events, priv->plat_routes_events->len + 1);
+		event = &g_array_index (priv->plat_routes_events, PlatRoutesEvent, priv->plat_routes_events->len - 1);
+		event->ifindex = ifindex;
+		event->obj_type = obj_type;
+		event->change_type = change_type;
+		event->obj = obj;
+		return;
+	}
+
+	_plat_routes_handle_event (self, ifindex, obj_type, change_type, obj);
+	if (obj)
+		nmp_object_unref (obj);
+}
+
+static void
+_plat_routes_sync_done (NMRouteManager *self)
+{
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
+	guint i;
+
+	nm_assert (priv->plat_routes_syncing > 0);
+
+	if (--priv->plat_routes_syncing > 0)
+		return;
+
+	for (i = 0; i < priv->plat_routes_events->len; i++) {
+		PlatRoutesEvent *event = &g_array_index (priv->plat_routes_events, PlatRoutesEvent, i);
+
+		_plat_routes_handle_event (self, event->ifindex, event->obj_type, event->change_type, event->obj);
+		if (event->obj)
+			nmp_object_unref (event->obj);
+	}
+	g_array_set_size (priv->plat_routes_events, 0);
+}
+
+/* Returns the routes in platform on @ifindex, sorted by route_id_cmp(). They
+ * are fetched from platform only on the first call and then kept up to date.
+ * Returns %NULL if there is no such interface. */
+static const GPtrArray *
+_plat_routes_get (const VTableIP *vtable, NMRouteManager *self, int ifindex)
+{
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
+	PlatRoutes *plat_routes;
+	GPtrArray *routes;
+	GArray *array;
+	guint i;
+
+	plat_routes = g_hash_table_lookup (priv->plat_routes, GINT_TO_POINTER (ifindex));
+	if (!plat_routes) {
+		/* don't start tracking an interface that is already gone, we
+		 * would never learn about its removal. */
+		if (!nm_platform_link_get (priv->platform, ifindex))
+			return NULL;
+
+		plat_routes = g_slice_new0 (PlatRoutes);
+		plat_routes->watch = nm_platform_ifindex_watch_add (priv->platform, ifindex, _plat_routes_platform_changed, self);
+		g_hash_table_insert (priv->plat_routes, GINT_TO_POINTER (ifindex), plat_routes);
+	}
+
+	routes = plat_routes->routes[_VTABLE_IDX (vtable)];
+	if (routes)
+		return routes;
+
+	array = vtable->vt->route_get_all (priv->platform, ifindex,
+	                                   NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_RTPROT_KERNEL);
+	routes = g_ptr_array_new_full (array->len, (GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < array->len; i++) {
+		g_ptr_array_add (routes, nmp_object_new (vtable->vt->is_ip4 ? NMP_OBJECT_TYPE_IP4_ROUTE : NMP_OBJECT_TYPE_IP6_ROUTE,
+		                                         (const NMPlatformObject *) VTABLE_ROUTE_INDEX (vtable, array, i)));
+	}
+	g_array_unref (array);
+
+	g_ptr_array_sort_with_data (routes, (GCompareDataFunc) _plat_routes_cmp_indirect, (gpointer) vtable);
+
+	plat_routes->routes[_VTABLE_IDX (vtable)] = routes;
+	return routes;
+}
+
+/*********************************************************************************************/
+
+static void
+_route_batch_append (GArray **p_batch, NMPlatformRouteBatchOp op, int ifindex, const NMPlatformIPXRoute *route, gint64 metric)
+{
+	NMPlatformRouteBatchItem item = {
+		.op = op,
+		.ifindex = ifindex,
+		.route = route,
+		.metric = metric,
+	};
+
+	if (!*p_batch)
+		*p_batch = g_array_new (FALSE, FALSE, sizeof (NMPlatformRouteBatchItem));
+	g_array_append_val (*p_batch, item);
+}
+
+static void
+_route_batch_commit (const VTableIP *vtable, NMRouteManager *self, GArray *batch)
+{
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
+
+	if (batch && batch->len) {
+		vtable->vt->route_batch (priv->platform,
+		                         &g_array_index (batch, NMPlatformRouteBatchItem, 0),
+		                         batch->len);
+	}
+}
+
 static gboolean
 _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const GArray *known_routes, gboolean ignore_kernel_routes, gboolean full_sync)
 {
 	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
-	GArray *plat_routes;
+	const GPtrArray *plat_routes;
 	RouteEntries *ipx_routes;
-	RouteIndex *plat_routes_idx, *known_routes_idx;
+	RouteIndex *known_routes_idx;
 	gboolean success = TRUE;
 	guint i, i_type;
 	GArray *to_delete_indexes = NULL;
@@ -447,20 +699,17 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 	gint64 *p_effective_metric = NULL;
 	gboolean ipx_routes_changed = FALSE;
 	gint64 *effective_metrics = NULL;
+	GArray *batch = NULL;
 
 	nm_platform_process_events (priv->platform);
 
 	ipx_routes = vtable->vt->is_ip4 ? &priv->ip4_routes : &priv->ip6_routes;
-	plat_routes = vtable->vt->route_get_all (priv->platform, ifindex,
-	                                         ignore_kernel_routes
-	                                             ? NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT
-	                                             : NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_RTPROT_KERNEL);
-	plat_routes_idx = _route_index_create (vtable, plat_routes);
+	plat_routes = _plat_routes_get (vtable, self, ifindex);
+	priv->plat_routes_syncing++;
 	known_routes_idx = _route_index_create (vtable, known_routes);
 
 	effective_metrics = &g_array_index (ipx_routes->effective_metrics, gint64, 0);
 
-	ASSERT_route_index_valid (vtable, plat_routes, plat_routes_idx, TRUE);
 	ASSERT_route_index_valid (vtable, known_routes, known_routes_idx, FALSE);
 
 	_LOGD (vtable->vt->addr_family, "%3d: sync %u IPv%c routes", ifindex, known_routes_idx->len, vtable->vt->is_ip4 ? '4' : '6');
@@ -541,7 +790,7 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 		/* iterate over @to_delete_indexes and @plat_routes.
 		 * @to_delete_indexes contains the indexes (relative to ipx_routes->index) of items
 		 * we are about to delete. */
-		cur_plat_route = _get_next_plat_route (plat_routes_idx, TRUE, &i_plat_routes);
+		cur_plat_route = _get_next_plat_route (plat_routes, ignore_kernel_routes, TRUE, &i_plat_routes);
 		for (i = 0; i < to_delete_indexes->len; i++) {
 			int route_dest_cmp_result = 0;
 			i_ipx_routes = g_array_index (to_delete_indexes, guint, i);
@@ -559,7 +808,7 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 				if (   route_dest_cmp_result == 0
 				    && cur_plat_route->rx.metric >= *p_effective_metric)
 					break;
-				cur_plat_route = _get_next_plat_route (plat_routes_idx, FALSE, &i_plat_routes);
+				cur_plat_route = _get_next_plat_route (plat_routes, ignore_kernel_routes, FALSE, &i_plat_routes);
 			}
 
 			if (!cur_plat_route) {
@@ -573,9 +822,15 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 				 * in platform. Delete it. */
 				_LOGt (vtable->vt->addr_family, "%3d: platform rt-rm #%u - %s", ifindex, i_plat_routes,
 				       vtable->vt->route_to_string (cur_plat_route, NULL, 0));
-				vtable->vt->route_delete (priv->platform, ifindex, cur_plat_route);
+				_route_batch_append (&batch, NM_PLATFORM_ROUTE_BATCH_DELETE, ifindex, cur_plat_route, -1);
 			}
 		}
+
+		/* @plat_routes is not modified while syncing, so the deletes can
+		 * be sent together after the iteration. */
+		_route_batch_commit (vtable, self, batch);
+		if (batch)
+			g_array_set_size (batch, 0);
 	}
 
 	/* Update @ipx_routes with the just learned changes. */
@@ -711,7 +966,7 @@ next:
 		 ***************************************************************************/
 
 		/* iterate over @plat_routes and @ipx_routes */
-		cur_plat_route = _get_next_plat_route (plat_routes_idx, TRUE, &i_plat_routes);
+		cur_plat_route = _get_next_plat_route (plat_routes, ignore_kernel_routes, TRUE, &i_plat_routes);
 		cur_ipx_route = _get_next_ipx_route (ipx_routes->index, TRUE, &i_ipx_routes, ifindex);
 		if (cur_ipx_route)
 			p_effective_metric = &effective_metrics[i_ipx_routes];
@@ -739,10 +994,14 @@ next:
 			if (   !cur_ipx_route
 			    || route_dest_cmp_result != 0
 			    || *p_effective_metric != cur_plat_route->rx.metric)
-				vtable->vt->route_delete (priv->platform, ifindex, cur_plat_route);
+				_route_batch_append (&batch, NM_PLATFORM_ROUTE_BATCH_DELETE, ifindex, cur_plat_route, -1);
 
-			cur_plat_route = _get_next_plat_route (plat_routes_idx, FALSE, &i_plat_routes);
+			cur_plat_route = _get_next_plat_route (plat_routes, ignore_kernel_routes, FALSE, &i_plat_routes);
 		}
+
+		_route_batch_commit (vtable, self, batch);
+		if (batch)
+			g_array_set_size (batch, 0);
 	}
 
 	/***************************************************************************
@@ -832,7 +1091,7 @@ next:
 
 	for (i_type = 0; i_type < 2; i_type++) {
 		/* iterate (twice) over @ipx_routes and @plat_routes */
-		cur_plat_route = _get_next_plat_route (plat_routes_idx, TRUE, &i_plat_routes);
+		cur_plat_route = _get_next_plat_route (plat_routes, ignore_kernel_routes, TRUE, &i_plat_routes);
 		cur_ipx_route = _get_next_ipx_route (ipx_routes->index, TRUE, &i_ipx_routes, ifindex);
 		/* Iterate here over @ipx_routes instead of @known_routes. That is done because
 		 * we need to know whether a route is shadowed by another route, and that
@@ -860,34 +1119,45 @@ next:
 				if (   route_dest_cmp_result == 0
 				    && cur_plat_route->rx.metric >= *p_effective_metric)
 					break;
-				cur_plat_route = _get_next_plat_route (plat_routes_idx, FALSE, &i_plat_routes);
+				cur_plat_route = _get_next_plat_route (plat_routes, ignore_kernel_routes, FALSE, &i_plat_routes);
 			}
 
 			/* only add the route if we don't have an identical route in @plat_routes,
 			 * i.e. if @cur_plat_route is different from @cur_ipx_route. */
 			if (   !cur_plat_route
 			    || route_dest_cmp_result != 0
-			    || !_route_equals_ignoring_ifindex (vtable, cur_plat_route, cur_ipx_route, *p_effective_metric)) {
-
-				if (!vtable->vt->route_add (priv->platform, ifindex, cur_ipx_route, *p_effective_metric)) {
-					if (cur_ipx_route->rx.source < NM_IP_CONFIG_SOURCE_USER) {
-						_LOGD (vtable->vt->addr_family,
-						       "ignore error adding IPv%c route to kernel: %s",
-						       vtable->vt->is_ip4 ? '4' : '6',
-						       vtable->vt->route_to_string (cur_ipx_route, NULL, 0));
-					} else {
-						/* Remember that there was a failure, but for now continue trying
-						 * to sync the remaining routes. */
-						success = FALSE;
-					}
-				}
+			    || !_route_equals_ignoring_ifindex (vtable, cur_plat_route, cur_ipx_route, *p_effective_metric))
+				_route_batch_append (&batch, NM_PLATFORM_ROUTE_BATCH_ADD, ifindex, cur_ipx_route, *p_effective_metric);
+		}
+
+		/* the gateway routes of the second run depend on the device routes
+		 * of the first one, so commit the batch after each run. */
+		if (!batch)
+			continue;
+		_route_batch_commit (vtable, self, batch);
+		for (i = 0; i < batch->len; i++) {
+			const NMPlatformRouteBatchItem *item = &g_array_index (batch, NMPlatformRouteBatchItem, i);
+
+			if (item->success)
+				continue;
+			if (item->route->rx.source < NM_IP_CONFIG_SOURCE_USER) {
+				_LOGD (vtable->vt->addr_family,
+				       "ignore error adding IPv%c route to kernel: %s",
+				       vtable->vt->is_ip4 ? '4' : '6',
+				       vtable->vt->route_to_string (item->route, NULL, 0));
+			} else {
+				/* Remember that there was a failure, but for now continue trying
+				 * to sync the remaining routes. */
+				success = FALSE;
 			}
 		}
+		g_array_set_size (batch, 0);
 	}
 
+	if (batch)
+		g_array_unref (batch);
 	g_free (known_routes_idx);
-	g_free (plat_routes_idx);
-	g_array_unref (plat_routes);
+	_plat_routes_sync_done (self);
 
 	return success;
 }
@@ -1047,6 +1317,18 @@ _ip4_device_routes_ip4_route_changed (NMPlatform *platform,
 	}
 }
 
+static void
+_ip4_device_routes_platform_changed (NMPlatform *platform,
+                                     NMPObjectType obj_type,
+                                     int ifindex,
+                                     gconstpointer platform_object,
+                                     NMPlatformSignalChangeType change_type,
+                                     gpointer user_data)
+{
+	if (obj_type == NMP_OBJECT_TYPE_IP4_ROUTE)
+		_ip4_device_routes_ip4_route_changed (platform, obj_type, ifindex, platform_object, change_type, user_data);
+}
+
 static gboolean
 _ip4_device_routes_cancel (NMRouteManager *self)
 {
@@ -1056,8 +1338,15 @@ _ip4_device_routes_cancel (NMRouteManager *self)
 		if (g_hash_table_size (priv->ip4_device_routes.entries) > 0)
 			return G_SOURCE_CONTINUE;
 		_LOGt (vtable_v4.vt->addr_family, "device-route: cancel");
-		if (priv->platform)
-			g_signal_handlers_disconnect_by_func (priv->platform, G_CALLBACK (_ip4_device_routes_ip4_route_changed), self);
+		if (priv->platform) {
+			GHashTableIter iter;
+			NMPlatformIfindexWatch *watch;
+
+			g_hash_table_iter_init (&iter, priv->ip4_device_routes.watches);
+			while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &watch))
+				nm_platform_ifindex_watch_remove (priv->platform, watch);
+		}
+		g_hash_table_remove_all (priv->ip4_device_routes.watches);
 		nm_clear_g_source (&priv->ip4_device_routes.gc_id);
 	}
 	return G_SOURCE_REMOVE;
@@ -1098,6 +1387,7 @@ nm_route_manager_ip4_route_register_device_route_purge_list (NMRouteManager *sel
 	NMRouteManagerPrivate *priv;
 	guint i;
 	gint64 now_ns;
+	int ifindex;
 
 	if (!device_route_purge_list || device_route_purge_list->len == 0)
 		return;
@@ -1116,9 +1406,17 @@ nm_route_manager_ip4_route_register_device_route_purge_list (NMRouteManager *sel
 		g_hash_table_replace (priv->ip4_device_routes.entries,
 		                      nmp_object_ref (entry->obj),
 		                      entry);
+
+		/* only watch the interfaces that have a device route to purge. */
+		ifindex = entry->obj->ip4_route.ifindex;
+		if (   ifindex > 0
+		    && !g_hash_table_contains (priv->ip4_device_routes.watches, GINT_TO_POINTER (ifindex))) {
+			g_hash_table_insert (priv->ip4_device_routes.watches,
+			                     GINT_TO_POINTER (ifindex),
+			                     nm_platform_ifindex_watch_add (priv->platform, ifindex, _ip4_device_routes_platform_changed, self));
+		}
 	}
 	if (priv->ip4_device_routes.gc_id == 0) {
-		g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (_ip4_device_routes_ip4_route_changed), self);
 		priv->ip4_device_routes.gc_id = g_timeout_add (IP4_DEVICE_ROUTES_GC_INTERVAL_SEC, (GSourceFunc) _ip4_device_routes_gc, self);
 	}
 }
@@ -1177,6 +1475,9 @@ nm_route_manager_init (NMRouteManager *self)
 	                                                         (GEqualFunc) nmp_object_id_equal,
 	                                                         (GDestroyNotify) nmp_object_unref,
 	                                                         (GDestroyNotify) _ip4_device_routes_purge_entry_free);
+	priv->ip4_device_routes.watches = g_hash_table_new (NULL, NULL);
+	priv->plat_routes = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) _plat_routes_free);
+	priv->plat_routes_events = g_array_new (FALSE, FALSE, sizeof (PlatRoutesEvent));
 }
 
 NMRouteManager *
@@ -1196,6 +1497,16 @@ dispose (GObject *object)
 	g_hash_table_remove_all (priv->ip4_device_routes.entries);
 	_ip4_device_routes_cancel (self);
 
+	if (priv->platform) {
+		GHashTableIter iter;
+		PlatRoutes *plat_routes;
+
+		g_hash_table_iter_init (&iter, priv->plat_routes);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &plat_routes))
+			nm_platform_ifindex_watch_remove (priv->platform, plat_routes->watch);
+	}
+	g_hash_table_remove_all (priv->plat_routes);
+
 	g_clear_object (&priv->platform);
 
 	G_OBJECT_CLASS (nm_route_manager_parent_class)->dispose (object);
@@ -1216,6 +1527,9 @@ finalize (GObject *object)
 	g_free (priv->ip6_routes.index);
 
 	g_hash_table_unref (priv->ip4_device_routes.entries);
+	g_hash_table_unref (priv->ip4_device_routes.watches);
+	g_hash_table_unref (priv->plat_routes);
+	g_array_unref (priv->plat_routes_events);
 
 	g_clear_object (&priv->platform);
 
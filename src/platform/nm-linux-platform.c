@@ -25,6 +25,7 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/epoll.h>
 #include <fcntl.h>
 #include <dlfcn.h>
 #include <arpa/inet.h>
@@ -223,6 +224,7 @@ static void cache_pre_hook (NMPCache *cache, const NMPObject *old, const NMPObje
 static void cache_prune_candidates_prune (NMPlatform *platform);
 static gboolean event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks);
 static void _assert_netns_current (NMPlatform *platform);
+static void _netns_ensure (NMPlatform *platform);
 
 /*****************************************************************************/
 
@@ -307,6 +309,46 @@ _nm_ip_config_source_to_rtprot (NMIPConfigSource source)
 	}
 }
 
+static const struct {
+	guint8 rtprot;
+	const char *name;
+} _rtprot_names[] = {
+	/* like iproute2's /etc/iproute2/rt_protos */
+	{ RTPROT_UNSPEC,   "unspec" },
+	{ RTPROT_REDIRECT, "redirect" },
+	{ RTPROT_KERNEL,   "kernel" },
+	{ RTPROT_BOOT,     "boot" },
+	{ RTPROT_STATIC,   "static" },
+	{ 8,               "gated" },
+	{ RTPROT_RA,       "ra" },
+	{ 10,              "mrt" },
+	{ 11,              "zebra" },
+	{ 12,              "bird" },
+	{ 13,              "dnrouted" },
+	{ 14,              "xorp" },
+	{ 15,              "ntk" },
+	{ RTPROT_DHCP,     "dhcp" },
+	{ 17,              "mrouted" },
+	{ 42,              "babel" },
+	{ 186,             "bgp" },
+	{ 187,             "isis" },
+	{ 188,             "ospf" },
+	{ 189,             "rip" },
+	{ 192,             "eigrp" },
+};
+
+static int
+_rtprot_from_string (const char *str)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (_rtprot_names); i++) {
+		if (!g_ascii_strcasecmp (str, _rtprot_names[i].name))
+			return _rtprot_names[i].rtprot;
+	}
+	return _nm_utils_ascii_str_to_int64 (str, 0, 0, 255, -1);
+}
+
 static NMIPConfigSource
 _nm_ip_config_source_from_rtprot (guint rtprot)
 {
@@ -649,8 +691,6 @@ _linktype_get_type (NMPlatform *platform,
 {
 	guint i;
 
-	_assert_netns_current (platform);
-
 	if (completed_from_cache) {
 		const NMPObject *obj;
 
@@ -676,6 +716,9 @@ _linktype_get_type (NMPlatform *platform,
 		}
 	}
 
+	/* the detection below might look at sysfs or ethtool of the link. */
+	_netns_ensure (platform);
+
 	*out_kind = g_intern_string (kind);
 
 	if (kind) {
@@ -1719,7 +1762,7 @@ errout:
 
 /* Copied and heavily modified from libnl3's rtnl_route_parse() and parse_multipath(). */
 static NMPObject *
-_new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
+_new_from_nl_route (struct nlmsghdr *nlh, const guint8 *ignore_rtprot, gboolean id_only)
 {
 	static struct nla_policy policy[RTA_MAX+1] = {
 		[RTA_IIF]       = { .type = NLA_U32 },
@@ -1760,6 +1803,17 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	    || rtm->rtm_tos != 0)
 		goto errout;
 
+	/* Check the table and the protocol before parsing the attributes. Routers
+	 * can have huge routing tables that we don't care about. For tables
+	 * above 255, rtm_table is RT_TABLE_COMPAT, thus only the main table
+	 * passes this check. */
+	if (rtm->rtm_table != RT_TABLE_MAIN)
+		goto errout;
+
+	if (   ignore_rtprot
+	    && NM_FLAGS_HAS (ignore_rtprot[rtm->rtm_protocol / 8], 1 << (rtm->rtm_protocol % 8)))
+		goto errout;
+
 	err = nlmsg_parse (nlh, sizeof (struct rtmsg), tb, RTA_MAX, policy);
 	if (err < 0)
 		goto errout;
@@ -1920,20 +1974,14 @@ errout:
  * @cache: (allow-none): for certain objects, the netlink message doesn't contain all the information.
  *   If a cache is given, the object is completed with information from the cache.
  * @nlh: the netlink message header
+ * @ignore_rtprot: (allow-none): bitmap of route protocols to ignore.
  * @id_only: whether only to create an empty object with only the ID fields set.
  *
  * Returns: %NULL or a newly created NMPObject instance.
  **/
 static NMPObject *
-nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_msg *msg, gboolean id_only)
+nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr *msghdr, const guint8 *ignore_rtprot, gboolean id_only)
 {
-	struct nlmsghdr *msghdr;
-
-	if (nlmsg_get_proto (msg) != NETLINK_ROUTE)
-		return NULL;
-
-	msghdr = nlmsg_hdr (msg);
-
 	switch (msghdr->nlmsg_type) {
 	case RTM_NEWLINK:
 	case RTM_DELLINK:
@@ -1947,7 +1995,7 @@ nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_m
 	case RTM_NEWROUTE:
 	case RTM_DELROUTE:
 	case RTM_GETROUTE:
-		return _new_from_nl_route (msghdr, id_only);
+		return _new_from_nl_route (msghdr, ignore_rtprot, id_only);
 	default:
 		return NULL;
 	}
@@ -2328,14 +2376,11 @@ static int _support_kernel_extended_ifa_flags = -1;
 #define _support_kernel_extended_ifa_flags_still_undecided() (G_UNLIKELY (_support_kernel_extended_ifa_flags == -1))
 
 static void
-_support_kernel_extended_ifa_flags_detect (struct nl_msg *msg)
+_support_kernel_extended_ifa_flags_detect (struct nlmsghdr *msg_hdr)
 {
-	struct nlmsghdr *msg_hdr;
-
 	if (!_support_kernel_extended_ifa_flags_still_undecided ())
 		return;
 
-	msg_hdr = nlmsg_hdr (msg);
 	if (msg_hdr->nlmsg_type != RTM_NEWADDR)
 		return;
 
@@ -2374,17 +2419,30 @@ typedef struct {
 
 typedef struct _NMLinuxPlatformPrivate NMLinuxPlatformPrivate;
 
+/* Kernel fills netlink dump messages up to 32K if the receive buffer
+ * allows it (see netlink_recvmsg() and netlink_dump()). */
+#define NL_RECV_BUF_SIZE    (32 * 1024)
+#define NL_RECV_BUF_RING    4
+
 struct _NMLinuxPlatformPrivate {
 	struct nl_sock *nlh;
 	guint32 nlh_seq_next;
 	guint32 nlh_seq_last_handled;
 	NMPCache *cache;
-	GIOChannel *event_channel;
-	guint event_id;
+	bool event_registered:1;
 
 	gboolean sysctl_get_warned;
 	GHashTable *sysctl_get_prev_values;
 
+	/* the last time /proc/sys of the platform's netns was accessed,
+	 * to decide whether to keep the fds open. See _sysctl_open(). */
+	gint64 sysctl_fds_last_access_ms;
+
+	/* while handling events, the platform's netns is pushed on demand
+	 * and only popped once the outermost scope is left. */
+	guint netns_lazy_scope;
+	bool netns_lazy_pushed:1;
+
 	GUdevClient *udev_client;
 
 	struct {
@@ -2397,7 +2455,43 @@ struct _NMLinuxPlatformPrivate {
 
 	GHashTable *prune_candidates;
 
+	/* per object type, for pruning the objects that are not part of
+	 * the last dump. */
+	struct {
+		guint32 generation;
+		WaitForNlResponseResult seq_result;
+		bool pending:1;
+	} dump[NMP_OBJECT_TYPE_MAX];
+
+	struct {
+		/* the object types that had notifications recently. */
+		DelayedActionType active_types;
+		DelayedActionType active_types_prev;
+		gint64 window_start_ns;
+
+		/* object types whose resync after an overrun is postponed. */
+		DelayedActionType deferred_types;
+		guint deferred_id;
+
+		int rcvbuf_size;
+	} overrun;
+
 	GHashTable *wifi_data;
+
+	/* receive buffers, reused across reads. event_handler_recvmsgs() might be
+	 * called recursively from a signal handler, so there is one buffer per
+	 * nesting level. */
+	struct {
+		guint8 *bufs[NL_RECV_BUF_RING];
+		gsize buf_sizes[NL_RECV_BUF_RING];
+		guint depth;
+	} recv;
+
+	/* bitmap of route protocols (rtm_protocol) that are not cached.
+	 * NULL if all are cached. */
+	guint8 *ignore_rtprot;
+
+	bool defer_populate:1;
 };
 
 static inline NMLinuxPlatformPrivate *
@@ -2410,11 +2504,39 @@ NM_LINUX_PLATFORM_GET_PRIVATE (const void *self)
 
 G_DEFINE_TYPE (NMLinuxPlatform, nm_linux_platform, NM_TYPE_PLATFORM)
 
+NM_GOBJECT_PROPERTIES_DEFINE_BASE (
+	PROP_DEFER_POPULATE,
+	PROP_IGNORE_ROUTE_PROTOCOLS,
+);
+
+/* process-wide configuration, applied to every instance. */
+static char *default_ignore_route_protocols;
+
 void
 nm_linux_platform_setup (void)
 {
+	nm_linux_platform_setup_full (NULL);
+}
+
+/**
+ * nm_linux_platform_setup_full:
+ * @ignore_route_protocols: (allow-none): a list of route protocols, separated
+ *   by comma or whitespace. Routes with these protocols are not cached.
+ *
+ * Like nm_linux_platform_setup(), but allows to configure the platform.
+ * The configuration applies to the singleton instance and to all instances
+ * created afterwards with nm_linux_platform_new() and
+ * nm_linux_platform_new_deferred(), like the per-namespace ones.
+ */
+void
+nm_linux_platform_setup_full (const char *ignore_route_protocols)
+{
+	g_free (default_ignore_route_protocols);
+	default_ignore_route_protocols = g_strdup (ignore_route_protocols);
+
 	g_object_new (NM_TYPE_LINUX_PLATFORM,
 	              NM_PLATFORM_REGISTER_SINGLETON, TRUE,
+	              NM_LINUX_PLATFORM_IGNORE_ROUTE_PROTOCOLS, default_ignore_route_protocols,
 	              NULL);
 }
 
@@ -2423,6 +2545,28 @@ nm_linux_platform_new (void)
 {
 	return g_object_new (NM_TYPE_LINUX_PLATFORM,
 	                     NM_PLATFORM_REGISTER_SINGLETON, FALSE,
+	                     NM_LINUX_PLATFORM_IGNORE_ROUTE_PROTOCOLS, default_ignore_route_protocols,
+	                     NULL);
+}
+
+/**
+ * nm_linux_platform_new_deferred:
+ *
+ * Like nm_linux_platform_new(), but the constructor only sends the
+ * initial dump request and does not wait for the kernel to reply.
+ * The cache gets populated on the next nm_platform_process_events().
+ * That allows a caller to create many instances (each in its own
+ * namespace) and collect all the replies afterwards.
+ *
+ * Returns: (transfer full): the new platform instance.
+ */
+NMPlatform *
+nm_linux_platform_new_deferred (void)
+{
+	return g_object_new (NM_TYPE_LINUX_PLATFORM,
+	                     NM_PLATFORM_REGISTER_SINGLETON, FALSE,
+	                     NM_LINUX_PLATFORM_DEFER_POPULATE, TRUE,
+	                     NM_LINUX_PLATFORM_IGNORE_ROUTE_PROTOCOLS, default_ignore_route_protocols,
 	                     NULL);
 }
 
@@ -2438,6 +2582,320 @@ _assert_netns_current (NMPlatform *platform)
 #endif
 }
 
+static void
+_netns_lazy_scope_enter (NMPlatform *platform)
+{
+	NM_LINUX_PLATFORM_GET_PRIVATE (platform)->netns_lazy_scope++;
+}
+
+static void
+_netns_lazy_scope_leave (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	nm_assert (priv->netns_lazy_scope > 0);
+
+	if (   --priv->netns_lazy_scope == 0
+	    && priv->netns_lazy_pushed) {
+		priv->netns_lazy_pushed = FALSE;
+		nmp_netns_pop (platform->_netns);
+	}
+}
+
+/* Ensure that we are inside the netns of @platform. Inside a lazy scope,
+ * the netns gets pushed on first use and stays until the scope is left.
+ * That way, processing a batch of netlink messages switches the namespace
+ * at most once and not at all if no signal has to be emitted. */
+static void
+_netns_ensure (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv;
+
+	if (   !platform
+	    || !platform->_netns
+	    || platform->_netns == nmp_netns_get_current ())
+		return;
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	if (   priv->netns_lazy_scope > 0
+	    && !priv->netns_lazy_pushed) {
+		if (nmp_netns_push (platform->_netns))
+			priv->netns_lazy_pushed = TRUE;
+		return;
+	}
+
+	_assert_netns_current (platform);
+}
+
+/******************************************************************/
+
+/* Accessing sysctl of a platform in another netns would require two
+ * setns() calls per access. Instead, sysfs is accessed relative to a
+ * directory fd of the netns' own sysfs mount. That does not work for
+ * /proc/sys, where the lookup always resolves in the netns of the
+ * calling thread. So the files there are opened once inside the netns
+ * and the fds are kept, as they stay bound to that netns.
+ *
+ * The fds of all instances share one budget, the least recently used
+ * ones are closed first. */
+#define SYSCTL_FDS_MAX 256
+
+/* fds are only kept for a netns that accessed /proc/sys shortly before,
+ * so that rarely used namespaces don't hold fds. */
+#define SYSCTL_FDS_HOT_MS 10000
+
+typedef struct {
+	NMPlatform *platform;
+	char *path;
+	int fd;
+	bool for_write;
+
+	/* link in sysctl_fds.lru. */
+	GList lru;
+} SysctlFd;
+
+static struct {
+	GHashTable *idx;
+	/* the most recently used first. */
+	GQueue lru;
+} sysctl_fds;
+
+static guint
+_sysctl_fd_hash (gconstpointer ptr)
+{
+	const SysctlFd *e = ptr;
+
+	return g_direct_hash (e->platform) ^ g_str_hash (e->path) ^ (e->for_write ? 1u : 0u);
+}
+
+static gboolean
+_sysctl_fd_equal (gconstpointer a, gconstpointer b)
+{
+	const SysctlFd *e_a = a;
+	const SysctlFd *e_b = b;
+
+	return    e_a->platform == e_b->platform
+	       && e_a->for_write == e_b->for_write
+	       && strcmp (e_a->path, e_b->path) == 0;
+}
+
+static gboolean
+_sysctl_use_fds (NMPlatform *platform)
+{
+	return    platform->_netns
+	       && platform->_netns != nmp_netns_get_current ();
+}
+
+static void
+_sysctl_fd_free (SysctlFd *e)
+{
+	close (e->fd);
+	g_free (e->path);
+	g_slice_free (SysctlFd, e);
+}
+
+static void
+_sysctl_fd_remove (SysctlFd *e)
+{
+	g_hash_table_remove (sysctl_fds.idx, e);
+	g_queue_unlink (&sysctl_fds.lru, &e->lru);
+	_sysctl_fd_free (e);
+}
+
+static SysctlFd *
+_sysctl_fd_lookup (NMPlatform *platform, const char *path, gboolean for_write)
+{
+	SysctlFd needle = {
+		.platform = platform,
+		.path = (char *) path,
+		.for_write = for_write,
+	};
+	SysctlFd *e;
+
+	if (!sysctl_fds.idx)
+		return NULL;
+	e = g_hash_table_lookup (sysctl_fds.idx, &needle);
+	if (e) {
+		g_queue_unlink (&sysctl_fds.lru, &e->lru);
+		g_queue_push_head_link (&sysctl_fds.lru, &e->lru);
+	}
+	return e;
+}
+
+static void
+_sysctl_fd_add (NMPlatform *platform, const char *path, gboolean for_write, int fd)
+{
+	SysctlFd *e;
+
+	if (!sysctl_fds.idx)
+		sysctl_fds.idx = g_hash_table_new (_sysctl_fd_hash, _sysctl_fd_equal);
+	else if (g_hash_table_size (sysctl_fds.idx) >= SYSCTL_FDS_MAX)
+		_sysctl_fd_remove (sysctl_fds.lru.tail->data);
+
+	e = g_slice_new0 (SysctlFd);
+	e->platform = platform;
+	e->path = g_strdup (path);
+	e->fd = fd;
+	e->for_write = for_write;
+	e->lru.data = e;
+	g_hash_table_add (sysctl_fds.idx, e);
+	g_queue_push_head_link (&sysctl_fds.lru, &e->lru);
+}
+
+/* closes all fds of @platform. */
+static void
+_sysctl_fds_clear (NMPlatform *platform)
+{
+	GList *iter, *next;
+
+	for (iter = sysctl_fds.lru.head; iter; iter = next) {
+		SysctlFd *e = iter->data;
+
+		next = iter->next;
+		if (e->platform == platform)
+			_sysctl_fd_remove (e);
+	}
+}
+
+static void
+_sysctl_fd_drop (NMPlatform *platform, const char *path, gboolean for_write)
+{
+	SysctlFd *e;
+
+	e = _sysctl_fd_lookup (platform, path, for_write);
+	if (e)
+		_sysctl_fd_remove (e);
+}
+
+/* Open @path inside the netns of @platform. If @out_cached is set to %TRUE,
+ * the returned fd is owned by the cache and must not be closed. On failure,
+ * returns -1 and sets errno. */
+static int
+_sysctl_open (NMPlatform *platform, const char *path, gboolean for_write, gboolean *out_cached)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int flags = (for_write ? (O_WRONLY | O_TRUNC) : O_RDONLY) | O_CLOEXEC;
+	SysctlFd *e;
+	gint64 now_ms;
+	gboolean hot;
+	int fd, fd_sys, errsv;
+
+	*out_cached = FALSE;
+
+	if (g_str_has_prefix (path, "/sys/")) {
+		fd_sys = nmp_netns_get_fd_sys (platform->_netns);
+		if (fd_sys >= 0)
+			return openat (fd_sys, &path[NM_STRLEN ("/sys/")], flags);
+	} else if ((e = _sysctl_fd_lookup (platform, path, for_write))) {
+		*out_cached = TRUE;
+		return e->fd;
+	}
+
+	if (!nmp_netns_push (platform->_netns)) {
+		errno = EINVAL;
+		return -1;
+	}
+	fd = open (path, flags);
+	errsv = errno;
+	nmp_netns_pop (platform->_netns);
+
+	if (fd == -1) {
+		errno = errsv;
+		return -1;
+	}
+
+	if (!g_str_has_prefix (path, "/proc/sys/"))
+		return fd;
+
+	now_ms = nm_utils_get_monotonic_timestamp_ms ();
+	hot =    priv->sysctl_fds_last_access_ms
+	      && now_ms - priv->sysctl_fds_last_access_ms < SYSCTL_FDS_HOT_MS;
+	priv->sysctl_fds_last_access_ms = now_ms;
+	if (!hot)
+		return fd;
+
+	_sysctl_fd_add (platform, path, for_write, fd);
+	*out_cached = TRUE;
+	return fd;
+}
+
+static char *
+_sysctl_read_fd (int fd, int *out_errno)
+{
+	gsize len = 0, alloc = 256;
+	char *buf = g_malloc (alloc);
+	gssize n;
+
+	while (TRUE) {
+		if (len + 1 >= alloc) {
+			alloc *= 2;
+			buf = g_realloc (buf, alloc);
+		}
+		n = pread (fd, &buf[len], alloc - len - 1, len);
+		if (n == 0)
+			break;
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			*out_errno = errno;
+			g_free (buf);
+			return NULL;
+		}
+		len += n;
+	}
+	buf[len] = '\0';
+	return buf;
+}
+
+/* Read the content of @path inside the netns of @platform. */
+static char *
+_sysctl_read (NMPlatform *platform, const char *path, GError **error)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	char *contents;
+	gboolean cached, retried = FALSE;
+	int fd, errsv;
+
+	if (!_sysctl_use_fds (platform)) {
+		if (!nm_platform_netns_push (platform, &netns)) {
+			g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+			             "failed to switch netns");
+			return NULL;
+		}
+		if (!g_file_get_contents (path, &contents, NULL, error))
+			return NULL;
+		return contents;
+	}
+
+again:
+	fd = _sysctl_open (platform, path, FALSE, &cached);
+	if (fd == -1) {
+		errsv = errno;
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+		             "Failed to open file '%s': %s", path, g_strerror (errsv));
+		return NULL;
+	}
+
+	contents = _sysctl_read_fd (fd, &errsv);
+	if (!cached)
+		close (fd);
+	else if (!contents) {
+		/* the cached fd might be stale, e.g. because the interface
+		 * was recreated. Retry once with a fresh file. */
+		_sysctl_fd_drop (platform, path, FALSE);
+		if (!retried) {
+			retried = TRUE;
+			goto again;
+		}
+	}
+
+	if (!contents) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+		             "Failed to read from file '%s': %s", path, g_strerror (errsv));
+	}
+	return contents;
+}
+
 static void
 _log_dbg_sysctl_set_impl (NMPlatform *platform, const char *path, const char *value)
 {
@@ -2445,7 +2903,7 @@ _log_dbg_sysctl_set_impl (NMPlatform *platform, const char *path, const char *va
 	char *contents, *contents_escaped;
 	char *value_escaped = g_strescape (value, NULL);
 
-	if (!g_file_get_contents (path, &contents, NULL, &error)) {
+	if (!(contents = _sysctl_read (platform, path, &error))) {
 		_LOGD ("sysctl: setting '%s' to '%s' (current value cannot be read: %s)", path, value_escaped, error->message);
 		g_clear_error (&error);
 	} else {
@@ -2472,11 +2930,12 @@ static gboolean
 sysctl_set (NMPlatform *platform, const char *path, const char *value)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
-	int fd, tries;
+	int fd, tries, errsv;
 	gssize nwrote;
 	gsize len;
 	char *actual;
 	gs_free char *actual_free = NULL;
+	gboolean use_fds, cached = FALSE, retried = FALSE;
 
 	g_return_val_if_fail (path != NULL, FALSE);
 	g_return_val_if_fail (value != NULL, FALSE);
@@ -2487,22 +2946,10 @@ sysctl_set (NMPlatform *platform, const char *path, const char *value)
 	/* Don't write to suspicious locations */
 	g_assert (!strstr (path, "/../"));
 
-	if (!nm_platform_netns_push (platform, &netns))
-		return FALSE;
-
-	fd = open (path, O_WRONLY | O_TRUNC);
-	if (fd == -1) {
-		if (errno == ENOENT) {
-			_LOGD ("sysctl: failed to open '%s': (%d) %s",
-			       path, errno, strerror (errno));
-		} else {
-			_LOGE ("sysctl: failed to open '%s': (%d) %s",
-			       path, errno, strerror (errno));
-		}
+	use_fds = _sysctl_use_fds (platform);
+	if (   !use_fds
+	    && !nm_platform_netns_push (platform, &netns))
 		return FALSE;
-	}
-
-	_log_dbg_sysctl_set (platform, path, value);
 
 	/* Most sysfs and sysctl options don't care about a trailing LF, while some
 	 * (like infiniband) do.  So always add the LF.  Also, neither sysfs nor
@@ -2518,26 +2965,62 @@ sysctl_set (NMPlatform *platform, const char *path, const char *value)
 	actual[len - 1] = '\n';
 	actual[len] = '\0';
 
+again:
+	if (use_fds)
+		fd = _sysctl_open (platform, path, TRUE, &cached);
+	else
+		fd = open (path, O_WRONLY | O_TRUNC);
+	if (fd == -1) {
+		errsv = errno;
+		if (errsv == ENOENT) {
+			_LOGD ("sysctl: failed to open '%s': (%d) %s",
+			       path, errsv, strerror (errsv));
+		} else {
+			_LOGE ("sysctl: failed to open '%s': (%d) %s",
+			       path, errsv, strerror (errsv));
+		}
+		return FALSE;
+	}
+
+	if (!retried)
+		_log_dbg_sysctl_set (platform, path, value);
+
 	/* Try to write the entire value three times if a partial write occurs */
+	errsv = 0;
 	for (tries = 0, nwrote = 0; tries < 3 && nwrote != len; tries++) {
-		nwrote = write (fd, actual, len);
+		nwrote = pwrite (fd, actual, len, 0);
 		if (nwrote == -1) {
-			if (errno == EINTR) {
+			errsv = errno;
+			if (errsv == EINTR) {
 				_LOGD ("sysctl: interrupted, will try again");
 				continue;
 			}
 			break;
 		}
 	}
-	if (nwrote == -1 && errno != EEXIST) {
+
+	if (cached) {
+		if (nwrote == len)
+			return TRUE;
+
+		/* the cached fd might be stale. Retry once with a fresh file. */
+		_sysctl_fd_drop (platform, path, TRUE);
+		if (   !retried
+		    && NM_IN_SET (errsv, ENOENT, ENODEV)) {
+			retried = TRUE;
+			goto again;
+		}
+	} else
+		close (fd);
+
+	if (nwrote == -1 && errsv != EEXIST) {
 		_LOGE ("sysctl: failed to set '%s' to '%s': (%d) %s",
-		       path, value, errno, strerror (errno));
+		       path, value, errsv, strerror (errsv));
 	} else if (nwrote < len) {
 		_LOGE ("sysctl: failed to set '%s' to '%s' after three attempts",
 		       path, value);
 	}
 
-	close (fd);
 	return (nwrote == len);
 }
 
@@ -2604,7 +3087,6 @@ _log_dbg_sysctl_get_impl (NMPlatform *platform, const char *path, const char *co
 static char *
 sysctl_get (NMPlatform *platform, const char *path)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
 	GError *error = NULL;
 	char *contents;
 
@@ -2614,10 +3096,7 @@ sysctl_get (NMPlatform *platform, const char *path)
 	/* Don't write to suspicious locations */
 	g_assert (!strstr (path, "/../"));
 
-	if (!nm_platform_netns_push (platform, &netns))
-		return NULL;
-
-	if (!g_file_get_contents (path, &contents, NULL, &error)) {
+	if (!(contents = _sysctl_read (platform, path, &error))) {
 		/* We assume FAILED means EOPNOTSUP */
 		if (   g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)
 		    || g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_FAILED))
@@ -2682,7 +3161,7 @@ do_emit_signal (NMPlatform *platform, const NMPObject *obj, NMPCacheOpsType cach
 	nm_assert (!obj || cache_op != NMP_CACHE_OPS_REMOVED || obj != nmp_cache_lookup_obj (NM_LINUX_PLATFORM_GET_PRIVATE (platform)->cache, obj));
 
 	/* we raise the signals inside the namespace of the NMPlatform instance. */
-	_assert_netns_current (platform);
+	_netns_ensure (platform);
 
 	switch (cache_op) {
 	case NMP_CACHE_OPS_ADDED:
@@ -3010,6 +3489,8 @@ delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink)
 
 	g_return_val_if_fail (priv->delayed_action.is_handling == 0, FALSE);
 
+	_netns_lazy_scope_enter (platform);
+
 	priv->delayed_action.is_handling++;
 	if (read_netlink)
 		delayed_action_schedule (platform, DELAYED_ACTION_TYPE_READ_NETLINK, NULL);
@@ -3019,6 +3500,8 @@ delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink)
 
 	cache_prune_candidates_prune (platform);
 
+	_netns_lazy_scope_leave (platform);
+
 	return any;
 }
 
@@ -3078,16 +3561,86 @@ delayed_action_schedule_WAIT_FOR_NL_RESPONSE (NMPlatform *platform,
 
 /******************************************************************/
 
+/* Pruning after a dump works by mark-and-sweep: starting a dump bumps the
+ * generation of the object type, every object received from netlink gets
+ * marked with the current generation (see cache_prune_mark()), and once the
+ * dump completed successfully, the objects with an older generation are
+ * removed. Contrary to recording all objects as prune candidates, that
+ * doesn't allocate per object and doesn't cost a hash operation for each
+ * received message. */
+static void
+cache_prune_dump_start (NMPlatform *platform, NMPObjectType obj_type)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint i;
+
+	if (   priv->dump[obj_type - 1].pending
+	    && priv->dump[obj_type - 1].seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN
+	    && NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE)) {
+		/* a previous dump is still in progress. Its completion must not
+		 * trigger the sweep for the new generation. */
+		for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
+			DelayedActionWaitForNlResponseData *data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
+
+			if (data->out_seq_result == &priv->dump[obj_type - 1].seq_result)
+				data->out_seq_result = NULL;
+		}
+	}
+
+	priv->dump[obj_type - 1].generation++;
+	priv->dump[obj_type - 1].seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	priv->dump[obj_type - 1].pending = TRUE;
+	_LOGt ("cache-prune: start dump %s (generation %u)", nmp_class_from_type (obj_type)->obj_type_name,
+	       priv->dump[obj_type - 1].generation);
+}
+
+static void
+cache_prune_mark (NMPlatform *platform, NMPObject *obj)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (obj && obj->is_cached)
+		obj->dump_generation = priv->dump[NMP_OBJECT_GET_TYPE (obj) - 1].generation;
+}
+
 static void
-cache_prune_candidates_record_all (NMPlatform *platform, NMPObjectType obj_type)
+cache_prune_sweep (NMPlatform *platform, NMPObjectType obj_type)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_unref_ptrarray GPtrArray *stale = NULL;
+	const NMPlatformObject *const *list;
+	guint32 generation = priv->dump[obj_type - 1].generation;
+	guint i, len;
+
+	list = nmp_cache_lookup_multi (priv->cache,
+	                               nmp_cache_id_init_object_type (NMP_CACHE_ID_STATIC, obj_type, FALSE),
+	                               &len);
+	for (i = 0; i < len; i++) {
+		NMPObject *obj = NMP_OBJECT_UP_CAST (list[i]);
+
+		if (obj->dump_generation != generation) {
+			if (!stale)
+				stale = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+			g_ptr_array_add (stale, nmp_object_ref (obj));
+		}
+	}
+
+	_LOGt ("cache-prune: sweep %s (%u of %u objects stale)", nmp_class_from_type (obj_type)->obj_type_name,
+	       stale ? stale->len : 0, len);
+
+	if (!stale)
+		return;
+
+	for (i = 0; i < stale->len; i++) {
+		nm_auto_nmpobj NMPObject *obj_cache = NULL;
+		const NMPObject *obj = stale->pdata[i];
+		NMPCacheOpsType cache_op;
+		gboolean was_visible;
 
-	priv->prune_candidates = nmp_cache_lookup_all_to_hash (priv->cache,
-	                                                       nmp_cache_id_init_object_type (NMP_CACHE_ID_STATIC, obj_type, FALSE),
-	                                                       priv->prune_candidates);
-	_LOGt ("cache-prune: record %s (now %u candidates)", nmp_class_from_type (obj_type)->obj_type_name,
-	       priv->prune_candidates ? g_hash_table_size (priv->prune_candidates) : 0);
+		_LOGt ("cache-prune: prune %s", nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_ALL, NULL, 0));
+		cache_op = nmp_cache_remove (priv->cache, obj, TRUE, &obj_cache, &was_visible, cache_pre_hook, platform);
+		do_emit_signal (platform, obj_cache, cache_op, was_visible);
+	}
 }
 
 static void
@@ -3133,6 +3686,18 @@ cache_prune_candidates_prune (NMPlatform *platform)
 	const NMPObject *obj;
 	gboolean was_visible;
 	NMPCacheOpsType cache_op;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (priv->dump); i++) {
+		if (   !priv->dump[i].pending
+		    || priv->dump[i].seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN)
+			continue;
+
+		/* only a completed dump tells which objects are gone. */
+		priv->dump[i].pending = FALSE;
+		if (priv->dump[i].seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
+			cache_prune_sweep (platform, i + 1);
+	}
 
 	if (!priv->prune_candidates)
 		return;
@@ -3189,6 +3754,15 @@ cache_pre_hook (NMPCache *cache, const NMPObject *old, const NMPObject *new, NMP
 
 	switch (klass->obj_type) {
 	case NMP_OBJECT_TYPE_LINK:
+		{
+			/* cached sysctl fds refer to the interface by name. Drop them
+			 * when a link goes away or gets renamed. */
+			if (   ops_type == NMP_CACHE_OPS_REMOVED
+			    || (   ops_type == NMP_CACHE_OPS_UPDATED
+			        && old && new /* <-- nonsensical, make coverity happy */
+			        && strcmp (old->link.name, new->link.name) != 0))
+				_sysctl_fds_clear (platform);
+		}
 		{
 			/* check whether changing a slave link can cause a master link (bridge or bond) to go up/down */
 			if (   old
@@ -3451,10 +4025,10 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 	nm_assert (!NM_FLAGS_ANY (action_type, ~DELAYED_ACTION_TYPE_REFRESH_ALL));
 	action_type &= DELAYED_ACTION_TYPE_REFRESH_ALL;
 
-	for (iflags = (DelayedActionType) 0x1LL; iflags <= DELAYED_ACTION_TYPE_MAX; iflags <<= 1) {
-		if (NM_FLAGS_HAS (action_type, iflags))
-			cache_prune_candidates_record_all (platform, delayed_action_refresh_to_object_type (iflags));
-	}
+	/* a postponed resync after an overrun is covered by this dump. */
+	priv->overrun.deferred_types &= ~action_type;
+	if (!priv->overrun.deferred_types)
+		nm_clear_g_source (&priv->overrun.deferred_id);
 
 	for (iflags = (DelayedActionType) 0x1LL; iflags <= DELAYED_ACTION_TYPE_MAX; iflags <<= 1) {
 		if (NM_FLAGS_HAS (action_type, iflags)) {
@@ -3489,7 +4063,9 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 			if (nle < 0)
 				goto next;
 
-			_nl_send_auto_with_seq (platform, nlmsg, NULL);
+			cache_prune_dump_start (platform, obj_type);
+			if (_nl_send_auto_with_seq (platform, nlmsg, &priv->dump[obj_type - 1].seq_result) < 0)
+				priv->dump[obj_type - 1].pending = FALSE;
 		}
 next:
 		;
@@ -3504,14 +4080,14 @@ do_request_one_type (NMPlatform *platform, NMPObjectType obj_type)
 }
 
 static void
-event_seq_check (NMPlatform *platform, struct nl_msg *msg, WaitForNlResponseResult seq_result)
+event_seq_check (NMPlatform *platform, const struct nlmsghdr *msghdr, WaitForNlResponseResult seq_result)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	DelayedActionWaitForNlResponseData *data;
 	guint32 seq_number;
 	guint i;
 
-	seq_number = nlmsg_hdr (msg)->nlmsg_seq;
+	seq_number = msghdr->nlmsg_seq;
 
 	if (seq_number == 0)
 		return;
@@ -3542,21 +4118,18 @@ event_seq_check (NMPlatform *platform, struct nl_msg *msg, WaitForNlResponseResu
 }
 
 static void
-event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_events)
+event_valid_msg (NMPlatform *platform, struct nlmsghdr *msghdr, gboolean handle_events)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	nm_auto_nmpobj NMPObject *obj = NULL;
 	nm_auto_nmpobj NMPObject *obj_cache = NULL;
 	NMPCacheOpsType cache_op;
-	struct nlmsghdr *msghdr;
 	char buf_nlmsg_type[16];
 	gboolean id_only = FALSE;
 	gboolean was_visible;
 
-	msghdr = nlmsg_hdr (msg);
-
 	if (_support_kernel_extended_ifa_flags_still_undecided () && msghdr->nlmsg_type == RTM_NEWADDR)
-		_support_kernel_extended_ifa_flags_detect (msg);
+		_support_kernel_extended_ifa_flags_detect (msghdr);
 
 	if (!handle_events)
 		return;
@@ -3567,7 +4140,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		id_only = TRUE;
 	}
 
-	obj = nmp_object_new_from_nl (platform, priv->cache, msg, id_only);
+	obj = nmp_object_new_from_nl (platform, priv->cache, msghdr, priv->ignore_rtprot, id_only);
 	if (!obj) {
 		_LOGT ("event-notification: %s, seq %u: ignore",
 		       _nl_nlmsg_type_to_str (msghdr->nlmsg_type, buf_nlmsg_type, sizeof (buf_nlmsg_type)),
@@ -3601,6 +4174,11 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	}
 
 	cache_prune_candidates_drop (platform, obj_cache);
+	cache_prune_mark (platform, obj_cache);
+
+	/* unsolicited notifications have no sequence number. */
+	if (msghdr->nlmsg_seq == 0)
+		priv->overrun.active_types |= delayed_action_refresh_from_object_type (NMP_OBJECT_GET_TYPE (obj));
 }
 
 /******************************************************************/
@@ -5025,7 +5603,9 @@ wifi_get_wifi_data (NMPlatform *platform, int ifindex)
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	WifiData *wifi_data;
 
-	wifi_data = g_hash_table_lookup (priv->wifi_data, GINT_TO_POINTER (ifindex));
+	wifi_data = priv->wifi_data
+	            ? g_hash_table_lookup (priv->wifi_data, GINT_TO_POINTER (ifindex))
+	            : NULL;
 	if (!wifi_data) {
 		const NMPlatformLink *pllink;
 
@@ -5043,8 +5623,12 @@ wifi_get_wifi_data (NMPlatform *platform, int ifindex)
 #endif
 			}
 
-			if (wifi_data)
+			if (wifi_data) {
+				/* most namespaces never see a wifi device. */
+				if (!priv->wifi_data)
+					priv->wifi_data = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) wifi_utils_deinit);
 				g_hash_table_insert (priv->wifi_data, GINT_TO_POINTER (ifindex), wifi_data);
+			}
 		}
 	}
 
@@ -5548,6 +6132,254 @@ ip6_route_delete (NMPlatform *platform, int ifindex, struct in6_addr network, in
 	return do_delete_object (platform, &obj_id, nlmsg);
 }
 
+/* How many route requests are in flight at most, before waiting for
+ * their ACKs. */
+#define ROUTE_BATCH_WINDOW   128
+
+/* The requests are coalesced into send buffers of at most this size. */
+#define ROUTE_BATCH_SNDBUF   (32 * 1024)
+
+static gboolean
+_route_batch_item_is_single (int addr_family, const NMPlatformRouteBatchItem *item)
+{
+	/* deleting an IPv4 route with metric 0 requires a special check
+	 * beforehand, see ip4_route_delete(). Don't batch it. */
+	return    addr_family == AF_INET
+	       && item->op == NM_PLATFORM_ROUTE_BATCH_DELETE
+	       && item->route->rx.metric == 0;
+}
+
+static struct nl_msg *
+_route_batch_item_to_nlmsg (int addr_family, const NMPlatformRouteBatchItem *item, NMPObject *obj_id)
+{
+	const NMPlatformIPXRoute *route = item->route;
+	int ifindex = item->ifindex > 0 ? item->ifindex : route->rx.ifindex;
+	guint32 metric;
+
+	if (item->op == NM_PLATFORM_ROUTE_BATCH_ADD) {
+		metric = item->metric >= 0 ? (guint32) item->metric : route->rx.metric;
+
+		if (addr_family == AF_INET) {
+			nmp_object_stackinit_id_ip4_route (obj_id, ifindex, route->r4.network, route->rx.plen, metric);
+			return _nl_msg_new_route (RTM_NEWROUTE,
+			                          NLM_F_CREATE | NLM_F_REPLACE,
+			                          AF_INET,
+			                          ifindex,
+			                          route->rx.source,
+			                          route->r4.gateway ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK,
+			                          &route->r4.network,
+			                          route->rx.plen,
+			                          &route->r4.gateway,
+			                          metric,
+			                          route->rx.mss,
+			                          route->r4.pref_src ? &route->r4.pref_src : NULL);
+		}
+
+		nmp_object_stackinit_id_ip6_route (obj_id, ifindex, &route->r6.network, route->rx.plen, metric);
+		return _nl_msg_new_route (RTM_NEWROUTE,
+		                          NLM_F_CREATE | NLM_F_REPLACE,
+		                          AF_INET6,
+		                          ifindex,
+		                          route->rx.source,
+		                          !IN6_IS_ADDR_UNSPECIFIED (&route->r6.gateway) ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK,
+		                          &route->r6.network,
+		                          route->rx.plen,
+		                          &route->r6.gateway,
+		                          metric,
+		                          route->rx.mss,
+		                          NULL);
+	}
+
+	metric = route->rx.metric;
+	if (addr_family == AF_INET)
+		nmp_object_stackinit_id_ip4_route (obj_id, ifindex, route->r4.network, route->rx.plen, metric);
+	else {
+		metric = nm_utils_ip6_route_metric_normalize (metric);
+		nmp_object_stackinit_id_ip6_route (obj_id, ifindex, &route->r6.network, route->rx.plen, metric);
+	}
+	return _nl_msg_new_route (RTM_DELROUTE,
+	                          0,
+	                          addr_family,
+	                          ifindex,
+	                          NM_IP_CONFIG_SOURCE_UNKNOWN,
+	                          RT_SCOPE_NOWHERE,
+	                          addr_family == AF_INET ? (gconstpointer) &route->r4.network : (gconstpointer) &route->r6.network,
+	                          route->rx.plen,
+	                          NULL,
+	                          metric,
+	                          0,
+	                          NULL);
+}
+
+static void
+_route_batch_flush (NMPlatform *platform,
+                    guint8 *buf,
+                    gsize *buf_len,
+                    const guint32 *seqs,
+                    WaitForNlResponseResult *seq_results,
+                    guint from,
+                    guint to)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int nle;
+	guint i;
+
+	if (!*buf_len)
+		return;
+
+	nle = nl_sendto (priv->nlh, buf, *buf_len);
+	*buf_len = 0;
+	if (nle < 0) {
+		_LOGE ("route-batch: failure sending netlink requests \"%s\" (%d)",
+		       nl_geterror (nle), -nle);
+		return;
+	}
+
+	for (i = from; i < to; i++) {
+		if (seqs[i])
+			delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform, seqs[i], &seq_results[i]);
+	}
+}
+
+static void
+_route_batch_window (NMPlatform *platform, int addr_family, NMPlatformRouteBatchItem *items, guint n_items)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_free NMPObject *obj_ids = NULL;
+	guint32 seqs[ROUTE_BATCH_WINDOW] = { 0 };
+	WaitForNlResponseResult seq_results[ROUTE_BATCH_WINDOW] = { 0 };
+	gs_free guint8 *buf = NULL;
+	gsize buf_len = 0;
+	guint i, first_unsent = 0;
+	gboolean need_refetch = FALSE;
+	char s_buf[256];
+
+	nm_assert (n_items > 0 && n_items <= ROUTE_BATCH_WINDOW);
+
+	event_handler_read_netlink (platform, FALSE);
+
+	/* Send all requests of the window before reading any ACK. The messages
+	 * are copied into one buffer, so that a whole window usually goes out
+	 * with a single sendmsg() call. */
+	obj_ids = g_new (NMPObject, n_items);
+	buf = g_malloc (ROUTE_BATCH_SNDBUF);
+	for (i = 0; i < n_items; i++) {
+		nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+		struct nlmsghdr *nlh;
+		gsize len;
+
+		nlmsg = _route_batch_item_to_nlmsg (addr_family, &items[i], &obj_ids[i]);
+		if (!nlmsg)
+			continue;
+
+		nlh = nlmsg_hdr (nlmsg);
+		nlh->nlmsg_seq = priv->nlh_seq_next++ ?: priv->nlh_seq_next++;
+		nl_complete_msg (priv->nlh, nlmsg);
+
+		len = NLMSG_ALIGN (nlh->nlmsg_len);
+		if (buf_len + len > ROUTE_BATCH_SNDBUF) {
+			_route_batch_flush (platform, buf, &buf_len, seqs, seq_results, first_unsent, i);
+			first_unsent = i;
+		}
+
+		seqs[i] = nlh->nlmsg_seq;
+		memcpy (&buf[buf_len], nlh, nlh->nlmsg_len);
+		memset (&buf[buf_len + nlh->nlmsg_len], 0, len - nlh->nlmsg_len);
+		buf_len += len;
+	}
+	_route_batch_flush (platform, buf, &buf_len, seqs, seq_results, first_unsent, n_items);
+
+	delayed_action_handle_all (platform, FALSE);
+
+	/* like do_add_addrroute() and do_delete_object(), the cache must agree
+	 * with the result. If it doesn't for any item, refetch all routes once
+	 * for the whole window. */
+	for (i = 0; i < n_items; i++) {
+		const NMPObject *obj;
+
+		if (!seqs[i])
+			continue;
+		obj = nmp_cache_lookup_obj (priv->cache, &obj_ids[i]);
+		if (items[i].op == NM_PLATFORM_ROUTE_BATCH_ADD ? !obj : !!obj) {
+			need_refetch = TRUE;
+			break;
+		}
+	}
+	if (need_refetch)
+		do_request_one_type (platform, NMP_OBJECT_GET_TYPE (&obj_ids[0]));
+
+	for (i = 0; i < n_items; i++) {
+		NMPlatformRouteBatchItem *item = &items[i];
+		const char *log_detail = "";
+		gboolean success;
+
+		if (!seqs[i]) {
+			item->success = FALSE;
+			continue;
+		}
+
+		if (item->op == NM_PLATFORM_ROUTE_BATCH_ADD) {
+			success = seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
+			item->success =    success
+			                && nmp_cache_lookup_obj (priv->cache, &obj_ids[i]);
+		} else {
+			success = TRUE;
+			if (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
+				/* ok */
+			} else if (NM_IN_SET (-((int) seq_results[i]), ESRCH, ENOENT))
+				log_detail = ", meaning the object was already removed";
+			else
+				success = FALSE;
+			item->success = !nmp_cache_lookup_obj (priv->cache, &obj_ids[i]);
+		}
+
+		_NMLOG (success ? LOGL_DEBUG : LOGL_ERR,
+		        "do-%s-%s[%s]: %s%s",
+		        item->op == NM_PLATFORM_ROUTE_BATCH_ADD ? "add" : "delete",
+		        NMP_OBJECT_GET_CLASS (&obj_ids[i])->obj_type_name,
+		        nmp_object_to_string (&obj_ids[i], NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		        wait_for_nl_response_to_string (seq_results[i], s_buf, sizeof (s_buf)),
+		        log_detail);
+	}
+}
+
+static gboolean
+ip_route_batch (NMPlatform *platform, int addr_family, NMPlatformRouteBatchItem *items, guint n_items)
+{
+	gboolean success = TRUE;
+	guint i, n;
+
+	for (i = 0; i < n_items; i += n) {
+		if (_route_batch_item_is_single (addr_family, &items[i])) {
+			const NMPlatformIPXRoute *route = items[i].route;
+
+			items[i].success = ip4_route_delete (platform,
+			                                     items[i].ifindex > 0 ? items[i].ifindex : route->rx.ifindex,
+			                                     route->r4.network,
+			                                     route->rx.plen,
+			                                     route->rx.metric);
+			n = 1;
+			continue;
+		}
+
+		/* the operations must be applied in order. Cut the window short
+		 * before an item that cannot be batched. */
+		for (n = 1;
+		        n < ROUTE_BATCH_WINDOW
+		     && i + n < n_items
+		     && !_route_batch_item_is_single (addr_family, &items[i + n]);
+		     n++) {
+		}
+		_route_batch_window (platform, addr_family, &items[i], n);
+	}
+
+	for (i = 0; i < n_items; i++) {
+		if (!items[i].success)
+			success = FALSE;
+	}
+	return success;
+}
+
 static const NMPlatformIP4Route *
 ip4_route_get (NMPlatform *platform, int ifindex, in_addr_t network, int plen, guint32 metric)
 {
@@ -5582,83 +6414,274 @@ ip6_route_get (NMPlatform *platform, int ifindex, struct in6_addr network, int p
 #define ERROR_CONDITIONS      ((GIOCondition) (G_IO_ERR | G_IO_NVAL))
 #define DISCONNECT_CONDITIONS ((GIOCondition) (G_IO_HUP))
 
+/*****************************************************************************
+ * Shared event source
+ *
+ * Every NMLinuxPlatform instance has its own netlink socket, because the socket
+ * is bound to the network namespace in which it was created. But there is no
+ * need for every instance to install its own watch in the main context. Instead,
+ * all netlink sockets are registered with one epoll instance and only the epoll
+ * fd is watched. With hundreds of namespaces, that is still a single GSource
+ * and a single wakeup per main loop iteration.
+ *****************************************************************************/
+
+#define EVENT_MUX_MAX_EVENTS 64
+
+static struct {
+	int epoll_fd;
+	GIOChannel *channel;
+	guint event_id;
+
+	/* set of registered NMLinuxPlatform instances. */
+	GHashTable *platforms;
+
+	/* while set, the event source is kept even without instances. */
+	bool dispatching:1;
+} event_mux = {
+	.epoll_fd = -1,
+};
+
+static void
+event_mux_teardown (void)
+{
+	nm_assert (event_mux.platforms && g_hash_table_size (event_mux.platforms) == 0);
+	nm_assert (!event_mux.dispatching);
+
+	nm_clear_g_source (&event_mux.event_id);
+	g_clear_pointer (&event_mux.channel, g_io_channel_unref);
+	g_clear_pointer (&event_mux.platforms, g_hash_table_unref);
+	/* the channel closed the epoll fd. */
+	event_mux.epoll_fd = -1;
+}
+
 static gboolean
-event_handler (GIOChannel *channel,
-               GIOCondition io_condition,
-               gpointer user_data)
+event_mux_handler (GIOChannel *channel,
+                   GIOCondition io_condition,
+                   gpointer user_data)
 {
-	delayed_action_handle_all (NM_PLATFORM (user_data), TRUE);
+	struct epoll_event events[EVENT_MUX_MAX_EVENTS];
+	NMPlatform *ready[EVENT_MUX_MAX_EVENTS];
+	int n, n_ready, i;
+
+	n = epoll_wait (event_mux.epoll_fd, events, G_N_ELEMENTS (events), 0);
+	if (n < 0) {
+		int errsv = errno;
+
+		if (errsv != EINTR)
+			_LOG2E ("netlink: epoll_wait failed: %s (%d)", g_strerror (errsv), errsv);
+		return TRUE;
+	}
+
+	/* Keep the instances alive while dispatching. A handler can unregister any
+	 * other instance, also the last one, so the event source is only torn down
+	 * afterwards. */
+	n_ready = 0;
+	for (i = 0; i < n; i++) {
+		NMPlatform *platform = events[i].data.ptr;
+
+		if (g_hash_table_contains (event_mux.platforms, platform))
+			ready[n_ready++] = g_object_ref (platform);
+	}
+
+	event_mux.dispatching = TRUE;
+	for (i = 0; i < n_ready; i++) {
+		/* an earlier handler might have unregistered this instance. */
+		if (g_hash_table_contains (event_mux.platforms, ready[i]))
+			delayed_action_handle_all (ready[i], TRUE);
+	}
+	event_mux.dispatching = FALSE;
+
+	/* this can finalize instances and unregister them. */
+	for (i = 0; i < n_ready; i++)
+		g_object_unref (ready[i]);
+
+	if (   event_mux.platforms
+	    && g_hash_table_size (event_mux.platforms) == 0) {
+		event_mux_teardown ();
+		return G_SOURCE_REMOVE;
+	}
+	return event_mux.platforms != NULL;
+}
+
+static gboolean
+event_mux_register (NMPlatform *platform, int fd)
+{
+	struct epoll_event ev = {
+		.events = EPOLLIN | EPOLLPRI | EPOLLERR | EPOLLHUP,
+		.data.ptr = platform,
+	};
+
+	if (G_UNLIKELY (event_mux.epoll_fd < 0)) {
+		int channel_flags;
+
+		event_mux.epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+		if (event_mux.epoll_fd < 0) {
+			int errsv = errno;
+
+			_LOGE ("netlink: failed to create epoll instance: %s (%d)", g_strerror (errsv), errsv);
+			return FALSE;
+		}
+
+		event_mux.platforms = g_hash_table_new (NULL, NULL);
+
+		event_mux.channel = g_io_channel_unix_new (event_mux.epoll_fd);
+		g_io_channel_set_encoding (event_mux.channel, NULL, NULL);
+		g_io_channel_set_close_on_unref (event_mux.channel, TRUE);
+
+		channel_flags = g_io_channel_get_flags (event_mux.channel);
+		g_io_channel_set_flags (event_mux.channel,
+		                        channel_flags | G_IO_FLAG_NONBLOCK, NULL);
+		event_mux.event_id = g_io_add_watch (event_mux.channel,
+		                                     (EVENT_CONDITIONS | ERROR_CONDITIONS | DISCONNECT_CONDITIONS),
+		                                     event_mux_handler, NULL);
+	}
+
+	if (epoll_ctl (event_mux.epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+		int errsv = errno;
+
+		_LOGE ("netlink: failed to register socket %d for events: %s (%d)", fd, g_strerror (errsv), errsv);
+		return FALSE;
+	}
+
+	g_hash_table_add (event_mux.platforms, platform);
+	_LOGD ("netlink: registered socket %d for events (%u sockets in total)",
+	       fd, g_hash_table_size (event_mux.platforms));
 	return TRUE;
 }
 
+static void
+event_mux_unregister (NMPlatform *platform, int fd)
+{
+	if (   event_mux.epoll_fd < 0
+	    || !g_hash_table_remove (event_mux.platforms, platform))
+		return;
+
+	epoll_ctl (event_mux.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+
+	if (   g_hash_table_size (event_mux.platforms) == 0
+	    && !event_mux.dispatching)
+		event_mux_teardown ();
+}
+
 /*****************************************************************************/
 
-/* copied from libnl3's recvmsgs() */
 static int
-event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+_nl_recvmsg (int fd, struct msghdr *msg, int flags)
+{
+	ssize_t n;
+	int errsv;
+
+again:
+	n = recvmsg (fd, msg, flags);
+	if (n < 0) {
+		errsv = errno;
+		if (errsv == EINTR)
+			goto again;
+		if (errsv == EAGAIN) {
+			G_STATIC_ASSERT (EAGAIN == EWOULDBLOCK);
+			return -NLE_AGAIN;
+		}
+		if (errsv == ENOBUFS) {
+			/* we are very much interested in a overrun of the receive buffer.
+			 * Signal it with our own error code. */
+			return -_NLE_NM_NOBUFS;
+		}
+		return -nl_syserr2nlerr (errsv);
+	}
+	return n;
+}
+
+/* like libnl3's nl_recv() with NL_MSG_PEEK, but receives into the caller's
+ * buffer. The buffer is only reallocated if the next datagram doesn't fit. */
+static int
+_nl_recv (NMPlatform *platform, guint8 **buf, gsize *buf_size, struct ucred *out_creds, gboolean *out_has_creds)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	struct nl_sock *sk = priv->nlh;
+	int fd = nl_socket_get_fd (priv->nlh);
+	struct sockaddr_nl nla;
+	struct iovec iov = { };
+	union {
+		struct cmsghdr cmsg;
+		guint8 buf[CMSG_SPACE (sizeof (struct ucred))];
+	} cmsg_buf;
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+	};
+	struct cmsghdr *cmsg;
+	int n;
+
+	*out_has_creds = FALSE;
+
+	/* peek at the real size of the next datagram first. Usually it fits,
+	 * but a RTM_NEWLINK with many VFs or a dump with a large min_dump_alloc
+	 * can exceed NL_RECV_BUF_SIZE. */
+	n = _nl_recvmsg (fd, &msg, MSG_PEEK | MSG_TRUNC);
+	if (n < 0)
+		return n;
+
+	if ((gsize) n > *buf_size) {
+		_LOGD ("netlink: recvmsg: grow receive buffer from %zu to %d bytes", *buf_size, n);
+		g_free (*buf);
+		*buf_size = n;
+		*buf = g_malloc (*buf_size);
+	}
+
+	iov.iov_base = *buf;
+	iov.iov_len = *buf_size;
+	msg.msg_name = &nla;
+	msg.msg_namelen = sizeof (nla);
+	msg.msg_control = &cmsg_buf;
+	msg.msg_controllen = sizeof (cmsg_buf);
+
+	n = _nl_recvmsg (fd, &msg, 0);
+	if (n < 0)
+		return n;
+
+	if (NM_FLAGS_HAS (msg.msg_flags, MSG_TRUNC)) {
+		/* the rest of the datagram is lost. Handle it like an overrun,
+		 * so that the cache gets resynchronized. */
+		_LOGW ("netlink: recvmsg: message truncated to %zu bytes", *buf_size);
+		return -_NLE_NM_NOBUFS;
+	}
+
+	for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+		if (   cmsg->cmsg_level == SOL_SOCKET
+		    && cmsg->cmsg_type == SCM_CREDENTIALS) {
+			memcpy (out_creds, CMSG_DATA (cmsg), sizeof (*out_creds));
+			*out_has_creds = TRUE;
+			break;
+		}
+	}
+
+	return n;
+}
+
+/* copied from libnl3's recvmsgs() */
+static int
+_event_handler_recvmsgs (NMPlatform *platform, guint8 **buf, gsize *buf_size, gboolean handle_events)
+{
 	int n, err = 0, multipart = 0, interrupted = 0;
 	struct nlmsghdr *hdr;
 	WaitForNlResponseResult seq_result;
-
-	/*
-	nla is passed on to not only to nl_recv() but may also be passed
-	to a function pointer provided by the caller which may or may not
-	initialize the variable. Thomas Graf.
-	*/
-	struct sockaddr_nl nla = {0};
-	nm_auto_free struct ucred *creds = NULL;
-	nm_auto_free unsigned char *buf = NULL;
+	struct ucred creds;
+	gboolean has_creds;
 
 continue_reading:
-	g_clear_pointer (&buf, free);
-	g_clear_pointer (&creds, free);
-	errno = 0;
-	n = nl_recv (sk, &nla, &buf, &creds);
-
-	switch (n) {
-	case 0:
-		/* Work around a libnl bug fixed in 3.2.22 (375a6294) */
-		if (errno == EAGAIN) {
-			/* EAGAIN is equal to EWOULDBLOCK. If it would not be, we'd have to
-			 * workaround libnl3 mapping EWOULDBLOCK to -NLE_FAILURE. */
-			G_STATIC_ASSERT (EAGAIN == EWOULDBLOCK);
-			n = -NLE_AGAIN;
-		}
-		break;
-	case -NLE_NOMEM:
-		if (errno == ENOBUFS) {
-			/* we are very much interested in a overrun of the receive buffer.
-			 * nl_recv() maps all kinds of errors to NLE_NOMEM, so check also
-			 * for errno explicitly. And if so, hack our own return code to signal
-			 * the overrun. */
-			n = -_NLE_NM_NOBUFS;
-		}
-		break;
-	}
+	n = _nl_recv (platform, buf, buf_size, &creds, &has_creds);
 
 	if (n <= 0)
 		return n;
 
-	hdr = (struct nlmsghdr *) buf;
+	/* the messages are parsed in place. Nothing may keep a reference to
+	 * @buf, it is overwritten by the next read. */
+	hdr = (struct nlmsghdr *) *buf;
 	while (nlmsg_ok (hdr, n)) {
-		nm_auto_nlmsg struct nl_msg *msg = NULL;
 		gboolean abort_parsing = FALSE;
 
-		msg = nlmsg_convert (hdr);
-		if (!msg) {
-			err = -NLE_NOMEM;
-			goto out;
-		}
-
-		nlmsg_set_proto (msg, NETLINK_ROUTE);
-		nlmsg_set_src (msg, &nla);
-
-		if (!creds || creds->pid) {
-			if (creds)
-				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds->pid);
+		if (!has_creds || creds.pid) {
+			if (has_creds)
+				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds.pid);
 			else
 				_LOGT ("netlink: recvmsg: received message without credentials");
 			err = 0;
@@ -5668,9 +6691,6 @@ continue_reading:
 		_LOGt ("netlink: recvmsg: new message type %d, seq %u",
 		       hdr->nlmsg_type, hdr->nlmsg_seq);
 
-		if (creds)
-			nlmsg_set_creds (msg, creds);
-
 		if (hdr->nlmsg_flags & NLM_F_MULTI)
 			multipart = 1;
 
@@ -5726,7 +6746,7 @@ continue_reading:
 				_LOGD ("netlink: recvmsg: error message from kernel: %s (%d) for request %d",
 				       strerror (errsv),
 				       errsv,
-				       nlmsg_hdr (msg)->nlmsg_seq);
+				       hdr->nlmsg_seq);
 				seq_result = -errsv;
 			} else
 				seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
@@ -5735,12 +6755,12 @@ continue_reading:
 			 * get along with broken kernels. NL_SKIP has no
 			 * effect on this.  */
 
-			event_valid_msg (platform, msg, handle_events);
+			event_valid_msg (platform, hdr, handle_events);
 
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		}
 
-		event_seq_check (platform, msg, seq_result);
+		event_seq_check (platform, hdr, seq_result);
 
 		if (abort_parsing)
 			goto stop;
@@ -5760,18 +6780,131 @@ stop:
 		 * Repeat reading. */
 		goto continue_reading;
 	}
-out:
 	if (interrupted)
 		err = -NLE_DUMP_INTR;
 	return err;
 }
 
+static int
+event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_free guint8 *buf_free = NULL;
+	gsize buf_free_size = 0;
+	guint8 **buf;
+	gsize *buf_size;
+	int err;
+
+	if (priv->recv.depth < G_N_ELEMENTS (priv->recv.bufs)) {
+		buf = &priv->recv.bufs[priv->recv.depth];
+		buf_size = &priv->recv.buf_sizes[priv->recv.depth];
+	} else {
+		buf = &buf_free;
+		buf_size = &buf_free_size;
+	}
+
+	if (!*buf) {
+		*buf_size = NL_RECV_BUF_SIZE;
+		*buf = g_malloc (*buf_size);
+	}
+
+	priv->recv.depth++;
+	err = _event_handler_recvmsgs (platform, buf, buf_size, handle_events);
+	priv->recv.depth--;
+	return err;
+}
+
 /*****************************************************************************/
 
+#define OVERRUN_WINDOW_NS         NM_UTILS_NS_PER_SECOND
+#define OVERRUN_RESYNC_DELAY_MS   1000
+#define OVERRUN_RCVBUF_MAX        (64*1024*1024)
+
+static void
+_overrun_track_window (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gint64 now_ns = nm_utils_get_monotonic_timestamp_ns ();
+
+	if (now_ns - priv->overrun.window_start_ns > OVERRUN_WINDOW_NS) {
+		/* remember which object types saw activity in the last two windows. */
+		priv->overrun.active_types_prev = priv->overrun.active_types;
+		priv->overrun.active_types = DELAYED_ACTION_TYPE_NONE;
+		priv->overrun.window_start_ns = now_ns;
+	}
+}
+
+static void
+_overrun_grow_rcvbuf (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int size, nle;
+
+	if (priv->overrun.rcvbuf_size >= OVERRUN_RCVBUF_MAX)
+		return;
+
+	size = MIN (priv->overrun.rcvbuf_size * 2, OVERRUN_RCVBUF_MAX);
+
+	/* SO_RCVBUFFORCE ignores rmem_max, but requires CAP_NET_ADMIN. */
+	if (setsockopt (nl_socket_get_fd (priv->nlh), SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof (size)) < 0) {
+		nle = nl_socket_set_buffer_size (priv->nlh, size, 0);
+		if (nle < 0) {
+			_LOGD ("netlink: failed to grow socket receive buffer to %d: %s (%d)", size, nl_geterror (nle), nle);
+			return;
+		}
+	}
+
+	_LOGD ("netlink: grow socket receive buffer to %d", size);
+	priv->overrun.rcvbuf_size = size;
+}
+
 static gboolean
-event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
+_overrun_deferred_resync_cb (gpointer user_data)
+{
+	NMPlatform *platform = user_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType types = priv->overrun.deferred_types;
+
+	priv->overrun.deferred_id = 0;
+	priv->overrun.deferred_types = DELAYED_ACTION_TYPE_NONE;
+
+	_LOGD ("netlink: resynchronize remaining object types after overrun");
+	delayed_action_schedule (platform, types, NULL);
+	delayed_action_handle_all (platform, FALSE);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_overrun_handle (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType affected;
+
+	_overrun_grow_rcvbuf (platform);
+
+	/* Events of any type may be lost, but usually the overrun is caused by a flood
+	 * of one or two types (typically routes). Resync them right away and postpone
+	 * dumping the other types, so that the dumps themselves do not overrun the
+	 * socket again. */
+	affected = (priv->overrun.active_types | priv->overrun.active_types_prev) & DELAYED_ACTION_TYPE_REFRESH_ALL;
+	if (!affected)
+		affected = DELAYED_ACTION_TYPE_REFRESH_ALL;
+
+	_LOGI ("netlink: read: too many netlink events. Need to resynchronize platform cache");
+
+	event_handler_recvmsgs (platform, FALSE);
+	delayed_action_wait_for_nl_response_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
+	delayed_action_schedule (platform, affected, NULL);
+
+	priv->overrun.deferred_types |= (DelayedActionType) (DELAYED_ACTION_TYPE_REFRESH_ALL & ~affected);
+	priv->overrun.deferred_types &= ~affected;
+	if (priv->overrun.deferred_types && !priv->overrun.deferred_id)
+		priv->overrun.deferred_id = g_timeout_add (OVERRUN_RESYNC_DELAY_MS, _overrun_deferred_resync_cb, platform);
+}
+
+static gboolean
+_event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	int r, nle;
 	struct pollfd pfd;
@@ -5784,8 +6917,7 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 		gint64 timeout_abs_ns;
 	} data_next;
 
-	if (!nm_platform_netns_push (platform, &netns))
-		return FALSE;
+	_overrun_track_window (platform);
 
 	while (TRUE) {
 
@@ -5801,16 +6933,7 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					_LOGD ("netlink: read: uncritical failure to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
 					break;
 				case -_NLE_NM_NOBUFS:
-					_LOGI ("netlink: read: too many netlink events. Need to resynchronize platform cache");
-					event_handler_recvmsgs (platform, FALSE);
-					delayed_action_wait_for_nl_response_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
-					delayed_action_schedule (platform,
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
-					                         NULL);
+					_overrun_handle (platform);
 					break;
 				default:
 					_LOGE ("netlink: read: failed to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
@@ -5880,6 +7003,18 @@ after_read:
 	}
 }
 
+static gboolean
+event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
+{
+	gboolean any;
+
+	/* the netns is only entered if some event actually needs it. */
+	_netns_lazy_scope_enter (platform);
+	any = _event_handler_read_netlink (platform, wait_for_acks);
+	_netns_lazy_scope_leave (platform);
+	return any;
+}
+
 /******************************************************************/
 
 static void
@@ -5998,6 +7133,21 @@ handle_udev_event (GUdevClient *client,
 
 /******************************************************************/
 
+/* All instances that use udev share one client. Only the initial namespace
+ * uses udev, but there can be several instances in it. */
+static GUdevClient *
+_udev_client_ref (void)
+{
+	static GUdevClient *udev_client;
+
+	if (udev_client)
+		return g_object_ref (udev_client);
+
+	udev_client = g_udev_client_new ((const char *[]) { "net", NULL });
+	g_object_add_weak_pointer (G_OBJECT (udev_client), (gpointer *) &udev_client);
+	return udev_client;
+}
+
 static void
 nm_linux_platform_init (NMLinuxPlatform *self)
 {
@@ -6014,10 +7164,9 @@ nm_linux_platform_init (NMLinuxPlatform *self)
 	priv->delayed_action.list_master_connected = g_ptr_array_new ();
 	priv->delayed_action.list_refresh_link = g_ptr_array_new ();
 	priv->delayed_action.list_wait_for_nl_response = g_array_new (FALSE, TRUE, sizeof (DelayedActionWaitForNlResponseData));
-	priv->wifi_data = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) wifi_utils_deinit);
 
 	if (use_udev)
-		priv->udev_client = g_udev_client_new ((const char *[]) { "net", NULL });
+		priv->udev_client = _udev_client_ref ();
 }
 
 static void
@@ -6025,8 +7174,6 @@ constructed (GObject *_object)
 {
 	NMPlatform *platform = NM_PLATFORM (_object);
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	int channel_flags;
-	gboolean status;
 	int nle;
 
 	nm_assert (!platform->_netns || platform->_netns == nmp_netns_get_current ());
@@ -6054,8 +7201,10 @@ constructed (GObject *_object)
 	nle = nl_socket_set_nonblocking (priv->nlh);
 	g_assert (!nle);
 
-	/* use 8 MB for receive socket kernel queue. */
-	nle = nl_socket_set_buffer_size (priv->nlh, 8*1024*1024, 0);
+	/* use 8 MB for receive socket kernel queue. On overruns it grows
+	 * up to OVERRUN_RCVBUF_MAX. */
+	priv->overrun.rcvbuf_size = 8*1024*1024;
+	nle = nl_socket_set_buffer_size (priv->nlh, priv->overrun.rcvbuf_size, 0);
 	g_assert (!nle);
 
 	nle = nl_socket_add_memberships (priv->nlh,
@@ -6066,17 +7215,8 @@ constructed (GObject *_object)
 	g_assert (!nle);
 	_LOGD ("Netlink socket for events established: port=%u, fd=%d", nl_socket_get_local_port (priv->nlh), nl_socket_get_fd (priv->nlh));
 
-	priv->event_channel = g_io_channel_unix_new (nl_socket_get_fd (priv->nlh));
-	g_io_channel_set_encoding (priv->event_channel, NULL, NULL);
-	g_io_channel_set_close_on_unref (priv->event_channel, TRUE);
-
-	channel_flags = g_io_channel_get_flags (priv->event_channel);
-	status = g_io_channel_set_flags (priv->event_channel,
-	                                 channel_flags | G_IO_FLAG_NONBLOCK, NULL);
-	g_assert (status);
-	priv->event_id = g_io_add_watch (priv->event_channel,
-	                                (EVENT_CONDITIONS | ERROR_CONDITIONS | DISCONNECT_CONDITIONS),
-	                                 event_handler, platform);
+	priv->event_registered = event_mux_register (platform, nl_socket_get_fd (priv->nlh));
+	g_assert (priv->event_registered);
 
 	/* complete construction of the GObject instance before populating the cache. */
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->constructed (_object);
@@ -6090,7 +7230,12 @@ constructed (GObject *_object)
 	                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
 	                         NULL);
 
-	delayed_action_handle_all (platform, FALSE);
+	if (priv->defer_populate) {
+		/* only one dump can be in progress per netlink socket. Send the
+		 * first one and leave the rest to the next time we process events. */
+		do_request_all_no_delayed_actions (platform, DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS);
+	} else
+		delayed_action_handle_all (platform, FALSE);
 
 	/* Set up udev monitoring */
 	if (priv->udev_client) {
@@ -6115,6 +7260,62 @@ constructed (GObject *_object)
 	}
 }
 
+static void
+_ignore_rtprot_set (NMPlatform *platform, const char *str)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_strfreev char **strv = NULL;
+	char **iter;
+	int rtprot;
+
+	g_clear_pointer (&priv->ignore_rtprot, g_free);
+	if (!str)
+		return;
+
+	strv = g_strsplit_set (str, ", \t", -1);
+	for (iter = strv; *iter; iter++) {
+		if (!**iter)
+			continue;
+
+		rtprot = _rtprot_from_string (*iter);
+		if (rtprot < 0) {
+			_LOGW ("ignore-route-protocols: invalid route protocol '%s'", *iter);
+			continue;
+		}
+		if (NM_IN_SET (rtprot, RTPROT_UNSPEC, RTPROT_REDIRECT, RTPROT_KERNEL, RTPROT_STATIC, RTPROT_RA, RTPROT_DHCP)) {
+			/* we configure routes with these protocols ourself, they must be cached. */
+			_LOGW ("ignore-route-protocols: cannot ignore route protocol '%s'", *iter);
+			continue;
+		}
+
+		if (!priv->ignore_rtprot)
+			priv->ignore_rtprot = g_new0 (guint8, 256 / 8);
+		priv->ignore_rtprot[rtprot / 8] |= (1 << (rtprot % 8));
+		_LOGD ("ignore-route-protocols: don't cache routes with protocol %d", rtprot);
+	}
+}
+
+static void
+set_property (GObject *object, guint prop_id,
+              const GValue *value, GParamSpec *pspec)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (object);
+
+	switch (prop_id) {
+	case PROP_DEFER_POPULATE:
+		/* construct-only */
+		priv->defer_populate = g_value_get_boolean (value);
+		break;
+	case PROP_IGNORE_ROUTE_PROTOCOLS:
+		/* construct-only */
+		_ignore_rtprot_set (NM_PLATFORM (object), g_value_get_string (value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
 static void
 dispose (GObject *object)
 {
@@ -6129,6 +7330,9 @@ dispose (GObject *object)
 	g_ptr_array_set_size (priv->delayed_action.list_master_connected, 0);
 	g_ptr_array_set_size (priv->delayed_action.list_refresh_link, 0);
 
+	nm_clear_g_source (&priv->overrun.deferred_id);
+	priv->overrun.deferred_types = DELAYED_ACTION_TYPE_NONE;
+
 	g_clear_pointer (&priv->prune_candidates, g_hash_table_unref);
 
 	if (priv->udev_client) {
@@ -6143,6 +7347,7 @@ static void
 nm_linux_platform_finalize (GObject *object)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (object);
+	guint i;
 
 	nmp_cache_free (priv->cache);
 
@@ -6151,17 +7356,24 @@ nm_linux_platform_finalize (GObject *object)
 	g_array_unref (priv->delayed_action.list_wait_for_nl_response);
 
 	/* Free netlink resources */
-	g_source_remove (priv->event_id);
-	g_io_channel_unref (priv->event_channel);
+	if (priv->event_registered)
+		event_mux_unregister (NM_PLATFORM (object), nl_socket_get_fd (priv->nlh));
 	nl_socket_free (priv->nlh);
 
-	g_hash_table_unref (priv->wifi_data);
+	for (i = 0; i < G_N_ELEMENTS (priv->recv.bufs); i++)
+		g_free (priv->recv.bufs[i]);
+	g_free (priv->ignore_rtprot);
+
+	if (priv->wifi_data)
+		g_hash_table_unref (priv->wifi_data);
 
 	if (priv->sysctl_get_prev_values) {
 		sysctl_clear_cache_list = g_slist_remove (sysctl_clear_cache_list, object);
 		g_hash_table_destroy (priv->sysctl_get_prev_values);
 	}
 
+	_sysctl_fds_clear (NM_PLATFORM (object));
+
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->finalize (object);
 }
 
@@ -6176,10 +7388,25 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	g_type_class_add_private (klass, sizeof (NMLinuxPlatformPrivate));
 
 	/* virtual methods */
+	object_class->set_property = set_property;
 	object_class->constructed = constructed;
 	object_class->dispose = dispose;
 	object_class->finalize = nm_linux_platform_finalize;
 
+	obj_properties[PROP_DEFER_POPULATE] =
+	    g_param_spec_boolean (NM_LINUX_PLATFORM_DEFER_POPULATE, "", "",
+	                          FALSE,
+	                          G_PARAM_WRITABLE |
+	                          G_PARAM_CONSTRUCT_ONLY |
+	                          G_PARAM_STATIC_STRINGS);
+	obj_properties[PROP_IGNORE_ROUTE_PROTOCOLS] =
+	    g_param_spec_string (NM_LINUX_PLATFORM_IGNORE_ROUTE_PROTOCOLS, "", "",
+	                         NULL,
+	                         G_PARAM_WRITABLE |
+	                         G_PARAM_CONSTRUCT_ONLY |
+	                         G_PARAM_STATIC_STRINGS);
+	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
+
 	platform_class->sysctl_set = sysctl_set;
 	platform_class->sysctl_get = sysctl_get;
 
@@ -6269,6 +7496,7 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->ip6_route_add = ip6_route_add;
 	platform_class->ip4_route_delete = ip4_route_delete;
 	platform_class->ip6_route_delete = ip6_route_delete;
+	platform_class->ip_route_batch = ip_route_batch;
 
 	platform_class->check_support_kernel_extended_ifa_flags = check_support_kernel_extended_ifa_flags;
 	platform_class->check_support_user_ipv6ll = check_support_user_ipv6ll;
@@ -32,6 +32,11 @@
 
 /******************************************************************/
 
+#define NM_LINUX_PLATFORM_DEFER_POPULATE "defer-populate"
+#define NM_LINUX_PLATFORM_IGNORE_ROUTE_PROTOCOLS "ignore-route-protocols"
+
+/******************************************************************/
+
 struct _NMLinuxPlatformPrivate;
 
 typedef struct {
@@ -49,7 +54,9 @@ typedef struct {
 GType nm_linux_platform_get_type (void);
 
 void nm_linux_platform_setup (void);
+void nm_linux_platform_setup_full (const char *ignore_route_protocols);
 
 NMPlatform *nm_linux_platform_new (void);
+NMPlatform *nm_linux_platform_new_deferred (void);
 
 #endif /* __NETWORKMANAGER_LINUX_PLATFORM_H__ */
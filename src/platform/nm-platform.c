@@ -93,8 +93,23 @@ enum {
 	LAST_PROP,
 };
 
+struct _NMPlatformIfindexWatch {
+	NMPlatformIfindexWatchFunc callback;
+	gpointer user_data;
+	int ifindex;
+};
+
 typedef struct {
 	gboolean register_singleton;
+
+	/* ifindex -> GPtrArray of NMPlatformIfindexWatch. While dispatching,
+	 * removed watches only leave a NULL slot behind that gets compacted
+	 * afterwards. */
+	GHashTable *ifindex_watches;
+	guint ifindex_watches_num;
+	guint ifindex_watches_dispatching;
+	bool ifindex_watches_dirty:1;
+	guint64 ifindex_watches_avoided;
 } NMPlatformPrivate;
 
 /******************************************************************/
@@ -2919,6 +2934,63 @@ nm_platform_ip6_route_delete (NMPlatform *self, int ifindex, struct in6_addr net
 	return klass->ip6_route_delete (self, ifindex, network, plen, metric);
 }
 
+static gboolean
+_route_batch (NMPlatform *self, const NMPlatformVTableRoute *vtable, NMPlatformRouteBatchItem *items, guint n_items)
+{
+	gboolean success = TRUE;
+	guint i;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (items || !n_items, FALSE);
+
+	if (!n_items)
+		return TRUE;
+
+	_LOGD ("route: processing batch of %u IPv%c route operations",
+	       n_items, vtable->is_ip4 ? '4' : '6');
+
+	if (klass->ip_route_batch)
+		return klass->ip_route_batch (self, vtable->addr_family, items, n_items);
+
+	for (i = 0; i < n_items; i++) {
+		NMPlatformRouteBatchItem *item = &items[i];
+
+		if (item->op == NM_PLATFORM_ROUTE_BATCH_ADD)
+			item->success = vtable->route_add (self, item->ifindex, item->route, item->metric);
+		else
+			item->success = vtable->route_delete (self, item->ifindex, item->route);
+		if (!item->success)
+			success = FALSE;
+	}
+	return success;
+}
+
+/**
+ * nm_platform_ip4_route_batch:
+ * @self: the #NMPlatform
+ * @items: (array length=n_items): the operations to perform
+ * @n_items: the number of @items
+ *
+ * Adds and deletes several IPv4 routes in order. Unlike calling
+ * nm_platform_ip4_route_add() repeatedly, the implementation may send
+ * the requests without waiting for each reply in between.
+ * The result of each operation is stored in its @success field.
+ *
+ * Returns: %TRUE if all operations succeeded.
+ */
+gboolean
+nm_platform_ip4_route_batch (NMPlatform *self, NMPlatformRouteBatchItem *items, guint n_items)
+{
+	return _route_batch (self, &nm_platform_vtable_route_v4, items, n_items);
+}
+
+gboolean
+nm_platform_ip6_route_batch (NMPlatform *self, NMPlatformRouteBatchItem *items, guint n_items)
+{
+	return _route_batch (self, &nm_platform_vtable_route_v6, items, n_items);
+}
+
 const NMPlatformIP4Route *
 nm_platform_ip4_route_get (NMPlatform *self, int ifindex, in_addr_t network, int plen, guint32 metric)
 {
@@ -4023,35 +4095,236 @@ nm_platform_signal_change_type_to_string (NMPlatformSignalChangeType change_type
 	}
 }
 
+/******************************************************************/
+
+static void
+_ifindex_watch_link (NMPlatformPrivate *priv, NMPlatformIfindexWatch *watch)
+{
+	GPtrArray *watches;
+
+	if (watch->ifindex <= 0)
+		return;
+
+	if (!priv->ifindex_watches)
+		priv->ifindex_watches = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+
+	watches = g_hash_table_lookup (priv->ifindex_watches, GINT_TO_POINTER (watch->ifindex));
+	if (!watches) {
+		watches = g_ptr_array_new ();
+		g_hash_table_insert (priv->ifindex_watches, GINT_TO_POINTER (watch->ifindex), watches);
+	}
+	g_ptr_array_add (watches, watch);
+	priv->ifindex_watches_num++;
+}
+
+static void
+_ifindex_watch_unlink (NMPlatformPrivate *priv, NMPlatformIfindexWatch *watch)
+{
+	GPtrArray *watches;
+	guint i;
+
+	if (watch->ifindex <= 0)
+		return;
+
+	watches = g_hash_table_lookup (priv->ifindex_watches, GINT_TO_POINTER (watch->ifindex));
+	g_return_if_fail (watches);
+
+	priv->ifindex_watches_num--;
+
+	if (priv->ifindex_watches_dispatching) {
+		for (i = 0; i < watches->len; i++) {
+			if (watches->pdata[i] == watch) {
+				watches->pdata[i] = NULL;
+				break;
+			}
+		}
+		priv->ifindex_watches_dirty = TRUE;
+		return;
+	}
+
+	g_ptr_array_remove (watches, watch);
+	if (watches->len == 0)
+		g_hash_table_remove (priv->ifindex_watches, GINT_TO_POINTER (watch->ifindex));
+}
+
+static void
+_ifindex_watch_compact (NMPlatformPrivate *priv)
+{
+	GHashTableIter iter;
+	GPtrArray *watches;
+
+	g_hash_table_iter_init (&iter, priv->ifindex_watches);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &watches)) {
+		while (g_ptr_array_remove (watches, NULL))
+			;
+		if (watches->len == 0)
+			g_hash_table_iter_remove (&iter);
+	}
+}
+
+static void
+_ifindex_watch_dispatch (NMPlatform *self,
+                         NMPObjectType obj_type,
+                         int ifindex,
+                         gconstpointer platform_object,
+                         NMPlatformSignalChangeType change_type)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	GPtrArray *watches;
+	guint i, len, n_total, n_called = 0;
+
+	n_total = priv->ifindex_watches_num;
+	if (!n_total)
+		return;
+
+	watches = ifindex > 0
+	          ? g_hash_table_lookup (priv->ifindex_watches, GINT_TO_POINTER (ifindex))
+	          : NULL;
+	if (watches) {
+		priv->ifindex_watches_dispatching++;
+
+		/* watches added during dispatching are not called for this event. */
+		len = watches->len;
+		for (i = 0; i < len; i++) {
+			NMPlatformIfindexWatch *watch = watches->pdata[i];
+
+			if (!watch)
+				continue;
+			watch->callback (self, obj_type, ifindex, platform_object, change_type, watch->user_data);
+			n_called++;
+		}
+
+		if (   --priv->ifindex_watches_dispatching == 0
+		    && priv->ifindex_watches_dirty) {
+			priv->ifindex_watches_dirty = FALSE;
+			_ifindex_watch_compact (priv);
+		}
+	}
+
+	/* with a plain signal handler, every watcher would have been called. */
+	priv->ifindex_watches_avoided += n_total - MIN (n_called, n_total);
+}
+
+/**
+ * nm_platform_ifindex_watch_add:
+ * @self: the #NMPlatform
+ * @ifindex: the interface to watch. Values <= 0 create an inactive
+ *   watch, that can be activated later with nm_platform_ifindex_watch_set_ifindex().
+ * @callback: called for every link, address or route change on @ifindex
+ * @user_data: passed to @callback
+ *
+ * Like connecting to the platform signals, but @callback is only invoked
+ * for objects of @ifindex. Subscribers that only care about one interface
+ * should use this instead of connecting to the signals and ignoring
+ * other interfaces, which wakes up every subscriber for every event.
+ *
+ * Returns: the watch handle. Release it with nm_platform_ifindex_watch_remove().
+ */
+NMPlatformIfindexWatch *
+nm_platform_ifindex_watch_add (NMPlatform *self,
+                               int ifindex,
+                               NMPlatformIfindexWatchFunc callback,
+                               gpointer user_data)
+{
+	NMPlatformIfindexWatch *watch;
+
+	g_return_val_if_fail (NM_IS_PLATFORM (self), NULL);
+	g_return_val_if_fail (callback, NULL);
+
+	watch = g_slice_new (NMPlatformIfindexWatch);
+	watch->callback = callback;
+	watch->user_data = user_data;
+	watch->ifindex = ifindex;
+	_ifindex_watch_link (NM_PLATFORM_GET_PRIVATE (self), watch);
+	return watch;
+}
+
+void
+nm_platform_ifindex_watch_set_ifindex (NMPlatform *self,
+                                       NMPlatformIfindexWatch *watch,
+                                       int ifindex)
+{
+	NMPlatformPrivate *priv;
+
+	g_return_if_fail (NM_IS_PLATFORM (self));
+	g_return_if_fail (watch);
+
+	if (ifindex <= 0)
+		ifindex = 0;
+	if (watch->ifindex == ifindex)
+		return;
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+	_ifindex_watch_unlink (priv, watch);
+	watch->ifindex = ifindex;
+	_ifindex_watch_link (priv, watch);
+}
+
+void
+nm_platform_ifindex_watch_remove (NMPlatform *self,
+                                  NMPlatformIfindexWatch *watch)
+{
+	g_return_if_fail (NM_IS_PLATFORM (self));
+	g_return_if_fail (watch);
+
+	_ifindex_watch_unlink (NM_PLATFORM_GET_PRIVATE (self), watch);
+	g_slice_free (NMPlatformIfindexWatch, watch);
+}
+
+/**
+ * nm_platform_ifindex_watch_get_num_avoided:
+ * @self: the #NMPlatform
+ *
+ * Returns: how many callback invocations were saved so far, compared to
+ *   notifying every watch about every event.
+ */
+guint64
+nm_platform_ifindex_watch_get_num_avoided (NMPlatform *self)
+{
+	g_return_val_if_fail (NM_IS_PLATFORM (self), 0);
+
+	return NM_PLATFORM_GET_PRIVATE (self)->ifindex_watches_avoided;
+}
+
+/******************************************************************/
+
+/* The class handlers of the platform signals. They run before other
+ * handlers and also dispatch the event to the ifindex watches. */
+
 static void
 log_link (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformLink *device, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 
 	_LOGD ("signal: link %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_link_to_string (device, NULL, 0));
+	_ifindex_watch_dispatch (self, obj_type, ifindex, device, change_type);
 }
 
 static void
 log_ip4_address (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP4Address *address, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: address 4 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip4_address_to_string (address, NULL, 0));
+	_ifindex_watch_dispatch (self, obj_type, ifindex, address, change_type);
 }
 
 static void
 log_ip6_address (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP6Address *address, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: address 6 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip6_address_to_string (address, NULL, 0));
+	_ifindex_watch_dispatch (self, obj_type, ifindex, address, change_type);
 }
 
 static void
 log_ip4_route (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP4Route *route, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: route   4 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip4_route_to_string (route, NULL, 0));
+	_ifindex_watch_dispatch (self, obj_type, ifindex, route, change_type);
 }
 
 static void
 log_ip6_route (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP6Route *route, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: route   6 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip6_route_to_string (route, NULL, 0));
+	_ifindex_watch_dispatch (self, obj_type, ifindex, route, change_type);
 }
 
 /******************************************************************/
@@ -4158,6 +4431,7 @@ const NMPlatformVTableRoute nm_platform_vtable_route_v4 = {
 	.route_add                      = _vtr_v4_route_add,
 	.route_delete                   = _vtr_v4_route_delete,
 	.route_delete_default           = _vtr_v4_route_delete_default,
+	.route_batch                    = nm_platform_ip4_route_batch,
 	.metric_normalize               = _vtr_v4_metric_normalize,
 };
 
@@ -4171,6 +4445,7 @@ const NMPlatformVTableRoute nm_platform_vtable_route_v6 = {
 	.route_add                      = _vtr_v6_route_add,
 	.route_delete                   = _vtr_v6_route_delete,
 	.route_delete_default           = _vtr_v6_route_delete_default,
+	.route_batch                    = nm_platform_ip6_route_batch,
 	.metric_normalize               = nm_utils_ip6_route_metric_normalize,
 };
 
@@ -4225,8 +4500,14 @@ static void
 finalize (GObject *object)
 {
 	NMPlatform *self = NM_PLATFORM (object);
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
 
 	g_clear_object (&self->_netns);
+
+	if (priv->ifindex_watches)
+		g_hash_table_unref (priv->ifindex_watches);
+
+	G_OBJECT_CLASS (nm_platform_parent_class)->finalize (object);
 }
 
 static void
@@ -350,6 +350,25 @@ typedef union {
 #undef __NMPlatformObject_COMMON
 
 
+typedef enum {
+	NM_PLATFORM_ROUTE_BATCH_ADD,
+	NM_PLATFORM_ROUTE_BATCH_DELETE,
+} NMPlatformRouteBatchOp;
+
+/* One operation of nm_platform_ip4_route_batch()/nm_platform_ip6_route_batch().
+ * @ifindex, @route and @metric have the same meaning as for the route_add()
+ * and route_delete() functions of #NMPlatformVTableRoute. @metric is ignored
+ * for deleting. */
+typedef struct {
+	NMPlatformRouteBatchOp op;
+	int ifindex;
+	const NMPlatformIPXRoute *route;
+	gint64 metric;
+
+	/* out: whether the operation succeeded. */
+	gboolean success;
+} NMPlatformRouteBatchItem;
+
 typedef struct {
 	gboolean is_ip4;
 	int addr_family;
@@ -360,6 +379,7 @@ typedef struct {
 	gboolean (*route_add) (NMPlatform *self, int ifindex, const NMPlatformIPXRoute *route, gint64 metric);
 	gboolean (*route_delete) (NMPlatform *self, int ifindex, const NMPlatformIPXRoute *route);
 	gboolean (*route_delete_default) (NMPlatform *self, int ifindex, guint32 metric);
+	gboolean (*route_batch) (NMPlatform *self, NMPlatformRouteBatchItem *items, guint n_items);
 	guint32 (*metric_normalize) (guint32 metric);
 } NMPlatformVTableRoute;
 
@@ -459,6 +479,15 @@ typedef struct {
 	bool multi_queue:1;
 } NMPlatformTunProperties;
 
+typedef struct _NMPlatformIfindexWatch NMPlatformIfindexWatch;
+
+typedef void (*NMPlatformIfindexWatchFunc) (NMPlatform *platform,
+                                            NMPObjectType obj_type,
+                                            int ifindex,
+                                            gconstpointer platform_object,
+                                            NMPlatformSignalChangeType change_type,
+                                            gpointer user_data);
+
 /******************************************************************/
 
 struct _NMPlatform {
@@ -620,6 +649,7 @@ typedef struct {
 	                           guint32 metric, guint32 mss);
 	gboolean (*ip4_route_delete) (NMPlatform *, int ifindex, in_addr_t network, int plen, guint32 metric);
 	gboolean (*ip6_route_delete) (NMPlatform *, int ifindex, struct in6_addr network, int plen, guint32 metric);
+	gboolean (*ip_route_batch) (NMPlatform *, int addr_family, NMPlatformRouteBatchItem *items, guint n_items);
 	const NMPlatformIP4Route *(*ip4_route_get) (NMPlatform *, int ifindex, in_addr_t network, int plen, guint32 metric);
 	const NMPlatformIP6Route *(*ip6_route_get) (NMPlatform *, int ifindex, struct in6_addr network, int plen, guint32 metric);
 
@@ -678,6 +708,17 @@ _nm_platform_uint8_inv (guint8 scope)
 NMPNetns *nm_platform_netns_get (NMPlatform *self);
 gboolean nm_platform_netns_push (NMPlatform *platform, NMPNetns **netns);
 
+NMPlatformIfindexWatch *nm_platform_ifindex_watch_add (NMPlatform *self,
+                                                       int ifindex,
+                                                       NMPlatformIfindexWatchFunc callback,
+                                                       gpointer user_data);
+void nm_platform_ifindex_watch_set_ifindex (NMPlatform *self,
+                                            NMPlatformIfindexWatch *watch,
+                                            int ifindex);
+void nm_platform_ifindex_watch_remove (NMPlatform *self,
+                                       NMPlatformIfindexWatch *watch);
+guint64 nm_platform_ifindex_watch_get_num_avoided (NMPlatform *self);
+
 const char *nm_link_type_to_string (NMLinkType link_type);
 
 const char *_nm_platform_error_to_string (NMPlatformError error);
@@ -896,6 +937,8 @@ gboolean nm_platform_ip6_route_add (NMPlatform *self, int ifindex, NMIPConfigSou
                                     guint32 metric, guint32 mss);
 gboolean nm_platform_ip4_route_delete (NMPlatform *self, int ifindex, in_addr_t network, int plen, guint32 metric);
 gboolean nm_platform_ip6_route_delete (NMPlatform *self, int ifindex, struct in6_addr network, int plen, guint32 metric);
+gboolean nm_platform_ip4_route_batch (NMPlatform *self, NMPlatformRouteBatchItem *items, guint n_items);
+gboolean nm_platform_ip6_route_batch (NMPlatform *self, NMPlatformRouteBatchItem *items, guint n_items);
 
 const char *nm_platform_link_to_string (const NMPlatformLink *link, char *buf, gsize len);
 const char *nm_platform_lnk_gre_to_string (const NMPlatformLnkGre *lnk, char *buf, gsize len);
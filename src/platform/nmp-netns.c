@@ -95,6 +95,10 @@ typedef struct _NMPNetnsPrivate NMPNetnsPrivate;
 struct _NMPNetnsPrivate {
 	int fd_net;
 	int fd_mnt;
+
+	/* a directory fd for /sys as mounted inside the namespace, opened
+	 * on first use. -1 if not yet opened. */
+	int fd_sys;
 };
 
 typedef struct {
@@ -110,6 +114,9 @@ static NMPNetns *_netns_new (GError **error);
 
 static GArray *netns_stack = NULL;
 
+/* number of setns() calls performed, see nmp_netns_get_switch_count(). */
+static guint64 switch_count = 0;
+
 static void
 _stack_ensure_init_impl (void)
 {
@@ -318,6 +325,7 @@ _setns (NMPNetns *self, int type)
 
 	_LOGt (self, "set netns(%s, %d)", _ns_types_to_str (type, 0, buf), fd);
 
+	switch_count++;
 	return setns (fd, type);
 }
 
@@ -408,6 +416,52 @@ nmp_netns_get_fd_mnt (NMPNetns *self)
 	return self->priv->fd_mnt;
 }
 
+/**
+ * nmp_netns_get_fd_sys:
+ * @self: the #NMPNetns
+ *
+ * Returns a directory file descriptor of /sys as mounted inside @self.
+ * sysfs is bound to the network namespace it was mounted in, so paths can
+ * be opened relative to it with openat() without switching namespaces.
+ * The descriptor is opened on first use and owned by @self.
+ *
+ * Returns: the file descriptor or -1 on failure.
+ */
+int
+nmp_netns_get_fd_sys (NMPNetns *self)
+{
+	nm_auto_pop_netns NMPNetns *netns_pop = NULL;
+	int errsv;
+
+	g_return_val_if_fail (NMP_IS_NETNS (self), -1);
+
+	if (self->priv->fd_sys >= 0)
+		return self->priv->fd_sys;
+
+	if (!nmp_netns_push_type (self, CLONE_NEWNS))
+		return -1;
+	netns_pop = self;
+
+	self->priv->fd_sys = open ("/sys", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (self->priv->fd_sys == -1) {
+		errsv = errno;
+		_LOGE (self, "failed to open /sys: %s", g_strerror (errsv));
+	}
+	return self->priv->fd_sys;
+}
+
+/**
+ * nmp_netns_get_switch_count:
+ *
+ * Returns: the number of setns() calls done so far. Mostly useful to
+ *   check that a code path does not switch namespaces.
+ */
+guint64
+nmp_netns_get_switch_count (void)
+{
+	return switch_count;
+}
+
 /*********************************************************************************************/
 
 static gboolean
@@ -686,6 +740,7 @@ static void
 nmp_netns_init (NMPNetns *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, NMP_TYPE_NETNS, NMPNetnsPrivate);
+	self->priv->fd_sys = -1;
 }
 
 static void
@@ -703,6 +758,11 @@ dispose (GObject *object)
 		self->priv->fd_mnt = 0;
 	}
 
+	if (self->priv->fd_sys >= 0) {
+		close (self->priv->fd_sys);
+		self->priv->fd_sys = -1;
+	}
+
 	G_OBJECT_CLASS (nmp_netns_parent_class)->dispose (object);
 }
 
@@ -58,6 +58,9 @@ gboolean nmp_netns_is_initial (void);
 
 int nmp_netns_get_fd_net (NMPNetns *self);
 int nmp_netns_get_fd_mnt (NMPNetns *self);
+int nmp_netns_get_fd_sys (NMPNetns *self);
+
+guint64 nmp_netns_get_switch_count (void);
 
 static inline void
 _nm_auto_pop_netns (NMPNetns **p)
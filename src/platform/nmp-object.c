@@ -22,6 +22,7 @@
 
 #include "nmp-object.h"
 
+#include <stdlib.h>
 #include <unistd.h>
 
 #include "nm-utils.h"
@@ -49,6 +50,236 @@
 
 /*********************************************************************************************/
 
+/* NMPSlab is a simple allocator for the NMPObjects of one type (and for the
+ * NMPCacheId keys of the cache). The objects are carved out of chunks and
+ * freed objects are recycled via a per-chunk free list. Chunks are aligned
+ * to their size, so that the chunk of an object is found by masking its
+ * address. Each chunk counts its live objects. When its last object is
+ * freed, the chunk is kept as spare for the next allocation, so that an
+ * object that comes and goes at a chunk boundary doesn't allocate and
+ * release a chunk every time. Only one spare is kept per slab.
+ *
+ * Platform objects are only used from the main thread, so there is no locking.
+ * With G_SLICE=always-malloc (e.g. for valgrind), every object is allocated
+ * separately. */
+
+#define SLAB_CHUNK_SIZE     (16 * 1024)
+#define SLAB_CHUNK_MIN_OBJS 16
+
+typedef struct _NMPSlabChunk {
+	struct _NMPSlabChunk *next;
+	struct _NMPSlabChunk *prev;
+	gpointer free_list;
+	guint n_objs;
+	guint n_in_use;
+
+	/* the next never used object. */
+	guint obj_next;
+	/* the objects follow at _SLAB_CHUNK_HEADER_SIZE. */
+} NMPSlabChunk;
+
+#define _SLAB_ALIGN(size)        (((size) + G_MEM_ALIGN - 1) & ~((gsize) G_MEM_ALIGN - 1))
+#define _SLAB_CHUNK_HEADER_SIZE  _SLAB_ALIGN (sizeof (NMPSlabChunk))
+#define _SLAB_CHUNK_OBJ(chunk, elem_size, i) \
+	((gpointer) (((char *) (chunk)) + _SLAB_CHUNK_HEADER_SIZE + (gsize) (i) * (elem_size)))
+
+typedef struct {
+	gsize elem_size;
+	gsize chunk_size;
+
+	/* chunks with unused objects, and chunks that are full. */
+	NMPSlabChunk *chunks_partial;
+	NMPSlabChunk *chunks_full;
+
+	/* an empty chunk, not on any list. */
+	NMPSlabChunk *chunk_spare;
+
+	guint n_in_use;
+	guint n_objs;
+	guint n_chunks;
+	gsize n_bytes;
+} NMPSlab;
+
+/* one slab per object type, and one for NMPCacheId. */
+static NMPSlab _slabs[NMP_OBJECT_TYPE_MAX + 1];
+
+#define _SLAB_CACHE_ID (&_slabs[NMP_OBJECT_TYPE_MAX])
+
+static gboolean
+_slab_always_malloc (void)
+{
+	static int always_malloc = -1;
+
+	if (G_UNLIKELY (always_malloc == -1))
+		always_malloc = !!g_slice_get_config (G_SLICE_CONFIG_ALWAYS_MALLOC);
+	return always_malloc;
+}
+
+static void
+_slab_chunk_link (NMPSlabChunk **head, NMPSlabChunk *chunk)
+{
+	chunk->prev = NULL;
+	chunk->next = *head;
+	if (chunk->next)
+		chunk->next->prev = chunk;
+	*head = chunk;
+}
+
+static void
+_slab_chunk_unlink (NMPSlabChunk **head, NMPSlabChunk *chunk)
+{
+	if (chunk->prev)
+		chunk->prev->next = chunk->next;
+	else {
+		nm_assert (*head == chunk);
+		*head = chunk->next;
+	}
+	if (chunk->next)
+		chunk->next->prev = chunk->prev;
+}
+
+static gpointer
+_slab_alloc0 (NMPSlab *slab, gsize size)
+{
+	NMPSlabChunk *chunk;
+	gpointer obj;
+
+	nm_assert (size > 0);
+
+	if (G_UNLIKELY (!slab->elem_size)) {
+		/* the free list is linked through the first pointer of each object. */
+		slab->elem_size = _SLAB_ALIGN (MAX (size, sizeof (gpointer)));
+
+		/* the chunk size must be a power of two for the address mask. */
+		slab->chunk_size = SLAB_CHUNK_SIZE;
+		while (slab->chunk_size < _SLAB_CHUNK_HEADER_SIZE + SLAB_CHUNK_MIN_OBJS * slab->elem_size)
+			slab->chunk_size <<= 1;
+	}
+	nm_assert (size <= slab->elem_size);
+
+	if (_slab_always_malloc ()) {
+		slab->n_in_use++;
+		slab->n_bytes += size;
+		return g_malloc0 (size);
+	}
+
+	chunk = slab->chunks_partial;
+	if (!chunk && slab->chunk_spare) {
+		chunk = slab->chunk_spare;
+		slab->chunk_spare = NULL;
+		_slab_chunk_link (&slab->chunks_partial, chunk);
+	} else if (!chunk) {
+		gpointer mem;
+
+		if (posix_memalign (&mem, slab->chunk_size, slab->chunk_size) != 0)
+			g_error ("%s: failed to allocate %zu bytes", G_STRLOC, (size_t) slab->chunk_size);
+		chunk = mem;
+		chunk->free_list = NULL;
+		chunk->n_objs = (slab->chunk_size - _SLAB_CHUNK_HEADER_SIZE) / slab->elem_size;
+		chunk->n_in_use = 0;
+		chunk->obj_next = 0;
+		_slab_chunk_link (&slab->chunks_partial, chunk);
+		slab->n_chunks++;
+		slab->n_objs += chunk->n_objs;
+		slab->n_bytes += slab->chunk_size;
+	}
+
+	if (chunk->free_list) {
+		obj = chunk->free_list;
+		chunk->free_list = *((gpointer *) obj);
+	} else {
+		nm_assert (chunk->obj_next < chunk->n_objs);
+		obj = _SLAB_CHUNK_OBJ (chunk, slab->elem_size, chunk->obj_next++);
+	}
+
+	if (++chunk->n_in_use == chunk->n_objs) {
+		_slab_chunk_unlink (&slab->chunks_partial, chunk);
+		_slab_chunk_link (&slab->chunks_full, chunk);
+	}
+
+	slab->n_in_use++;
+	memset (obj, 0, size);
+	return obj;
+}
+
+static void
+_slab_free (NMPSlab *slab, gsize size, gpointer obj)
+{
+	NMPSlabChunk *chunk;
+
+	nm_assert (slab->n_in_use > 0);
+
+	slab->n_in_use--;
+
+	if (_slab_always_malloc ()) {
+		slab->n_bytes -= size;
+		g_free (obj);
+		return;
+	}
+
+	chunk = (NMPSlabChunk *) (((guintptr) obj) & ~((guintptr) slab->chunk_size - 1));
+	nm_assert (chunk->n_in_use > 0);
+
+	if (chunk->n_in_use-- == chunk->n_objs) {
+		_slab_chunk_unlink (&slab->chunks_full, chunk);
+		_slab_chunk_link (&slab->chunks_partial, chunk);
+	}
+
+	if (chunk->n_in_use == 0) {
+		/* the chunk is empty. Keep it as spare and give the memory of
+		 * the previous spare back. */
+		_slab_chunk_unlink (&slab->chunks_partial, chunk);
+		chunk->free_list = NULL;
+		chunk->obj_next = 0;
+		if (slab->chunk_spare) {
+			slab->n_chunks--;
+			slab->n_objs -= slab->chunk_spare->n_objs;
+			slab->n_bytes -= slab->chunk_size;
+			free (slab->chunk_spare);
+		}
+		slab->chunk_spare = chunk;
+		return;
+	}
+
+	*((gpointer *) obj) = chunk->free_list;
+	chunk->free_list = obj;
+}
+
+/**
+ * nmp_object_get_memory_stats:
+ *
+ * Returns: (transfer full): a #GVariant of type "a{sa{st}}" with the memory
+ *   usage of the allocators for the platform objects, by object type.
+ */
+GVariant *
+nmp_object_get_memory_stats (void)
+{
+	GVariantBuilder builder;
+	guint i;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{st}}"));
+	for (i = 0; i < G_N_ELEMENTS (_slabs); i++) {
+		const NMPSlab *slab = &_slabs[i];
+		GVariantBuilder b_slab;
+
+		if (!slab->elem_size)
+			continue;
+
+		g_variant_builder_init (&b_slab, G_VARIANT_TYPE ("a{st}"));
+		g_variant_builder_add (&b_slab, "{st}", "object-size", (guint64) slab->elem_size);
+		g_variant_builder_add (&b_slab, "{st}", "in-use", (guint64) slab->n_in_use);
+		g_variant_builder_add (&b_slab, "{st}", "free", (guint64) (slab->n_objs ? slab->n_objs - slab->n_in_use : 0));
+		g_variant_builder_add (&b_slab, "{st}", "chunks", (guint64) slab->n_chunks);
+		g_variant_builder_add (&b_slab, "{st}", "allocated-bytes", (guint64) slab->n_bytes);
+		g_variant_builder_add (&builder, "{sa{st}}",
+		                       slab == _SLAB_CACHE_ID ? "cache-id" : _nmp_classes[i].obj_type_name,
+		                       &b_slab);
+	}
+	return g_variant_builder_end (&builder);
+}
+
+/*********************************************************************************************/
+
 struct _NMPCache {
 	/* the cache contains only one hash table for all object types, and similarly
 	 * it contains only one NMMultiIndex.
@@ -231,7 +462,9 @@ nmp_object_unref (NMPObject *obj)
 			nm_assert (!obj->is_cached);
 			if (klass->cmd_obj_dispose)
 				klass->cmd_obj_dispose (obj);
-			g_slice_free1 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), obj);
+			_slab_free (&_slabs[klass->obj_type - 1],
+			            klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object),
+			            obj);
 		}
 	}
 }
@@ -259,7 +492,8 @@ _nmp_object_new_from_class (const NMPClass *klass)
 	nm_assert (klass->sizeof_data > 0);
 	nm_assert (klass->sizeof_public > 0 && klass->sizeof_public <= klass->sizeof_data);
 
-	obj = g_slice_alloc0 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object));
+	obj = _slab_alloc0 (&_slabs[klass->obj_type - 1],
+	                    klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object));
 	obj->_class = klass;
 	obj->_ref_count = 1;
 	_LOGt (obj, "new");
@@ -981,7 +1215,7 @@ nmp_cache_id_clone (const NMPCacheId *id)
 {
 	NMPCacheId *id2;
 
-	id2 = g_slice_new (NMPCacheId);
+	id2 = _slab_alloc0 (_SLAB_CACHE_ID, sizeof (NMPCacheId));
 	memcpy (id2, id, sizeof (NMPCacheId));
 	return id2;
 }
@@ -989,7 +1223,7 @@ nmp_cache_id_clone (const NMPCacheId *id)
 void
 nmp_cache_id_destroy (NMPCacheId *id)
 {
-	g_slice_free (NMPCacheId, id);
+	_slab_free (_SLAB_CACHE_ID, sizeof (NMPCacheId), id);
 }
 
 /******************************************************************/
@@ -224,6 +224,10 @@ struct _NMPObject {
 	const NMPClass *_class;
 	int _ref_count;
 	bool is_cached;
+
+	/* the dump generation in which the platform last saw the object
+	 * from netlink. Used for pruning stale objects after a dump. */
+	guint32 dump_generation;
 	union {
 		NMPlatformObject        object;
 
@@ -372,6 +376,8 @@ typedef gboolean (*NMPObjectMatchFn) (const NMPObject *obj, gpointer user_data);
 
 gboolean nmp_cache_id_equal (const NMPCacheId *a, const NMPCacheId *b);
 guint nmp_cache_id_hash (const NMPCacheId *id);
+GVariant *nmp_object_get_memory_stats (void);
+
 NMPCacheId *nmp_cache_id_clone (const NMPCacheId *id);
 void nmp_cache_id_destroy (NMPCacheId *id);
 
@@ -619,6 +619,67 @@ test_internal (void)
 
 /*****************************************************************************/
 
+static void
+_ifindex_watch_cb (NMPlatform *platform,
+                   NMPObjectType obj_type,
+                   int ifindex,
+                   gconstpointer platform_object,
+                   NMPlatformSignalChangeType change_type,
+                   gpointer user_data)
+{
+	int *data = user_data;
+
+	g_assert_cmpint (ifindex, ==, data[0]);
+	data[1]++;
+}
+
+static void
+test_ifindex_watch (void)
+{
+	NMPlatformIfindexWatch *watch, *watch_inactive;
+	int data[2] = { 0 };
+	int ifindex_slave;
+	guint64 avoided;
+
+	_ADD_DUMMY (NM_PLATFORM_GET, DEVICE_NAME);
+	_ADD_DUMMY (NM_PLATFORM_GET, SLAVE_NAME);
+	data[0] = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	ifindex_slave = nm_platform_link_get_ifindex (NM_PLATFORM_GET, SLAVE_NAME);
+	g_assert (data[0] > 0);
+	g_assert (ifindex_slave > 0);
+
+	watch = nm_platform_ifindex_watch_add (NM_PLATFORM_GET, data[0], _ifindex_watch_cb, data);
+	watch_inactive = nm_platform_ifindex_watch_add (NM_PLATFORM_GET, 0, _ifindex_watch_cb, data);
+	avoided = nm_platform_ifindex_watch_get_num_avoided (NM_PLATFORM_GET);
+
+	/* changes of other interfaces don't invoke the watch. */
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, ifindex_slave, NULL));
+	g_assert_cmpint (data[1], ==, 0);
+	g_assert_cmpint (nm_platform_ifindex_watch_get_num_avoided (NM_PLATFORM_GET), >, avoided);
+
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, data[0], NULL));
+	g_assert_cmpint (data[1], >, 0);
+
+	/* move the watch to the other interface. */
+	data[0] = ifindex_slave;
+	data[1] = 0;
+	nm_platform_ifindex_watch_set_ifindex (NM_PLATFORM_GET, watch, ifindex_slave);
+	g_assert (nm_platform_link_set_down (NM_PLATFORM_GET, nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME)));
+	g_assert_cmpint (data[1], ==, 0);
+	g_assert (nm_platform_link_set_down (NM_PLATFORM_GET, ifindex_slave));
+	g_assert_cmpint (data[1], >, 0);
+
+	nm_platform_ifindex_watch_remove (NM_PLATFORM_GET, watch);
+	nm_platform_ifindex_watch_remove (NM_PLATFORM_GET, watch_inactive);
+
+	data[1] = 0;
+	nmtstp_link_del (-1, ifindex_slave, SLAVE_NAME);
+	nmtstp_link_del (-1, nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME), DEVICE_NAME);
+	g_assert_cmpint (data[1], ==, 0);
+}
+
+/*****************************************************************************/
+
 static void
 test_external (void)
 {
@@ -2015,6 +2076,52 @@ test_netns_general (gpointer fixture, gconstpointer test_data)
 
 /*****************************************************************************/
 
+static void
+test_netns_switch_count (gpointer fixture, gconstpointer test_data)
+{
+	gs_unref_object NMPlatform *platform_2 = NULL;
+	const char *path_proc = "/proc/sys/net/ipv6/conf/dummy1_/disable_ipv6";
+	const char *path_sys = "/sys/devices/virtual/net/dummy1_/ifindex";
+	char sbuf[100];
+	guint64 switch_count;
+	int i;
+
+	if (_test_netns_check_skip ())
+		return;
+
+	platform_2 = _test_netns_create_platform ();
+
+	_ADD_DUMMY (platform_2, "dummy1_");
+
+	/* the first access opens the files inside the netns. */
+	g_assert (nm_platform_sysctl_set (platform_2, path_proc, "1"));
+	g_assert_cmpstr (nm_platform_sysctl_get (platform_2, path_proc), ==, "1");
+	g_assert_cmpstr (nm_platform_sysctl_get (platform_2, path_sys), ==, nm_sprintf_buf (sbuf, "%d", nmtstp_link_get_typed (platform_2, 0, "dummy1_", NM_LINK_TYPE_DUMMY)->ifindex));
+	nm_platform_process_events (platform_2);
+
+	/* further accesses and processing events without any pending
+	 * change must not switch the namespace. Rewriting the same value
+	 * does not generate any netlink events. */
+	switch_count = nmp_netns_get_switch_count ();
+	for (i = 0; i < 100; i++) {
+		g_assert (nm_platform_sysctl_set (platform_2, path_proc, "1"));
+		g_assert_cmpstr (nm_platform_sysctl_get (platform_2, path_proc), ==, "1");
+		g_assert (nm_platform_sysctl_get (platform_2, path_sys));
+		nm_platform_process_events (platform_2);
+	}
+	g_assert_cmpint (nmp_netns_get_switch_count (), ==, switch_count);
+
+	/* the cached files are dropped when the link goes away. */
+	g_assert (nm_platform_link_delete (platform_2, nmtstp_link_get_typed (platform_2, 0, "dummy1_", NM_LINK_TYPE_DUMMY)->ifindex));
+	g_assert_cmpstr (nm_platform_sysctl_get (platform_2, path_proc), ==, NULL);
+
+	_ADD_DUMMY (platform_2, "dummy1_");
+	g_assert (nm_platform_sysctl_set (platform_2, path_proc, "1"));
+	g_assert_cmpstr (nm_platform_sysctl_get (platform_2, path_proc), ==, "1");
+}
+
+/*****************************************************************************/
+
 static void
 test_netns_set_netns (gpointer fixture, gconstpointer test_data)
 {
@@ -2292,6 +2399,69 @@ test_netns_bind_to_path (gpointer fixture, gconstpointer test_data)
 
 /*****************************************************************************/
 
+static void
+test_netns_create_many (gpointer fixture, gconstpointer test_data)
+{
+	const guint n_netns = GPOINTER_TO_UINT (test_data);
+	int deferred;
+
+	if (_test_netns_check_skip ())
+		return;
+
+	if (n_netns > 20 && nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-link-linux");
+		g_test_skip ("Skip long running test");
+		return;
+	}
+
+	/* compare creating the platform instances one by one, with first
+	 * requesting all dumps and then collecting the replies. */
+	for (deferred = 0; deferred < 2; deferred++) {
+		gs_unref_ptrarray GPtrArray *platforms = g_ptr_array_new_with_free_func (g_object_unref);
+		gs_unref_ptrarray GPtrArray *netnses = g_ptr_array_new_with_free_func (g_object_unref);
+		gint64 start_time, time;
+		guint i;
+
+		start_time = nm_utils_get_monotonic_timestamp_ns ();
+
+		for (i = 0; i < n_netns; i++) {
+			NMPNetns *netns;
+			NMPlatform *platform;
+
+			netns = nmp_netns_new ();
+			g_assert (NMP_IS_NETNS (netns));
+
+			platform = g_object_new (NM_TYPE_LINUX_PLATFORM,
+			                         NM_PLATFORM_NETNS_SUPPORT, TRUE,
+			                         NM_LINUX_PLATFORM_DEFER_POPULATE, (gboolean) deferred,
+			                         NULL);
+			g_assert (NM_IS_LINUX_PLATFORM (platform));
+
+			nmp_netns_pop (netns);
+
+			g_ptr_array_add (netnses, netns);
+			g_ptr_array_add (platforms, platform);
+		}
+
+		for (i = 0; i < n_netns; i++) {
+			NMPlatform *platform = platforms->pdata[i];
+
+			nm_platform_process_events (platform);
+			g_assert (nm_platform_link_get (platform, 1));
+		}
+
+		time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+		_LOGI (">>> %s: created %u namespaces in %ld.%09ld seconds (%.1f namespaces/second)",
+		       deferred ? "pipelined" : "sequential",
+		       n_netns,
+		       (long) (time / NM_UTILS_NS_PER_SECOND),
+		       (long) (time % NM_UTILS_NS_PER_SECOND),
+		       (double) n_netns * NM_UTILS_NS_PER_SECOND / MAX (time, 1));
+	}
+}
+
+/*****************************************************************************/
+
 void
 init_tests (int *argc, char ***argv)
 {
@@ -2311,6 +2481,7 @@ setup_tests (void)
 	g_test_add_func ("/link/bogus", test_bogus);
 	g_test_add_func ("/link/loopback", test_loopback);
 	g_test_add_func ("/link/internal", test_internal);
+	g_test_add_func ("/link/ifindex-watch", test_ifindex_watch);
 	g_test_add_func ("/link/software/bridge", test_bridge);
 	g_test_add_func ("/link/software/bond", test_bond);
 	g_test_add_func ("/link/software/team", test_team);
@@ -2340,8 +2511,11 @@ setup_tests (void)
 		g_test_add_func ("/link/nl-bugs/spurious-dellink", test_nl_bugs_spuroius_dellink);
 
 		g_test_add_vtable ("/general/netns/general", 0, NULL, _test_netns_setup, test_netns_general, _test_netns_teardown);
+		g_test_add_vtable ("/general/netns/switch-count", 0, NULL, _test_netns_setup, test_netns_switch_count, _test_netns_teardown);
 		g_test_add_vtable ("/general/netns/set-netns", 0, NULL, _test_netns_setup, test_netns_set_netns, _test_netns_teardown);
 		g_test_add_vtable ("/general/netns/push", 0, NULL, _test_netns_setup, test_netns_push, _test_netns_teardown);
 		g_test_add_vtable ("/general/netns/bind-to-path", 0, NULL, _test_netns_setup, test_netns_bind_to_path, _test_netns_teardown);
+		g_test_add_vtable ("/general/netns/create-many/20", 0, GUINT_TO_POINTER (20), _test_netns_setup, test_netns_create_many, _test_netns_teardown);
+		g_test_add_vtable ("/general/netns/create-many/500", 0, GUINT_TO_POINTER (500), _test_netns_setup, test_netns_create_many, _test_netns_teardown);
 	}
 }
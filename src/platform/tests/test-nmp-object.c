@@ -386,6 +386,84 @@ test_cache_link (void)
 
 NMTST_DEFINE ();
 
+/******************************************************************/
+
+static guint64
+_memory_stats_get (const char *type_name, const char *counter)
+{
+	gs_unref_variant GVariant *stats = nmp_object_get_memory_stats ();
+	gs_unref_variant GVariant *counters = NULL;
+	guint64 value = 0;
+
+	g_assert (g_variant_is_of_type (stats, G_VARIANT_TYPE ("a{sa{st}}")));
+	if (!g_variant_lookup (stats, type_name, "@a{st}", &counters))
+		return 0;
+	g_assert (g_variant_lookup (counters, counter, "t", &value));
+	return value;
+}
+
+static void
+test_memory_stats (void)
+{
+	NMPObject *objs[1000];
+	NMPlatformIP4Route r = { 0 };
+	guint64 in_use, chunks;
+	guint i;
+
+	in_use = _memory_stats_get ("ip4-route", "in-use");
+
+	for (i = 0; i < G_N_ELEMENTS (objs); i++) {
+		r.ifindex = 1;
+		r.network = htonl (0x0A000000u + i);
+		r.plen = 32;
+		objs[i] = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (const NMPlatformObject *) &r);
+	}
+	g_assert_cmpint (_memory_stats_get ("ip4-route", "in-use"), ==, in_use + G_N_ELEMENTS (objs));
+
+	/* freed objects are recycled and come back zeroed. */
+	for (i = 0; i < G_N_ELEMENTS (objs); i += 2)
+		nmp_object_unref (objs[i]);
+	g_assert_cmpint (_memory_stats_get ("ip4-route", "in-use"), ==, in_use + G_N_ELEMENTS (objs) / 2);
+	for (i = 0; i < G_N_ELEMENTS (objs); i += 2) {
+		objs[i] = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+		g_assert_cmpint (objs[i]->ip4_route.network, ==, 0);
+		g_assert_cmpint (objs[i]->ip4_route.plen, ==, 0);
+	}
+	for (i = 1; i < G_N_ELEMENTS (objs); i += 2)
+		g_assert_cmpint (objs[i]->ip4_route.network, ==, htonl (0x0A000000u + i));
+
+	for (i = 0; i < G_N_ELEMENTS (objs); i++)
+		nmp_object_unref (objs[i]);
+	g_assert_cmpint (_memory_stats_get ("ip4-route", "in-use"), ==, in_use);
+	if (in_use == 0) {
+		/* only the spare chunk is left. */
+		g_assert_cmpint (_memory_stats_get ("ip4-route", "chunks"), ==, 1);
+	}
+
+	/* empty chunks are released, even while other objects of the type
+	 * are alive. One empty chunk is kept as spare. */
+	for (i = 0; i < G_N_ELEMENTS (objs); i++)
+		objs[i] = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+	chunks = _memory_stats_get ("ip4-route", "chunks");
+	g_assert_cmpint (chunks, >, 2);
+	for (i = 0; i < G_N_ELEMENTS (objs) - 1; i++)
+		nmp_object_unref (objs[i]);
+	g_assert_cmpint (_memory_stats_get ("ip4-route", "in-use"), ==, in_use + 1);
+	g_assert_cmpint (_memory_stats_get ("ip4-route", "chunks"), <, chunks);
+	if (in_use == 0)
+		g_assert_cmpint (_memory_stats_get ("ip4-route", "chunks"), ==, 2);
+	nmp_object_unref (objs[i]);
+
+	/* an object that comes and goes reuses the spare chunk. */
+	chunks = _memory_stats_get ("ip4-route", "chunks");
+	for (i = 0; i < 10; i++) {
+		objs[0] = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+		g_assert_cmpint (_memory_stats_get ("ip4-route", "chunks"), ==, chunks);
+		nmp_object_unref (objs[0]);
+		g_assert_cmpint (_memory_stats_get ("ip4-route", "chunks"), ==, chunks);
+	}
+}
+
 int
 main (int argc, char **argv)
 {
@@ -410,6 +488,7 @@ main (int argc, char **argv)
 	}
 
 	g_test_add_func ("/nmp-object/cache_link", test_cache_link);
+	g_test_add_func ("/nmp-object/memory_stats", test_memory_stats);
 
 	result = g_test_run ();
 
@@ -328,6 +328,132 @@ test_ip4_zero_gateway (void)
 
 /*****************************************************************************/
 
+static void
+test_ip4_route_ignore_protocol (void)
+{
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	gs_unref_object NMPlatform *platform = NULL;
+
+	nmtstp_run_command_check ("ip route add 1.2.3.3/32 dev %s proto zebra", DEVICE_NAME);
+	nmtstp_run_command_check ("ip route add 1.2.3.4/32 dev %s proto static", DEVICE_NAME);
+
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (   nm_platform_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.3"), 32, 0)
+		    && nm_platform_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.4"), 32, 0))
+			break;
+	});
+
+	/* the initial dump of the new instance skips the zebra route... */
+	platform = g_object_new (NM_TYPE_LINUX_PLATFORM,
+	                         NM_LINUX_PLATFORM_IGNORE_ROUTE_PROTOCOLS, "zebra",
+	                         NULL);
+	g_assert (!nm_platform_ip4_route_get (platform, ifindex, nmtst_inet4_from_string ("1.2.3.3"), 32, 0));
+	g_assert (nm_platform_ip4_route_get (platform, ifindex, nmtst_inet4_from_string ("1.2.3.4"), 32, 0));
+
+	/* ... and so do the events. */
+	nmtstp_run_command_check ("ip route add 1.2.3.5/32 dev %s proto 11", DEVICE_NAME);
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (nm_platform_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.5"), 32, 0))
+			break;
+	});
+	nm_platform_process_events (platform);
+	g_assert (!nm_platform_ip4_route_get (platform, ifindex, nmtst_inet4_from_string ("1.2.3.5"), 32, 0));
+
+	nmtstp_run_command_check ("ip route flush dev %s", DEVICE_NAME);
+
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+	nm_platform_process_events (NM_PLATFORM_GET);
+}
+
+/*****************************************************************************/
+
+static void
+_many_routes_fill (GArray *routes, GArray *items, int ifindex, guint n_routes, NMPlatformRouteBatchOp op)
+{
+	guint i;
+
+	g_array_set_size (routes, n_routes);
+	g_array_set_size (items, n_routes);
+	for (i = 0; i < n_routes; i++) {
+		NMPlatformIP4Route *r = &g_array_index (routes, NMPlatformIP4Route, i);
+		NMPlatformRouteBatchItem *item = &g_array_index (items, NMPlatformRouteBatchItem, i);
+
+		memset (r, 0, sizeof (*r));
+		r->ifindex = ifindex;
+		r->source = NM_IP_CONFIG_SOURCE_USER;
+		r->network = htonl (0x0A000000u + i);
+		r->plen = 32;
+		r->metric = 22987;
+
+		memset (item, 0, sizeof (*item));
+		item->op = op;
+		item->route = (const NMPlatformIPXRoute *) r;
+		item->metric = -1;
+	}
+}
+
+static void
+test_ip4_route_many (gconstpointer user_data)
+{
+	guint n_routes = GPOINTER_TO_UINT (user_data);
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	gs_unref_array GArray *routes = g_array_new (FALSE, FALSE, sizeof (NMPlatformIP4Route));
+	gs_unref_array GArray *items = g_array_new (FALSE, FALSE, sizeof (NMPlatformRouteBatchItem));
+	gint64 start_time, time_single, time_batch;
+	guint i;
+
+	if (n_routes > 100 && nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-route-linux");
+		g_test_skip ("Skip long running test");
+		return;
+	}
+
+	/* add the routes one by one... */
+	_many_routes_fill (routes, items, ifindex, n_routes, NM_PLATFORM_ROUTE_BATCH_ADD);
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n_routes; i++) {
+		const NMPlatformIP4Route *r = &g_array_index (routes, NMPlatformIP4Route, i);
+
+		g_assert (nm_platform_ip4_route_add (NM_PLATFORM_GET, ifindex, r->source, r->network, r->plen,
+		                                     r->gateway, r->pref_src, r->metric, r->mss));
+	}
+	time_single = nm_utils_get_monotonic_timestamp_ns () - start_time;
+
+	/* ... delete them in a batch ... */
+	_many_routes_fill (routes, items, ifindex, n_routes, NM_PLATFORM_ROUTE_BATCH_DELETE);
+	g_assert (nm_platform_ip4_route_batch (NM_PLATFORM_GET, (NMPlatformRouteBatchItem *) items->data, items->len));
+	for (i = 0; i < n_routes; i++) {
+		const NMPlatformIP4Route *r = &g_array_index (routes, NMPlatformIP4Route, i);
+
+		g_assert (g_array_index (items, NMPlatformRouteBatchItem, i).success);
+		g_assert (!nm_platform_ip4_route_get (NM_PLATFORM_GET, ifindex, r->network, r->plen, r->metric));
+	}
+
+	/* ... and add them again in a batch. */
+	_many_routes_fill (routes, items, ifindex, n_routes, NM_PLATFORM_ROUTE_BATCH_ADD);
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+	g_assert (nm_platform_ip4_route_batch (NM_PLATFORM_GET, (NMPlatformRouteBatchItem *) items->data, items->len));
+	time_batch = nm_utils_get_monotonic_timestamp_ns () - start_time;
+	for (i = 0; i < n_routes; i++) {
+		const NMPlatformIP4Route *r = &g_array_index (routes, NMPlatformIP4Route, i);
+
+		g_assert (g_array_index (items, NMPlatformRouteBatchItem, i).success);
+		g_assert (nm_platform_ip4_route_get (NM_PLATFORM_GET, ifindex, r->network, r->plen, r->metric));
+	}
+
+	_LOGI (">>> adding %u routes: %ld.%09ld seconds one by one, %ld.%09ld seconds batched",
+	       n_routes,
+	       (long) (time_single / NM_UTILS_NS_PER_SECOND), (long) (time_single % NM_UTILS_NS_PER_SECOND),
+	       (long) (time_batch / NM_UTILS_NS_PER_SECOND), (long) (time_batch % NM_UTILS_NS_PER_SECOND));
+
+	_many_routes_fill (routes, items, ifindex, n_routes, NM_PLATFORM_ROUTE_BATCH_DELETE);
+	g_assert (nm_platform_ip4_route_batch (NM_PLATFORM_GET, (NMPlatformRouteBatchItem *) items->data, items->len));
+}
+
+/*****************************************************************************/
+
 void
 init_tests (int *argc, char ***argv)
 {
@@ -350,7 +476,11 @@ setup_tests (void)
 	g_test_add_func ("/route/ip4", test_ip4_route);
 	g_test_add_func ("/route/ip6", test_ip6_route);
 	g_test_add_func ("/route/ip4_metric0", test_ip4_route_metric0);
+	g_test_add_data_func ("/route/ip4_many/100", GUINT_TO_POINTER (100), test_ip4_route_many);
+	g_test_add_data_func ("/route/ip4_many/5000", GUINT_TO_POINTER (5000), test_ip4_route_many);
 
-	if (nmtstp_is_root_test ())
+	if (nmtstp_is_root_test ()) {
 		g_test_add_func ("/route/ip4_zero_gateway", test_ip4_zero_gateway);
+		g_test_add_func ("/route/ip4_ignore_protocol", test_ip4_route_ignore_protocol);
+	}
 }
@@ -32,12 +32,10 @@
 #include "NetworkManagerUtils.h"
 #include "nm-core-internal.h"
 #include "nm-audit-manager.h"
+#include "nm-state-db.h"
 
 #include "nmdbus-settings-connection.h"
 
-#define SETTINGS_TIMESTAMPS_FILE  NMSTATEDIR "/timestamps"
-#define SETTINGS_SEEN_BSSIDS_FILE NMSTATEDIR "/seen-bssids"
-
 #define _NMLOG_DOMAIN        LOGD_SETTINGS
 #define _NMLOG_PREFIX_NAME   "settings-connection"
 #define _NMLOG(level, ...) \
@@ -697,39 +695,9 @@ nm_settings_connection_delete (NMSettingsConnection *self,
 }
 
 static void
-remove_entry_from_db (NMSettingsConnection *self, const char* db_name)
+remove_entry_from_db (NMSettingsConnection *self, NMStateDB *db)
 {
-	GKeyFile *key_file;
-	const char *db_file;
-
-	if (strcmp (db_name, "timestamps") == 0)
-		db_file = SETTINGS_TIMESTAMPS_FILE;
-	else if (strcmp (db_name, "seen-bssids") == 0)
-		db_file = SETTINGS_SEEN_BSSIDS_FILE;
-	else
-		return;
-
-	key_file = g_key_file_new ();
-	if (g_key_file_load_from_file (key_file, db_file, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		const char *connection_uuid;
-		char *data;
-		gsize len;
-		GError *error = NULL;
-
-		connection_uuid = nm_settings_connection_get_uuid (self);
-
-		g_key_file_remove_key (key_file, db_name, connection_uuid, NULL);
-		data = g_key_file_to_data (key_file, &len, &error);
-		if (data) {
-			g_file_set_contents (db_file, data, len, &error);
-			g_free (data);
-		}
-		if (error) {
-			_LOGW ("error writing %s file '%s': %s", db_name, db_file, error->message);
-			g_error_free (error);
-		}
-	}
-	g_key_file_free (key_file);
+	nm_state_db_remove (db, nm_settings_connection_get_uuid (self));
 }
 
 static void
@@ -752,10 +720,10 @@ do_delete (NMSettingsConnection *self,
 	g_object_unref (for_agents);
 
 	/* Remove timestamp from timestamps database file */
-	remove_entry_from_db (self, "timestamps");
+	remove_entry_from_db (self, nm_state_db_get_timestamps ());
 
 	/* Remove connection from seen-bssids database file */
-	remove_entry_from_db (self, "seen-bssids");
+	remove_entry_from_db (self, nm_state_db_get_seen_bssids ());
 
 	nm_settings_connection_signal_remove (self);
 
@@ -2137,6 +2105,8 @@ nm_settings_connection_get_timestamp (NMSettingsConnection *self,
  * @flush_to_disk: if %TRUE, commit timestamp update to persistent storage
  *
  * Updates the connection and timestamps database with the provided timestamp.
+ * The database is written to disk with a short delay, together with other
+ * pending updates.
  **/
 void
 nm_settings_connection_update_timestamp (NMSettingsConnection *self,
@@ -2144,11 +2114,7 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
                                          gboolean flush_to_disk)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
-	GKeyFile *timestamps_file;
-	char *data, *tmp;
-	gsize len;
-	GError *error = NULL;
+	char tmp[30];
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
@@ -2159,29 +2125,11 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
 	if (flush_to_disk == FALSE)
 		return;
 
-	/* Save timestamp to timestamps database file */
-	timestamps_file = g_key_file_new ();
-	if (!g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
-			_LOGW ("error parsing timestamps file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_clear_error (&error);
-	}
-
-	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp = g_strdup_printf ("%" G_GUINT64_FORMAT, timestamp);
-	g_key_file_set_value (timestamps_file, "timestamps", connection_uuid, tmp);
-	g_free (tmp);
-
-	data = g_key_file_to_data (timestamps_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_TIMESTAMPS_FILE, data, len, &error);
-		g_free (data);
-	}
-	if (error) {
-		_LOGW ("error saving timestamp to file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_error_free (error);
-	}
-	g_key_file_free (timestamps_file);
+	/* Save timestamp to timestamps database */
+	g_snprintf (tmp, sizeof (tmp), "%" G_GUINT64_FORMAT, timestamp);
+	nm_state_db_set_value (nm_state_db_get_timestamps (),
+	                       nm_settings_connection_get_uuid (self),
+	                       tmp);
 }
 
 /**
@@ -2195,33 +2143,22 @@ void
 nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
-	guint64 timestamp = 0;
-	GKeyFile *timestamps_file;
-	GError *err = NULL;
 	char *tmp_str;
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
-	/* Get timestamp from database file */
-	timestamps_file = g_key_file_new ();
-	g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL);
-	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp_str = g_key_file_get_value (timestamps_file, "timestamps", connection_uuid, &err);
-	if (tmp_str) {
-		timestamp = g_ascii_strtoull (tmp_str, NULL, 10);
-		g_free (tmp_str);
+	/* Get timestamp from database */
+	tmp_str = nm_state_db_get_value (nm_state_db_get_timestamps (),
+	                                 nm_settings_connection_get_uuid (self));
+	if (!tmp_str) {
+		_LOGD ("failed to read connection timestamp: no entry in the database");
+		return;
 	}
 
 	/* Update connection's timestamp */
-	if (!err) {
-		priv->timestamp = timestamp;
-		priv->timestamp_set = TRUE;
-	} else {
-		_LOGD ("failed to read connection timestamp: %s", err->message);
-		g_clear_error (&err);
-	}
-	g_key_file_free (timestamps_file);
+	priv->timestamp = g_ascii_strtoull (tmp_str, NULL, 10);
+	priv->timestamp_set = TRUE;
+	g_free (tmp_str);
 }
 
 /**
@@ -2284,12 +2221,8 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
                                        const char *seen_bssid)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
-	char *data, *bssid_str;
+	char *bssid_str;
 	const char **list;
-	gsize len;
-	GError *error = NULL;
 	GHashTableIter iter;
 	guint n;
 
@@ -2309,33 +2242,11 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &bssid_str))
 		list[n++] = bssid_str;
 
-	/* Save BSSID to seen-bssids file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (!g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
-			_LOGW ("error parsing seen-bssids file '%s': %s",
-			       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		}
-		g_clear_error (&error);
-	}
-
-	connection_uuid = nm_settings_connection_get_uuid (self);
-	g_key_file_set_string_list (seen_bssids_file, "seen-bssids", connection_uuid, list, n);
+	/* Save BSSID to seen-bssids database */
+	nm_state_db_set_string_list (nm_state_db_get_seen_bssids (),
+	                             nm_settings_connection_get_uuid (self),
+	                             list, n);
 	g_free (list);
-
-	data = g_key_file_to_data (seen_bssids_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_SEEN_BSSIDS_FILE, data, len, &error);
-		g_free (data);
-	}
-	g_key_file_free (seen_bssids_file);
-
-	if (error) {
-		_LOGW ("error saving seen-bssids to file '%s': %s",
-		       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		g_error_free (error);
-	}
 }
 
 /**
@@ -2349,20 +2260,14 @@ void
 nm_settings_connection_read_and_fill_seen_bssids (NMSettingsConnection *self)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
-	char **tmp_strv = NULL;
+	char **tmp_strv;
 	gsize i, len = 0;
 	NMSettingWireless *s_wifi;
 
-	/* Get seen BSSIDs from database file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		connection_uuid = nm_settings_connection_get_uuid (self);
-		tmp_strv = g_key_file_get_string_list (seen_bssids_file, "seen-bssids", connection_uuid, &len, NULL);
-	}
-	g_key_file_free (seen_bssids_file);
+	/* Get seen BSSIDs from database */
+	tmp_strv = nm_state_db_get_string_list (nm_state_db_get_seen_bssids (),
+	                                        nm_settings_connection_get_uuid (self),
+	                                        &len);
 
 	/* Update connection's seen-bssids */
 	if (tmp_strv) {
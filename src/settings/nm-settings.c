@@ -142,9 +142,13 @@ typedef struct {
 	GSList *plugins;
 	gboolean connections_loaded;
 	GHashTable *connections;
+	GHashTable *connections_by_uuid;
+	GHashTable *connections_by_type;  /* interned type::set of connections */
+	GHashTable *connection_types;     /* connection::interned type it is indexed by */
 	GSList *unmanaged_specs;
 	GSList *unrecognized_specs;
 	GSList *get_connections_cache;
+	gboolean get_connections_cache_dirty;
 
 	gboolean started;
 	gboolean startup_complete;
@@ -307,22 +311,10 @@ impl_settings_list_connections (NMSettings *self,
 NMSettingsConnection *
 nm_settings_get_connection_by_uuid (NMSettings *self, const char *uuid)
 {
-	NMSettingsPrivate *priv;
-	NMSettingsConnection *candidate;
-	GHashTableIter iter;
-
 	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
 	g_return_val_if_fail (uuid != NULL, NULL);
 
-	priv = NM_SETTINGS_GET_PRIVATE (self);
-
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &candidate)) {
-		if (g_strcmp0 (uuid, nm_settings_connection_get_uuid (candidate)) == 0)
-			return candidate;
-	}
-
-	return NULL;
+	return g_hash_table_lookup (NM_SETTINGS_GET_PRIVATE (self)->connections_by_uuid, uuid);
 }
 
 static void
@@ -846,6 +838,58 @@ next:
 	return success;
 }
 
+static void
+_type_index_remove (NMSettings *self, NMSettingsConnection *connection)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	const char *type;
+	GHashTable *set;
+
+	type = g_hash_table_lookup (priv->connection_types, connection);
+	if (!type)
+		return;
+
+	set = g_hash_table_lookup (priv->connections_by_type, type);
+	if (set)
+		g_hash_table_remove (set, connection);
+	g_hash_table_remove (priv->connection_types, connection);
+}
+
+static void
+_type_index_update (NMSettings *self, NMSettingsConnection *connection)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	const char *type;
+	GHashTable *set;
+
+	type = nm_connection_get_connection_type (NM_CONNECTION (connection));
+	if (type)
+		type = g_intern_string (type);
+	if (type == g_hash_table_lookup (priv->connection_types, connection))
+		return;
+
+	_type_index_remove (self, connection);
+	if (!type)
+		return;
+
+	set = g_hash_table_lookup (priv->connections_by_type, type);
+	if (!set) {
+		set = g_hash_table_new (NULL, NULL);
+		g_hash_table_insert (priv->connections_by_type, (gpointer) type, set);
+	}
+	g_hash_table_add (set, connection);
+	g_hash_table_insert (priv->connection_types, connection, (gpointer) type);
+}
+
+static void
+connection_changed (NMSettingsConnection *connection, gpointer user_data)
+{
+	/* The settings may be replaced as a whole, including the type. Unlike
+	 * the UPDATED signal, which is emitted on idle, this keeps the index
+	 * in sync right away. */
+	_type_index_update (NM_SETTINGS (user_data), connection);
+}
+
 static void
 connection_updated (NMSettingsConnection *connection, gpointer user_data)
 {
@@ -900,10 +944,15 @@ connection_removed (NMSettingsConnection *connection, gpointer user_data)
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_updated_by_user), self);
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_visibility_changed), self);
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_ready_changed), self);
+	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_changed), self);
 	g_object_unref (self);
 
-	/* Forget about the connection internally */
+	/* Forget about the connection internally. The UUID cannot change while
+	 * the connection is exported, so it still matches the index key. */
+	g_hash_table_remove (priv->connections_by_uuid, nm_settings_connection_get_uuid (connection));
+	_type_index_remove (self, connection);
 	g_hash_table_remove (priv->connections, (gpointer) cpath);
+	priv->get_connections_cache_dirty = TRUE;
 
 	/* Notify D-Bus */
 	g_signal_emit (self, signals[CONNECTION_REMOVED], 0, connection);
@@ -976,21 +1025,12 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 {
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 	GError *error = NULL;
-	GHashTableIter iter;
-	gpointer data;
 	const char *path;
 	NMSettingsConnection *existing;
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (connection));
 	g_return_if_fail (nm_connection_get_path (NM_CONNECTION (connection)) == NULL);
 
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, &data)) {
-		/* prevent duplicates */
-		if (data == connection)
-			return;
-	}
-
 	if (!nm_connection_normalize (NM_CONNECTION (connection), NULL, NULL, &error)) {
 		_LOGW ("plugin provided invalid connection: %s", error->message);
 		g_error_free (error);
@@ -998,6 +1038,10 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 	}
 
 	existing = nm_settings_get_connection_by_uuid (self, nm_settings_connection_get_uuid (connection));
+	if (existing == connection) {
+		/* prevent duplicates */
+		return;
+	}
 	if (existing) {
 		/* Cannot add duplicate connections per UUID. Just return without action and
 		 * log a warning.
@@ -1050,6 +1094,13 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 	g_hash_table_insert (priv->connections,
 	                     (gpointer) nm_connection_get_path (NM_CONNECTION (connection)),
 	                     g_object_ref (connection));
+	g_hash_table_insert (priv->connections_by_uuid,
+	                     g_strdup (nm_settings_connection_get_uuid (connection)),
+	                     connection);
+	_type_index_update (self, connection);
+	g_signal_connect (connection, NM_CONNECTION_CHANGED,
+	                  G_CALLBACK (connection_changed), self);
+	priv->get_connections_cache_dirty = TRUE;
 
 	nm_utils_log_connection_diff (NM_CONNECTION (connection), NULL, LOGL_DEBUG, LOGD_CORE, "new connection", "++ ");
 
@@ -1090,20 +1141,16 @@ nm_settings_add_connection (NMSettings *self,
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 	GSList *iter;
 	NMSettingsConnection *added = NULL;
-	GHashTableIter citer;
-	NMConnection *candidate = NULL;
+	const char *uuid;
 
 	/* Make sure a connection with this UUID doesn't already exist */
-	g_hash_table_iter_init (&citer, priv->connections);
-	while (g_hash_table_iter_next (&citer, NULL, (gpointer *) &candidate)) {
-		if (g_strcmp0 (nm_connection_get_uuid (connection),
-		               nm_connection_get_uuid (candidate)) == 0) {
-			g_set_error_literal (error,
-			                     NM_SETTINGS_ERROR,
-			                     NM_SETTINGS_ERROR_UUID_EXISTS,
-			                     "A connection with this UUID already exists.");
-			return NULL;
-		}
+	uuid = nm_connection_get_uuid (connection);
+	if (uuid && g_hash_table_contains (priv->connections_by_uuid, uuid)) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_UUID_EXISTS,
+		                     "A connection with this UUID already exists.");
+		return NULL;
 	}
 
 	/* 1) plugin writes the NMConnection to disk
@@ -2047,6 +2094,62 @@ nm_settings_sort_connections (gconstpointer a, gconstpointer b)
 	return 0;
 }
 
+typedef struct {
+	guint64 timestamp;
+	NMSettingsConnection *connection;
+} BestConnection;
+
+static void
+_best_heap_sift_up (BestConnection *heap, guint i)
+{
+	while (i > 0) {
+		guint parent = (i - 1) / 2;
+		BestConnection tmp;
+
+		if (heap[parent].timestamp <= heap[i].timestamp)
+			break;
+		tmp = heap[parent];
+		heap[parent] = heap[i];
+		heap[i] = tmp;
+		i = parent;
+	}
+}
+
+static void
+_best_heap_sift_down (BestConnection *heap, guint len, guint i)
+{
+	for (;;) {
+		guint smallest = i;
+		guint child = 2 * i + 1;
+		BestConnection tmp;
+
+		if (child < len && heap[child].timestamp < heap[smallest].timestamp)
+			smallest = child;
+		child++;
+		if (child < len && heap[child].timestamp < heap[smallest].timestamp)
+			smallest = child;
+		if (smallest == i)
+			break;
+		tmp = heap[smallest];
+		heap[smallest] = heap[i];
+		heap[i] = tmp;
+		i = smallest;
+	}
+}
+
+static int
+_best_cmp_newest_first (gconstpointer a, gconstpointer b)
+{
+	const BestConnection *ba = a;
+	const BestConnection *bb = b;
+
+	if (ba->timestamp > bb->timestamp)
+		return -1;
+	if (ba->timestamp < bb->timestamp)
+		return 1;
+	return 0;
+}
+
 static GSList *
 get_best_connections (NMConnectionProvider *provider,
                       guint max_requested,
@@ -2057,59 +2160,85 @@ get_best_connections (NMConnectionProvider *provider,
 {
 	NMSettings *self = NM_SETTINGS (provider);
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
-	GSList *sorted = NULL;
+	GHashTable *candidates;
 	GHashTableIter iter;
 	NMSettingsConnection *connection;
-	guint added = 0;
-	guint64 oldest = 0;
+	GArray *best;
+	GSList *sorted = NULL;
+	const char *ctype;
+	guint i;
+
+	/* A connection has exactly one type, so with a type given only
+	 * the connections of that type are candidates. */
+	ctype = ctype1 ?: ctype2;
+	if (ctype) {
+		candidates = g_hash_table_lookup (priv->connections_by_type, ctype);
+		if (!candidates)
+			return NULL;
+	} else
+		candidates = priv->connections;
 
-	g_hash_table_iter_init (&iter, priv->connections);
+	/* With @max_requested, @best is a min-heap on the timestamp holding the
+	 * newest connections seen so far, with the oldest of them at the root. */
+	best = g_array_sized_new (FALSE, FALSE, sizeof (BestConnection),
+	                          max_requested ?: g_hash_table_size (candidates));
+
+	g_hash_table_iter_init (&iter, candidates);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &connection)) {
-		guint64 cur_ts = 0;
+		BestConnection item = { 0 };
 
 		if (ctype1 && !nm_connection_is_type (NM_CONNECTION (connection), ctype1))
 			continue;
 		if (ctype2 && !nm_connection_is_type (NM_CONNECTION (connection), ctype2))
 			continue;
-		if (func && !func (provider, NM_CONNECTION (connection), func_data))
-			continue;
 
-		/* Don't bother with a connection that's older than the oldest one in the list */
-		if (max_requested && added >= max_requested) {
-		    nm_settings_connection_get_timestamp (connection, &cur_ts);
-		    if (cur_ts <= oldest)
-				continue;
-		}
+		nm_settings_connection_get_timestamp (connection, &item.timestamp);
 
-		/* List is sorted with oldest first */
-		sorted = g_slist_insert_sorted (sorted, connection, nm_settings_sort_connections);
-		added++;
+		/* Don't bother with a connection that's older than the oldest one in the heap */
+		if (   max_requested
+		    && best->len >= max_requested
+		    && item.timestamp <= g_array_index (best, BestConnection, 0).timestamp)
+			continue;
 
-		if (max_requested && added > max_requested) {
-			/* Over the limit, remove the oldest one */
-			sorted = g_slist_delete_link (sorted, sorted);
-			added--;
-		}
+		if (func && !func (provider, NM_CONNECTION (connection), func_data))
+			continue;
 
-		nm_settings_connection_get_timestamp (NM_SETTINGS_CONNECTION (sorted->data), &oldest);
+		item.connection = connection;
+		if (!max_requested)
+			g_array_append_val (best, item);
+		else if (best->len < max_requested) {
+			g_array_append_val (best, item);
+			_best_heap_sift_up ((BestConnection *) best->data, best->len - 1);
+		} else {
+			/* Over the limit, replace the oldest one */
+			g_array_index (best, BestConnection, 0) = item;
+			_best_heap_sift_down ((BestConnection *) best->data, best->len, 0);
+		}
 	}
 
-	return g_slist_reverse (sorted);
+	g_array_sort (best, _best_cmp_newest_first);
+	for (i = best->len; i > 0; i--)
+		sorted = g_slist_prepend (sorted, g_array_index (best, BestConnection, i - 1).connection);
+	g_array_free (best, TRUE);
+
+	return sorted;
 }
 
 static const GSList *
 get_connections (NMConnectionProvider *provider)
 {
-	GSList *list = NULL;
 	NMSettings *self = NM_SETTINGS (provider);
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
-	list = _nm_utils_hash_values_to_slist (priv->connections);
-
-	/* Cache the list every call so we can keep it 'const' for callers */
-	g_slist_free (priv->get_connections_cache);
-	priv->get_connections_cache = list;
-	return list;
+	/* The list is cached so we can keep it 'const' for callers. It is only
+	 * rebuilt after connections were added or removed, and a list returned
+	 * earlier stays valid until the next call. */
+	if (priv->get_connections_cache_dirty) {
+		g_slist_free (priv->get_connections_cache);
+		priv->get_connections_cache = _nm_utils_hash_values_to_slist (priv->connections);
+		priv->get_connections_cache_dirty = FALSE;
+	}
+	return priv->get_connections_cache;
 }
 
 static NMConnection *
@@ -2302,6 +2431,9 @@ nm_settings_init (NMSettings *self)
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
 	priv->connections = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+	priv->connections_by_uuid = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->connections_by_type = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_hash_table_unref);
+	priv->connection_types = g_hash_table_new (NULL, NULL);
 
 	/* Hold a reference to the agent manager so it stays alive; the only
 	 * other holders are NMSettingsConnection objects which are often
@@ -2359,6 +2491,9 @@ finalize (GObject *object)
 	NMSettings *self = NM_SETTINGS (object);
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
+	g_hash_table_destroy (priv->connections_by_uuid);
+	g_hash_table_destroy (priv->connections_by_type);
+	g_hash_table_destroy (priv->connection_types);
 	g_hash_table_destroy (priv->connections);
 	g_slist_free (priv->get_connections_cache);
 
@@ -0,0 +1,211 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-state-db.h"
+
+#include <string.h>
+
+/* How long to collect modifications before writing the file. */
+#define FLUSH_DELAY_SEC 5
+
+struct _NMStateDB {
+	const char *filename;
+	const char *group;
+	char list_separator;
+
+	GKeyFile *keyfile;
+	guint flush_id;
+	bool dirty:1;
+};
+
+static NMStateDB dbs[] = {
+	{
+		.filename = NMSTATEDIR "/timestamps",
+		.group = "timestamps",
+	},
+	{
+		.filename = NMSTATEDIR "/seen-bssids",
+		.group = "seen-bssids",
+		.list_separator = ',',
+	},
+};
+
+/******************************************************************************************/
+
+static GKeyFile *
+_keyfile_get (NMStateDB *db)
+{
+	GError *error = NULL;
+
+	if (db->keyfile)
+		return db->keyfile;
+
+	db->keyfile = g_key_file_new ();
+	if (db->list_separator)
+		g_key_file_set_list_separator (db->keyfile, db->list_separator);
+	if (!g_key_file_load_from_file (db->keyfile, db->filename, G_KEY_FILE_KEEP_COMMENTS, &error)) {
+		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			nm_log_warn (LOGD_SETTINGS, "error parsing %s file '%s': %s",
+			             db->group, db->filename, error->message);
+		}
+		g_clear_error (&error);
+	}
+	return db->keyfile;
+}
+
+static gboolean
+_flush_cb (gpointer user_data)
+{
+	NMStateDB *db = user_data;
+
+	db->flush_id = 0;
+	nm_state_db_flush (db);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_set_dirty (NMStateDB *db)
+{
+	db->dirty = TRUE;
+	if (!db->flush_id)
+		db->flush_id = g_timeout_add_seconds (FLUSH_DELAY_SEC, _flush_cb, db);
+}
+
+/******************************************************************************************/
+
+NMStateDB *
+nm_state_db_get_timestamps (void)
+{
+	return &dbs[0];
+}
+
+NMStateDB *
+nm_state_db_get_seen_bssids (void)
+{
+	return &dbs[1];
+}
+
+char *
+nm_state_db_get_value (NMStateDB *db, const char *key)
+{
+	g_return_val_if_fail (db, NULL);
+	g_return_val_if_fail (key, NULL);
+
+	return g_key_file_get_value (_keyfile_get (db), db->group, key, NULL);
+}
+
+char **
+nm_state_db_get_string_list (NMStateDB *db, const char *key, gsize *out_len)
+{
+	g_return_val_if_fail (db, NULL);
+	g_return_val_if_fail (key, NULL);
+
+	return g_key_file_get_string_list (_keyfile_get (db), db->group, key, out_len, NULL);
+}
+
+void
+nm_state_db_set_value (NMStateDB *db, const char *key, const char *value)
+{
+	GKeyFile *keyfile;
+	gs_free char *old = NULL;
+
+	g_return_if_fail (db);
+	g_return_if_fail (key);
+	g_return_if_fail (value);
+
+	keyfile = _keyfile_get (db);
+	old = g_key_file_get_value (keyfile, db->group, key, NULL);
+	if (g_strcmp0 (old, value) == 0)
+		return;
+
+	g_key_file_set_value (keyfile, db->group, key, value);
+	_set_dirty (db);
+}
+
+void
+nm_state_db_set_string_list (NMStateDB *db, const char *key, const char *const *list, gsize len)
+{
+	g_return_if_fail (db);
+	g_return_if_fail (key);
+
+	g_key_file_set_string_list (_keyfile_get (db), db->group, key, list, len);
+	_set_dirty (db);
+}
+
+void
+nm_state_db_remove (NMStateDB *db, const char *key)
+{
+	g_return_if_fail (db);
+	g_return_if_fail (key);
+
+	if (g_key_file_remove_key (_keyfile_get (db), db->group, key, NULL))
+		_set_dirty (db);
+}
+
+/**
+ * nm_state_db_flush:
+ * @db: the #NMStateDB
+ *
+ * Writes @db to disk right away if it has pending modifications.
+ * If writing fails, the modifications stay pending.
+ */
+void
+nm_state_db_flush (NMStateDB *db)
+{
+	gs_free char *data = NULL;
+	gsize len;
+	GError *error = NULL;
+
+	g_return_if_fail (db);
+
+	nm_clear_g_source (&db->flush_id);
+
+	if (!db->dirty)
+		return;
+
+	data = g_key_file_to_data (db->keyfile, &len, &error);
+	if (   !data
+	    || !g_file_set_contents (db->filename, data, len, &error)) {
+		/* stay dirty, so that the next modification or
+		 * nm_state_db_flush_all() tries again. */
+		nm_log_warn (LOGD_SETTINGS, "error saving %s to file '%s': %s",
+		             db->group, db->filename, error->message);
+		g_error_free (error);
+		return;
+	}
+	db->dirty = FALSE;
+}
+
+/**
+ * nm_state_db_flush_all:
+ *
+ * Writes all databases with pending modifications. To be called on
+ * shutdown.
+ */
+void
+nm_state_db_flush_all (void)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (dbs); i++)
+		nm_state_db_flush (&dbs[i]);
+}
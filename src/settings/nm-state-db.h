@@ -0,0 +1,46 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#ifndef __NM_STATE_DB_H__
+#define __NM_STATE_DB_H__
+
+#include "nm-default.h"
+
+/* NMStateDB is the in-memory copy of one of the look-aside databases
+ * in NMSTATEDIR (timestamps, seen-bssids). The file is read once on
+ * first use. Modifications only mark the database dirty and are written
+ * back in one go after a short delay, or by nm_state_db_flush_all(). */
+
+typedef struct _NMStateDB NMStateDB;
+
+NMStateDB *nm_state_db_get_timestamps (void);
+NMStateDB *nm_state_db_get_seen_bssids (void);
+
+char *nm_state_db_get_value (NMStateDB *db, const char *key);
+char **nm_state_db_get_string_list (NMStateDB *db, const char *key, gsize *out_len);
+
+void nm_state_db_set_value (NMStateDB *db, const char *key, const char *value);
+void nm_state_db_set_string_list (NMStateDB *db, const char *key, const char *const *list, gsize len);
+void nm_state_db_remove (NMStateDB *db, const char *key);
+
+void nm_state_db_flush (NMStateDB *db);
+void nm_state_db_flush_all (void);
+
+#endif /* __NM_STATE_DB_H__ */
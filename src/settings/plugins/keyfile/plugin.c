@@ -39,6 +39,7 @@
 #include "plugin.h"
 #include "nm-settings-plugin.h"
 #include "nm-keyfile-connection.h"
+#include "reader.h"
 #include "writer.h"
 #include "utils.h"
 
@@ -52,6 +53,7 @@ G_DEFINE_TYPE_EXTENDED (SettingsPluginKeyfile, settings_plugin_keyfile, G_TYPE_O
 
 typedef struct {
 	GHashTable *connections;  /* uuid::connection */
+	GHashTable *connections_by_path;  /* filename::connection, not owning the connection */
 
 	gboolean initialized;
 	GFileMonitor *monitor;
@@ -60,10 +62,65 @@ typedef struct {
 	NMConfig *config;
 } SettingsPluginKeyfilePrivate;
 
+/* The filename under which a connection is tracked in connections_by_path.
+ * It is kept as object data because on notify::filename the connection
+ * already carries the new name and the old key is needed to drop it. */
+#define INDEXED_PATH_DATA "keyfile-indexed-path"
+
+static void
+_path_index_remove (SettingsPluginKeyfile *self, NMKeyfileConnection *connection)
+{
+	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	const char *path;
+
+	path = g_object_get_data (G_OBJECT (connection), INDEXED_PATH_DATA);
+	if (!path)
+		return;
+
+	if (g_hash_table_lookup (priv->connections_by_path, path) == connection)
+		g_hash_table_remove (priv->connections_by_path, path);
+	g_object_set_data (G_OBJECT (connection), INDEXED_PATH_DATA, NULL);
+}
+
+static void
+_path_index_update (SettingsPluginKeyfile *self, NMKeyfileConnection *connection)
+{
+	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	const char *path;
+
+	_path_index_remove (self, connection);
+
+	path = nm_settings_connection_get_filename (NM_SETTINGS_CONNECTION (connection));
+	if (!path)
+		return;
+
+	g_hash_table_insert (priv->connections_by_path, g_strdup (path), connection);
+	g_object_set_data_full (G_OBJECT (connection), INDEXED_PATH_DATA, g_strdup (path), g_free);
+}
+
+static void
+connection_filename_changed_cb (NMSettingsConnection *obj, GParamSpec *pspec, gpointer user_data)
+{
+	_path_index_update (SETTINGS_PLUGIN_KEYFILE (user_data), NM_KEYFILE_CONNECTION (obj));
+}
+
+static void connection_removed_cb (NMSettingsConnection *obj, gpointer user_data);
+
+static void
+_connection_untrack (SettingsPluginKeyfile *self, NMKeyfileConnection *connection)
+{
+	g_signal_handlers_disconnect_by_func (connection, connection_removed_cb, self);
+	g_signal_handlers_disconnect_by_func (connection, connection_filename_changed_cb, self);
+	_path_index_remove (self, connection);
+}
+
 static void
 connection_removed_cb (NMSettingsConnection *obj, gpointer user_data)
 {
-	g_hash_table_remove (SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (user_data)->connections,
+	SettingsPluginKeyfile *self = SETTINGS_PLUGIN_KEYFILE (user_data);
+
+	_connection_untrack (self, NM_KEYFILE_CONNECTION (obj));
+	g_hash_table_remove (SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self)->connections,
 	                     nm_connection_get_uuid (NM_CONNECTION (obj)));
 }
 
@@ -80,7 +137,7 @@ remove_connection (SettingsPluginKeyfile *self, NMKeyfileConnection *connection)
 
 	/* Removing from the hash table should drop the last reference */
 	g_object_ref (connection);
-	g_signal_handlers_disconnect_by_func (connection, connection_removed_cb, self);
+	_connection_untrack (self, connection);
 	removed = g_hash_table_remove (SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self)->connections,
 	                               nm_connection_get_uuid (NM_CONNECTION (connection)));
 	nm_settings_connection_signal_remove (NM_SETTINGS_CONNECTION (connection));
@@ -92,73 +149,35 @@ remove_connection (SettingsPluginKeyfile *self, NMKeyfileConnection *connection)
 static NMKeyfileConnection *
 find_by_path (SettingsPluginKeyfile *self, const char *path)
 {
-	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
-	GHashTableIter iter;
-	NMSettingsConnection *candidate = NULL;
-
 	g_return_val_if_fail (path != NULL, NULL);
 
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &candidate)) {
-		if (g_strcmp0 (path, nm_settings_connection_get_filename (candidate)) == 0)
-			return NM_KEYFILE_CONNECTION (candidate);
-	}
-	return NULL;
+	return g_hash_table_lookup (SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self)->connections_by_path, path);
 }
 
-/* update_connection:
- * @self: the plugin instance
- * @source: if %NULL, this re-reads the connection from @full_path
- *   and updates it. When passing @source, this adds a connection from
- *   memory.
- * @full_path: the filename of the keyfile to be loaded
- * @connection: an existing connection that might be updated.
- *   If given, @connection must be an existing connection that is currently
- *   owned by the plugin.
- * @protect_existing_connection: if %TRUE, and !@connection, we don't allow updating
- *   an existing connection with the same UUID.
- *   If %TRUE and @connection, allow updating only if the reload would modify
- *   @connection (without changing its UUID) or if we would create a new connection.
- *   In other words, if this paramter is %TRUE, we only allow creating a
- *   new connection (with an unseen UUID) or updating the passed in @connection
- *   (whereas the UUID cannot change).
- *   Note, that this allows for @connection to be replaced by a new connection.
- * @protected_connections: (allow-none): if given, we only update an
- *   existing connection if it is not contained in this hash.
- * @error: error in case of failure
+/* update_connection_take:
+ * @connection_new: (transfer full): the connection created from
+ *   @source or @full_path, or %NULL on failure.
+ * @local: (transfer full): the error for creating @connection_new
+ *   if it is %NULL.
  *
- * Loads a connection from file @full_path. This can both be used to
- * load a connection initially or to update an existing connection.
- *
- * If you pass in an existing connection and the reloaded file happens
- * to have a different UUID, the connection is deleted.
- * Beware, that means that after the function, you have a dangling pointer
- * if the returned connection is different from @connection.
- *
- * Returns: the updated connection.
- * */
+ * The second half of update_connection(), for callers which already
+ * created @connection_new themselves. See update_connection() below for
+ * the other arguments. */
 static NMKeyfileConnection *
-update_connection (SettingsPluginKeyfile *self,
-                   NMConnection *source,
-                   const char *full_path,
-                   NMKeyfileConnection *connection,
-                   gboolean protect_existing_connection,
-                   GHashTable *protected_connections,
-                   GError **error)
+update_connection_take (SettingsPluginKeyfile *self,
+                        NMConnection *source,
+                        const char *full_path,
+                        NMKeyfileConnection *connection_new,
+                        GError *local,
+                        NMKeyfileConnection *connection,
+                        gboolean protect_existing_connection,
+                        GHashTable *protected_connections,
+                        GError **error)
 {
 	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
-	NMKeyfileConnection *connection_new;
 	NMKeyfileConnection *connection_by_uuid;
-	GError *local = NULL;
 	const char *uuid;
 
-	g_return_val_if_fail (!source || NM_IS_CONNECTION (source), NULL);
-	g_return_val_if_fail (full_path || source, NULL);
-
-	if (full_path)
-		nm_log_dbg (LOGD_SETTINGS, "keyfile: loading from file \"%s\"...", full_path);
-
-	connection_new = nm_keyfile_connection_new (source, full_path, &local);
 	if (!connection_new) {
 		/* Error; remove the connection */
 		if (source)
@@ -258,6 +277,10 @@ update_connection (SettingsPluginKeyfile *self,
 		g_signal_connect (connection_new, NM_SETTINGS_CONNECTION_REMOVED,
 		                  G_CALLBACK (connection_removed_cb),
 		                  self);
+		g_signal_connect (connection_new, "notify::" NM_SETTINGS_CONNECTION_FILENAME,
+		                  G_CALLBACK (connection_filename_changed_cb),
+		                  self);
+		_path_index_update (self, connection_new);
 
 		if (!source) {
 			/* Only raise the signal if we were called without source, i.e. if we read the connection from file.
@@ -268,6 +291,61 @@ update_connection (SettingsPluginKeyfile *self,
 	}
 }
 
+/* update_connection:
+ * @self: the plugin instance
+ * @source: if %NULL, this re-reads the connection from @full_path
+ *   and updates it. When passing @source, this adds a connection from
+ *   memory.
+ * @full_path: the filename of the keyfile to be loaded
+ * @connection: an existing connection that might be updated.
+ *   If given, @connection must be an existing connection that is currently
+ *   owned by the plugin.
+ * @protect_existing_connection: if %TRUE, and !@connection, we don't allow updating
+ *   an existing connection with the same UUID.
+ *   If %TRUE and @connection, allow updating only if the reload would modify
+ *   @connection (without changing its UUID) or if we would create a new connection.
+ *   In other words, if this paramter is %TRUE, we only allow creating a
+ *   new connection (with an unseen UUID) or updating the passed in @connection
+ *   (whereas the UUID cannot change).
+ *   Note, that this allows for @connection to be replaced by a new connection.
+ * @protected_connections: (allow-none): if given, we only update an
+ *   existing connection if it is not contained in this hash.
+ * @error: error in case of failure
+ *
+ * Loads a connection from file @full_path. This can both be used to
+ * load a connection initially or to update an existing connection.
+ *
+ * If you pass in an existing connection and the reloaded file happens
+ * to have a different UUID, the connection is deleted.
+ * Beware, that means that after the function, you have a dangling pointer
+ * if the returned connection is different from @connection.
+ *
+ * Returns: the updated connection.
+ * */
+static NMKeyfileConnection *
+update_connection (SettingsPluginKeyfile *self,
+                   NMConnection *source,
+                   const char *full_path,
+                   NMKeyfileConnection *connection,
+                   gboolean protect_existing_connection,
+                   GHashTable *protected_connections,
+                   GError **error)
+{
+	NMKeyfileConnection *connection_new;
+	GError *local = NULL;
+
+	g_return_val_if_fail (!source || NM_IS_CONNECTION (source), NULL);
+	g_return_val_if_fail (full_path || source, NULL);
+
+	if (full_path)
+		nm_log_dbg (LOGD_SETTINGS, "keyfile: loading from file \"%s\"...", full_path);
+
+	connection_new = nm_keyfile_connection_new (source, full_path, &local);
+	return update_connection_take (self, source, full_path, connection_new, local,
+	                               connection, protect_existing_connection,
+	                               protected_connections, error);
+}
+
 static void
 dir_changed (GFileMonitor *monitor,
              GFile *file,
@@ -386,6 +464,24 @@ _sort_paths (const char **f1, const char **f2, GHashTable *paths)
 	return strcmp (*f1, *f2);
 }
 
+/* Below this number of files, parsing them on worker threads doesn't pay off. */
+#define READ_PARALLEL_MIN_FILES 32
+#define READ_PARALLEL_MAX_THREADS 8
+
+static guint
+_read_parallel_threads (guint n_files)
+{
+	long n_cpus;
+
+	if (n_files < READ_PARALLEL_MIN_FILES)
+		return 1;
+
+	n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+	if (n_cpus <= 1)
+		return 1;
+	return MIN (n_cpus, READ_PARALLEL_MAX_THREADS);
+}
+
 static void
 read_connections (NMSettingsPlugin *config)
 {
@@ -401,6 +497,8 @@ read_connections (NMSettingsPlugin *config)
 	guint i;
 	GPtrArray *filenames;
 	GHashTable *paths;
+	NMKeyfilePluginReadResult *results = NULL;
+	guint n_threads;
 
 	dir = g_dir_open (nm_keyfile_plugin_get_path (), 0, &error);
 	if (!dir) {
@@ -431,11 +529,38 @@ read_connections (NMSettingsPlugin *config)
 	g_ptr_array_sort_with_data (filenames, (GCompareDataFunc) _sort_paths, paths);
 	g_hash_table_destroy (paths);
 
+	/* With many files, parsing and normalizing dominates. Do that on a pool
+	 * of worker threads first and only create and claim the settings
+	 * connections here, in the same order as when reading them one by one. */
+	n_threads = _read_parallel_threads (filenames->len);
+	if (n_threads > 1) {
+		nm_log_dbg (LOGD_SETTINGS, "keyfile: parsing %u files with %u threads", filenames->len, n_threads);
+		results = g_new (NMKeyfilePluginReadResult, filenames->len);
+		nm_keyfile_plugin_connections_from_files ((const char *const *) filenames->pdata,
+		                                          filenames->len,
+		                                          n_threads,
+		                                          results);
+	}
+
 	for (i = 0; i < filenames->len; i++) {
-		connection = update_connection (self, NULL, filenames->pdata[i], NULL, FALSE, alive_connections, NULL);
+		const char *full_path = filenames->pdata[i];
+
+		if (results) {
+			NMKeyfileConnection *connection_new = NULL;
+			GError *local = results[i].error;
+
+			nm_log_dbg (LOGD_SETTINGS, "keyfile: loading from file \"%s\"...", full_path);
+			if (results[i].connection) {
+				connection_new = nm_keyfile_connection_new_from_parsed (results[i].connection, full_path, &local);
+				g_object_unref (results[i].connection);
+			}
+			connection = update_connection_take (self, NULL, full_path, connection_new, local, NULL, FALSE, alive_connections, NULL);
+		} else
+			connection = update_connection (self, NULL, full_path, NULL, FALSE, alive_connections, NULL);
 		if (connection)
 			g_hash_table_add (alive_connections, connection);
 	}
+	g_free (results);
 	g_ptr_array_free (filenames, TRUE);
 
 	g_hash_table_iter_init (&iter, priv->connections);
@@ -535,6 +660,7 @@ settings_plugin_keyfile_init (SettingsPluginKeyfile *plugin)
 	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (plugin);
 
 	priv->connections = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	priv->connections_by_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 static void
@@ -594,9 +720,19 @@ dispose (GObject *object)
 	}
 
 	if (priv->connections) {
+		GHashTableIter iter;
+		NMKeyfileConnection *connection;
+
+		/* other users might keep the connections alive, don't leave
+		 * our handlers connected to them. */
+		g_hash_table_iter_init (&iter, priv->connections);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &connection))
+			_connection_untrack (SETTINGS_PLUGIN_KEYFILE (object), connection);
+
 		g_hash_table_destroy (priv->connections);
 		priv->connections = NULL;
 	}
+	g_clear_pointer (&priv->connections_by_path, g_hash_table_destroy);
 
 	if (priv->config) {
 		g_signal_handlers_disconnect_by_func (priv->config, config_changed_cb, object);
@@ -138,3 +138,91 @@ out:
 	return connection;
 }
 
+
+/*****************************************************************************/
+
+typedef struct {
+	const char *const *filenames;
+	NMKeyfilePluginReadResult *results;
+} ReadFilesData;
+
+static void
+_read_files_job (gpointer job, gpointer user_data)
+{
+	ReadFilesData *data = user_data;
+	guint i = GPOINTER_TO_UINT (job) - 1;
+
+	data->results[i].connection = nm_keyfile_plugin_connection_from_file (data->filenames[i],
+	                                                                      &data->results[i].error);
+}
+
+static void
+_ensure_setting_classes (GType type)
+{
+	GType *children;
+	guint n_children, i;
+
+	/* Classes of static types are never finalized, the reference
+	 * only makes sure that class_init ran. */
+	g_type_class_unref (g_type_class_ref (type));
+
+	children = g_type_children (type, &n_children);
+	for (i = 0; i < n_children; i++)
+		_ensure_setting_classes (children[i]);
+	g_free (children);
+}
+
+/**
+ * nm_keyfile_plugin_connections_from_files:
+ * @filenames: the files to read
+ * @len: the number of entries in @filenames
+ * @max_threads: the number of worker threads to use. With 0 or 1
+ *   the files are read on the calling thread.
+ * @results: caller allocated array of @len entries that receives the
+ *   connection or the error for each file.
+ *
+ * Reads and normalizes several keyfiles like nm_keyfile_plugin_connection_from_file().
+ * The workers only parse, they don't touch any state of the daemon besides
+ * logging, so the result can be handed to the main thread afterwards.
+ * The function returns once all files are read.
+ */
+void
+nm_keyfile_plugin_connections_from_files (const char *const *filenames,
+                                          guint len,
+                                          guint max_threads,
+                                          NMKeyfilePluginReadResult *results)
+{
+	ReadFilesData data = {
+		.filenames = filenames,
+		.results = results,
+	};
+	GThreadPool *pool = NULL;
+	guint i;
+
+	g_return_if_fail (filenames || len == 0);
+	g_return_if_fail (results || len == 0);
+
+	memset (results, 0, sizeof (results[0]) * len);
+
+	if (max_threads > len)
+		max_threads = len;
+	if (max_threads > 1)
+		pool = g_thread_pool_new (_read_files_job, &data, max_threads, FALSE, NULL);
+
+	if (!pool) {
+		for (i = 0; i < len; i++)
+			_read_files_job (GUINT_TO_POINTER (i + 1), &data);
+		return;
+	}
+
+	/* Setting types register themselves with libnm-core in unlocked tables
+	 * the first time they are used. Do that here, before the workers
+	 * create settings concurrently. */
+	_ensure_setting_classes (NM_TYPE_SETTING);
+
+	for (i = 0; i < len; i++)
+		g_thread_pool_push (pool, GUINT_TO_POINTER (i + 1), NULL);
+
+	/* wait for the queue to drain */
+	g_thread_pool_free (pool, FALSE, TRUE);
+}
@@ -28,4 +28,14 @@
 
 NMConnection *nm_keyfile_plugin_connection_from_file (const char *filename, GError **error);
 
+typedef struct {
+	NMConnection *connection;
+	GError *error;
+} NMKeyfilePluginReadResult;
+
+void nm_keyfile_plugin_connections_from_files (const char *const *filenames,
+                                               guint len,
+                                               guint max_threads,
+                                               NMKeyfilePluginReadResult *results);
+
 #endif /* _KEYFILE_PLUGIN_READER_H */
@@ -2992,6 +2992,125 @@ test_nm_keyfile_plugin_utils_escape_filename (void)
 
 /*****************************************************************************/
 
+static gint
+_strcmp_p (gconstpointer a, gconstpointer b)
+{
+	return strcmp (*((const char **) a), *((const char **) b));
+}
+
+/* Loads all keyfiles from @dir like the plugin does on startup: list the
+ * directory, read and normalize every file and collect the connections on
+ * the calling thread. */
+static GPtrArray *
+_read_many_dir (const char *dir, guint n_threads, gint64 *out_time)
+{
+	GPtrArray *filenames, *connections;
+	NMKeyfilePluginReadResult *results;
+	GError *error = NULL;
+	const char *item;
+	gint64 start_time;
+	GDir *d;
+	guint i;
+
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+
+	d = g_dir_open (dir, 0, &error);
+	g_assert_no_error (error);
+	filenames = g_ptr_array_new_with_free_func (g_free);
+	while ((item = g_dir_read_name (d))) {
+		if (!nm_keyfile_plugin_utils_should_ignore_file (item))
+			g_ptr_array_add (filenames, g_build_filename (dir, item, NULL));
+	}
+	g_dir_close (d);
+	g_ptr_array_sort (filenames, _strcmp_p);
+
+	connections = g_ptr_array_new_with_free_func (g_object_unref);
+	if (n_threads <= 1) {
+		for (i = 0; i < filenames->len; i++) {
+			NMConnection *connection;
+
+			connection = nm_keyfile_plugin_connection_from_file (filenames->pdata[i], &error);
+			g_assert_no_error (error);
+			g_ptr_array_add (connections, connection);
+		}
+	} else {
+		results = g_new (NMKeyfilePluginReadResult, filenames->len);
+		nm_keyfile_plugin_connections_from_files ((const char *const *) filenames->pdata,
+		                                          filenames->len, n_threads, results);
+		for (i = 0; i < filenames->len; i++) {
+			g_assert_no_error (results[i].error);
+			g_ptr_array_add (connections, results[i].connection);
+		}
+		g_free (results);
+	}
+
+	*out_time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+
+	for (i = 0; i < filenames->len; i++)
+		unlink (filenames->pdata[i]);
+	g_ptr_array_unref (filenames);
+	return connections;
+}
+
+static void
+test_read_many (gconstpointer user_data)
+{
+	const guint n_files = GPOINTER_TO_UINT (user_data);
+	gs_free char *dir_serial = NULL;
+	gs_free char *dir_parallel = NULL;
+	GPtrArray *connections_serial, *connections_parallel;
+	GError *error = NULL;
+	gint64 time_serial, time_parallel;
+	guint i;
+
+	if (n_files > 1000 && nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-keyfile");
+		g_test_skip ("Skip long running test");
+		return;
+	}
+
+	/* use two directories with the same content, so that the second read
+	 * doesn't benefit from a warm page cache for the very same files. */
+	dir_serial = g_dir_make_tmp ("test-keyfile-many-XXXXXX", &error);
+	g_assert_no_error (error);
+	dir_parallel = g_dir_make_tmp ("test-keyfile-many-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	for (i = 0; i < n_files; i++) {
+		gs_unref_object NMConnection *connection = NULL;
+		gs_free char *id = g_strdup_printf ("many-%05u", i);
+		gs_free char *testfile1 = NULL;
+		gs_free char *testfile2 = NULL;
+
+		connection = nmtst_create_minimal_connection (id, NULL, NM_SETTING_WIRED_SETTING_NAME, NULL);
+		nm_keyfile_plugin_write_test_connection (connection, dir_serial, geteuid (), getegid (), &testfile1, &error);
+		g_assert_no_error (error);
+		nm_keyfile_plugin_write_test_connection (connection, dir_parallel, geteuid (), getegid (), &testfile2, &error);
+		g_assert_no_error (error);
+	}
+
+	connections_serial = _read_many_dir (dir_serial, 1, &time_serial);
+	connections_parallel = _read_many_dir (dir_parallel, 8, &time_parallel);
+
+	/* both must yield the same connections, in the same order. */
+	g_assert_cmpint (connections_serial->len, ==, n_files);
+	g_assert_cmpint (connections_parallel->len, ==, n_files);
+	for (i = 0; i < n_files; i++) {
+		nmtst_assert_connection_equals (connections_serial->pdata[i], FALSE,
+		                                connections_parallel->pdata[i], FALSE);
+	}
+	g_ptr_array_unref (connections_serial);
+	g_ptr_array_unref (connections_parallel);
+	rmdir (dir_serial);
+	rmdir (dir_parallel);
+
+	g_test_message (">>> load %u files: serial %ld.%09ld seconds, parallel %ld.%09ld seconds", n_files,
+	                (long) (time_serial / NM_UTILS_NS_PER_SECOND), (long) (time_serial % NM_UTILS_NS_PER_SECOND),
+	                (long) (time_parallel / NM_UTILS_NS_PER_SECOND), (long) (time_parallel % NM_UTILS_NS_PER_SECOND));
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int main (int argc, char **argv)
@@ -3066,6 +3185,9 @@ int main (int argc, char **argv)
 
 	g_test_add_func ("/keyfile/test_nm_keyfile_plugin_utils_escape_filename", test_nm_keyfile_plugin_utils_escape_filename);
 
+	g_test_add_data_func ("/keyfile/read-many/1000", GUINT_TO_POINTER (1000), test_read_many);
+	g_test_add_data_func ("/keyfile/read-many/10000", GUINT_TO_POINTER (10000), test_read_many);
+
 	return g_test_run ();
 }
 
@@ -90,7 +90,8 @@ typedef struct {
 	GCancellable * assoc_cancellable;
 	char *         net_path;
 	guint32        blobs_left;
-	GHashTable *   bss_proxies;
+	GHashTable *   bss_table;
+	guint          bss_signal_id;
 	char *         current_bss;
 
 	gint32         last_scan; /* timestamp as returned by nm_utils_get_monotonic_timestamp_s() */
@@ -132,103 +133,232 @@ emit_error_helper (NMSupplicantInterface *self, GError *error)
 	g_free (name);
 }
 
+/* BSSes are tracked without a GDBusProxy per object. Their properties come
+ * from the BSSAdded signal or, for BSSes only known from the interface's
+ * "BSSs" property, from a GetAll call. Later changes arrive through a single
+ * PropertiesChanged subscription for all BSS objects of the supplicant.
+ *
+ * While the supplicant is scanning, new and changed BSSes are only marked
+ * pending; they are announced together when the scan is done. */
+typedef struct {
+	char *path;
+	GVariant *props;
+	bool fetching;
+	bool pending;
+} BssInfo;
+
+typedef struct {
+	NMSupplicantInterface *self;
+	char *path;
+} BssFetchData;
+
 static void
-bss_props_changed_cb (GDBusProxy *proxy,
-                      GVariant *changed_properties,
-                      char **invalidated_properties,
-                      gpointer user_data)
+bss_info_free (gpointer data)
 {
-	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
-	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
-
-	if (priv->scanning)
-		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
+	BssInfo *info = data;
 
-	g_signal_emit (self, signals[BSS_UPDATED], 0,
-	               g_dbus_proxy_get_object_path (proxy),
-	               changed_properties);
+	if (info->props)
+		g_variant_unref (info->props);
+	g_free (info->path);
+	g_slice_free (BssInfo, info);
 }
 
 static GVariant *
-_get_bss_proxy_properties (NMSupplicantInterface *self, GDBusProxy *proxy)
+bss_props_merge (GVariant *props, GVariant *changed)
 {
-	gs_strfreev char **properties = NULL;
 	GVariantBuilder builder;
-	char **iter;
+	GVariantIter iter;
+	const char *key;
+	GVariant *value;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
 
-	iter = properties = g_dbus_proxy_get_cached_property_names (proxy);
-	if (!iter)
-		return NULL;
+	g_variant_iter_init (&iter, props);
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		GVariant *update = g_variant_lookup_value (changed, key, NULL);
 
-	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
-	while (*iter) {
-		GVariant *copy = g_dbus_proxy_get_cached_property (proxy, *iter);
+		if (update)
+			g_variant_unref (update);
+		else
+			g_variant_builder_add (&builder, "{sv}", key, value);
+		g_variant_unref (value);
+	}
 
-		g_variant_builder_add (&builder, "{sv}", *iter++, copy);
-		g_variant_unref (copy);
+	g_variant_iter_init (&iter, changed);
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		g_variant_builder_add (&builder, "{sv}", key, value);
+		g_variant_unref (value);
 	}
 
-	return g_variant_builder_end (&builder);
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
 }
 
-#define BSS_PROXY_INITED "bss-proxy-inited"
+static void
+bss_emit_new (NMSupplicantInterface *self, BssInfo *info)
+{
+	info->pending = FALSE;
+	g_signal_emit (self, signals[NEW_BSS], 0, info->path, info->props);
+}
 
 static void
-on_bss_proxy_acquired (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
+bss_flush_pending (NMSupplicantInterface *self)
 {
-	NMSupplicantInterface *self;
-	gs_free_error GError *error = NULL;
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	GHashTableIter iter;
+	BssInfo *info;
+
+	g_hash_table_iter_init (&iter, priv->bss_table);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &info)) {
+		if (info->pending && info->props)
+			bss_emit_new (self, info);
+	}
+}
+
+static void
+bss_set_props (NMSupplicantInterface *self, BssInfo *info, GVariant *props)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+
+	if (info->props)
+		g_variant_unref (info->props);
+	info->props = g_variant_ref (props);
+	info->fetching = FALSE;
+
+	if (priv->scanning)
+		info->pending = TRUE;
+	else
+		bss_emit_new (self, info);
+}
+
+static void
+bss_props_changed_cb (GDBusConnection *connection,
+                      const char *sender_name,
+                      const char *object_path,
+                      const char *interface_name,
+                      const char *signal_name,
+                      GVariant *parameters,
+                      gpointer user_data)
+{
+	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	gs_unref_variant GVariant *changed = NULL;
+	GVariant *merged;
+	BssInfo *info;
+
+	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(sa{sv}as)")))
+		return;
+
+	/* The subscription matches the BSSes of all supplicant interfaces. */
+	info = g_hash_table_lookup (priv->bss_table, object_path);
+	if (!info || !info->props)
+		return;
+
+	if (priv->scanning)
+		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
+
+	changed = g_variant_get_child_value (parameters, 1);
+	merged = bss_props_merge (info->props, changed);
+	g_variant_unref (info->props);
+	info->props = merged;
+
+	if (priv->scanning)
+		info->pending = TRUE;
+	else
+		g_signal_emit (self, signals[BSS_UPDATED], 0, info->path, changed);
+}
+
+static void
+bss_get_all_cb (GDBusConnection *connection, GAsyncResult *result, gpointer user_data)
+{
+	BssFetchData *data = user_data;
+	NMSupplicantInterface *self = data->self;
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	gs_unref_variant GVariant *reply = NULL;
 	gs_unref_variant GVariant *props = NULL;
+	gs_free_error GError *error = NULL;
+	BssInfo *info;
 
-	if (!g_async_initable_init_finish (G_ASYNC_INITABLE (proxy), result, &error)) {
+	reply = g_dbus_connection_call_finish (connection, result, &error);
+
+	info = priv->bss_table ? g_hash_table_lookup (priv->bss_table, data->path) : NULL;
+	if (!info || !info->fetching)
+		goto out;
+
+	if (!reply) {
 		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
-			self = NM_SUPPLICANT_INTERFACE (user_data);
-			_LOGD ("failed to acquire BSS proxy: (%s)", error->message);
-			g_hash_table_remove (NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self)->bss_proxies,
-			                     g_dbus_proxy_get_object_path (proxy));
+			_LOGD ("failed to get BSS properties: (%s)", error->message);
+			g_hash_table_remove (priv->bss_table, data->path);
 		}
-		return;
+		goto out;
 	}
 
-	self = NM_SUPPLICANT_INTERFACE (user_data);
-	props = _get_bss_proxy_properties (self, proxy);
-	if (!props)
-		return;
+	props = g_variant_get_child_value (reply, 0);
+	bss_set_props (self, info, props);
 
-	g_object_set_data (G_OBJECT (proxy), BSS_PROXY_INITED, GUINT_TO_POINTER (TRUE));
+out:
+	g_object_unref (data->self);
+	g_free (data->path);
+	g_slice_free (BssFetchData, data);
+}
+
+static BssInfo *
+bss_add (NMSupplicantInterface *self, const char *object_path)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	BssInfo *info;
+
+	info = g_hash_table_lookup (priv->bss_table, object_path);
+	if (info)
+		return info;
 
-	g_signal_emit (self, signals[NEW_BSS], 0,
-	               g_dbus_proxy_get_object_path (proxy),
-	               g_variant_ref_sink (props));
+	info = g_slice_new0 (BssInfo);
+	info->path = g_strdup (object_path);
+	g_hash_table_insert (priv->bss_table, info->path, info);
+	return info;
 }
 
 static void
 handle_new_bss (NMSupplicantInterface *self, const char *object_path)
 {
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
-	GDBusProxy *bss_proxy;
+	BssFetchData *data;
+	BssInfo *info;
 
 	g_return_if_fail (object_path != NULL);
 
-	if (g_hash_table_lookup (priv->bss_proxies, object_path))
+	info = bss_add (self, object_path);
+	if (info->props || info->fetching)
 		return;
 
-	bss_proxy = g_object_new (G_TYPE_DBUS_PROXY,
-	                          "g-bus-type", G_BUS_TYPE_SYSTEM,
-	                          "g-flags", G_DBUS_PROXY_FLAGS_NONE,
-	                          "g-name", WPAS_DBUS_SERVICE,
-	                          "g-object-path", object_path,
-	                          "g-interface-name", WPAS_DBUS_IFACE_BSS,
-	                          NULL);
-	g_hash_table_insert (priv->bss_proxies,
-	                     (char *) g_dbus_proxy_get_object_path (bss_proxy),
-	                     bss_proxy);
-	g_signal_connect (bss_proxy, "g-properties-changed", G_CALLBACK (bss_props_changed_cb), self);
-	g_async_initable_init_async (G_ASYNC_INITABLE (bss_proxy),
-	                             G_PRIORITY_DEFAULT,
-	                             priv->other_cancellable,
-	                             (GAsyncReadyCallback) on_bss_proxy_acquired,
-	                             self);
+	info->fetching = TRUE;
+
+	data = g_slice_new (BssFetchData);
+	data->self = g_object_ref (self);
+	data->path = g_strdup (object_path);
+	g_dbus_connection_call (g_dbus_proxy_get_connection (priv->iface_proxy),
+	                        WPAS_DBUS_SERVICE,
+	                        object_path,
+	                        DBUS_INTERFACE_PROPERTIES,
+	                        "GetAll",
+	                        g_variant_new ("(s)", WPAS_DBUS_IFACE_BSS),
+	                        G_VARIANT_TYPE ("(a{sv})"),
+	                        G_DBUS_CALL_FLAGS_NONE,
+	                        -1,
+	                        priv->other_cancellable,
+	                        (GAsyncReadyCallback) bss_get_all_cb,
+	                        data);
+}
+
+static void
+bss_unsubscribe (NMSupplicantInterface *self)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+
+	if (priv->bss_signal_id) {
+		g_dbus_connection_signal_unsubscribe (g_dbus_proxy_get_connection (priv->iface_proxy),
+		                                      priv->bss_signal_id);
+		priv->bss_signal_id = 0;
+	}
 }
 
 static void
@@ -265,8 +395,10 @@ set_state (NMSupplicantInterface *self, guint32 new_state)
 			g_cancellable_cancel (priv->other_cancellable);
 		g_clear_object (&priv->other_cancellable);
 
-		if (priv->iface_proxy)
+		if (priv->iface_proxy) {
+			bss_unsubscribe (self);
 			g_signal_handlers_disconnect_by_data (priv->iface_proxy, self);
+		}
 	}
 
 	priv->state = new_state;
@@ -334,9 +466,13 @@ set_scanning (NMSupplicantInterface *self, gboolean new_scanning)
 		priv->scanning = new_scanning;
 
 		/* Cache time of last scan completion */
-		if (priv->scanning == FALSE)
+		if (priv->scanning == FALSE) {
 			priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
 
+			/* Announce BSSes that showed up after ScanDone */
+			bss_flush_pending (self);
+		}
+
 		_notify (self, PROP_SCANNING);
 	}
 }
@@ -581,28 +717,20 @@ wpas_iface_scan_done (GDBusProxy *proxy,
 {
 	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
-	GVariant *props;
 	GHashTableIter iter;
-	char *bss_path;
-	GDBusProxy *bss_proxy;
+	BssInfo *info;
 
 	/* Cache last scan completed time */
 	priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
 
 	g_signal_emit (self, signals[SCAN_DONE], 0, success);
 
-	/* Emit NEW_BSS so that wifi device has the APs (in case it removed them) */
-	g_hash_table_iter_init (&iter, priv->bss_proxies);
-	while (g_hash_table_iter_next (&iter, (gpointer) &bss_path, (gpointer) &bss_proxy)) {
-		if (g_object_get_data (G_OBJECT (bss_proxy), BSS_PROXY_INITED)) {
-			props = _get_bss_proxy_properties (self, bss_proxy);
-			if (props) {
-				g_signal_emit (self, signals[NEW_BSS], 0,
-				               bss_path,
-				               g_variant_ref_sink (props));
-				g_variant_unref (props);
-			}
-		}
+	/* Emit NEW_BSS so that wifi device has the APs (in case it removed them).
+	 * This also delivers the changes collected during the scan. */
+	g_hash_table_iter_init (&iter, priv->bss_table);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &info)) {
+		if (info->props)
+			bss_emit_new (self, info);
 	}
 }
 
@@ -618,7 +746,8 @@ wpas_iface_bss_added (GDBusProxy *proxy,
 	if (priv->scanning)
 		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
 
-	handle_new_bss (self, path);
+	/* The signal carries all properties of the BSS, no need to fetch them */
+	bss_set_props (self, bss_add (self, path), props);
 }
 
 static void
@@ -630,7 +759,7 @@ wpas_iface_bss_removed (GDBusProxy *proxy,
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
 	g_signal_emit (self, signals[BSS_REMOVED], 0, path);
-	g_hash_table_remove (priv->bss_proxies, path);
+	g_hash_table_remove (priv->bss_table, path);
 }
 
 static void
@@ -741,6 +870,17 @@ on_iface_proxy_acquired (GDBusProxy *proxy, GAsyncResult *result, gpointer user_
 	_nm_dbus_signal_connect (priv->iface_proxy, "NetworkRequest", G_VARIANT_TYPE ("(oss)"),
 	                         G_CALLBACK (wpas_iface_network_request), self);
 
+	priv->bss_signal_id = g_dbus_connection_signal_subscribe (g_dbus_proxy_get_connection (priv->iface_proxy),
+	                                                          WPAS_DBUS_SERVICE,
+	                                                          DBUS_INTERFACE_PROPERTIES,
+	                                                          "PropertiesChanged",
+	                                                          NULL,
+	                                                          WPAS_DBUS_IFACE_BSS,
+	                                                          G_DBUS_SIGNAL_FLAGS_NONE,
+	                                                          bss_props_changed_cb,
+	                                                          self,
+	                                                          NULL);
+
 	/* Scan result aging parameters */
 	g_dbus_proxy_call (priv->iface_proxy,
 	                   "org.freedesktop.DBus.Properties.Set",
@@ -1470,7 +1610,7 @@ nm_supplicant_interface_init (NMSupplicantInterface * self)
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
 	priv->state = NM_SUPPLICANT_INTERFACE_STATE_INIT;
-	priv->bss_proxies = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+	priv->bss_table = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, bss_info_free);
 }
 
 static void
@@ -1531,8 +1671,10 @@ dispose (GObject *object)
 {
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (object);
 
-	if (priv->iface_proxy)
+	if (priv->iface_proxy) {
+		bss_unsubscribe (NM_SUPPLICANT_INTERFACE (object));
 		g_signal_handlers_disconnect_by_data (priv->iface_proxy, NM_SUPPLICANT_INTERFACE (object));
+	}
 	g_clear_object (&priv->iface_proxy);
 
 	if (priv->init_cancellable)
@@ -1544,7 +1686,7 @@ dispose (GObject *object)
 	g_clear_object (&priv->other_cancellable);
 
 	g_clear_object (&priv->wpas_proxy);
-	g_clear_pointer (&priv->bss_proxies, (GDestroyNotify) g_hash_table_destroy);
+	g_clear_pointer (&priv->bss_table, (GDestroyNotify) g_hash_table_destroy);
 
 	g_clear_pointer (&priv->net_path, g_free);
 	g_clear_pointer (&priv->dev, g_free);
@@ -32,6 +32,9 @@ typedef struct SDEventSource {
 	GPollFD pollfd;
 	sd_event *event;
 	guint *default_source_id;
+	NMSdEventEnterFunc enter_func;
+	NMSdEventLeaveFunc leave_func;
+	gpointer user_data;
 } SDEventSource;
 
 static gboolean
@@ -49,7 +52,18 @@ event_check (GSource *source)
 static gboolean
 event_dispatch (GSource *source, GSourceFunc callback, gpointer user_data)
 {
-	return sd_event_dispatch (((SDEventSource *)source)->event) > 0;
+	SDEventSource *s = (SDEventSource *) source;
+	gboolean entered = FALSE;
+	gboolean result;
+
+	if (s->enter_func)
+		entered = s->enter_func (s->user_data);
+
+	result = sd_event_dispatch (s->event) > 0;
+
+	if (entered && s->leave_func)
+		s->leave_func (s->user_data);
+	return result;
 }
 
 static void
@@ -132,5 +146,44 @@ nm_sd_event_attach_default (void)
 	return event_attach (NULL, NULL);
 }
 
+/**
+ * nm_sd_event_attach:
+ * @event: the #sd_event to integrate into the main loop
+ * @context: the #GMainContext or %NULL for the default one
+ * @enter_func: (allow-none): called before dispatching events of @event
+ * @leave_func: (allow-none): called after dispatching, if @enter_func
+ *   returned %TRUE
+ * @user_data: data for @enter_func and @leave_func
+ *
+ * Like nm_sd_event_attach_default(), but for a non-default event loop. The
+ * hooks allow to set up the context in which the sd_event callbacks run,
+ * for example the network namespace.
+ *
+ * Returns: the id of the attached #GSource.
+ */
+guint
+nm_sd_event_attach (sd_event *event,
+                    GMainContext *context,
+                    NMSdEventEnterFunc enter_func,
+                    NMSdEventLeaveFunc leave_func,
+                    gpointer user_data)
+{
+	SDEventSource *source;
+	guint id;
+
+	g_return_val_if_fail (event, 0);
+
+	source = event_create_source (event, NULL);
+	source->enter_func = enter_func;
+	source->leave_func = leave_func;
+	source->user_data = user_data;
+
+	id = g_source_attach ((GSource *) source, context);
+	g_source_unref ((GSource *) source);
+
+	g_return_val_if_fail (id, 0);
+	return id;
+}
+
 /*****************************************************************************/
 
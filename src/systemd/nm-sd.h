@@ -21,5 +21,16 @@
 
 guint nm_sd_event_attach_default (void);
 
+typedef gboolean (*NMSdEventEnterFunc) (gpointer user_data);
+typedef void (*NMSdEventLeaveFunc) (gpointer user_data);
+
+struct sd_event;
+
+guint nm_sd_event_attach (struct sd_event *event,
+                          GMainContext *context,
+                          NMSdEventEnterFunc enter_func,
+                          NMSdEventLeaveFunc leave_func,
+                          gpointer user_data);
+
 #endif /* __NM_SD_H__ */
 
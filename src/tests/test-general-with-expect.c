@@ -852,6 +852,82 @@ test_nm_multi_index (void)
 	_mi_test_run (50, 18);
 }
 
+static void
+test_nm_multi_index_many (gconstpointer user_data)
+{
+	const guint n_values = GPOINTER_TO_UINT (user_data);
+	NMMultiIndex *index;
+	NMMultiIndexIdTest id_all = { .bucket = 0 };
+	NMMultiIndexIdTest id;
+	NMMultiIndexIdIter iter;
+	void *const*values, *const*values_prev;
+	gpointer value;
+	gint64 start_time, time;
+	guint i, len;
+
+	if (n_values > 10000 && nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-general-with-expect");
+		g_test_skip ("Skip long running test");
+		return;
+	}
+
+	index = nm_multi_index_new ((NMMultiIndexFuncHash) _mi_idx_hash,
+	                            (NMMultiIndexFuncEqual) _mi_idx_equal,
+	                            (NMMultiIndexFuncClone) _mi_idx_clone,
+	                            (NMMultiIndexFuncDestroy) _mi_idx_destroy);
+
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+
+	/* like the platform cache for routes: every value is in the group
+	 * of all routes and in the group of its ifindex. */
+	for (i = 0; i < n_values; i++) {
+		id.bucket = 1 + (i % 8);
+		g_assert (nm_multi_index_add (index, &id_all.id_base, GUINT_TO_POINTER (i + 1)));
+		g_assert (nm_multi_index_add (index, &id.id_base, GUINT_TO_POINTER (i + 1)));
+	}
+	g_assert_cmpint (nm_multi_index_get_num_groups (index), ==, MIN (n_values, 8) + 1);
+
+	values = nm_multi_index_lookup (index, &id_all.id_base, &len);
+	g_assert_cmpint (len, ==, n_values);
+	for (i = 0; i < n_values; i++)
+		g_assert (values[i] == GUINT_TO_POINTER (i + 1));
+	g_assert (!values[n_values]);
+
+	/* replacing a value and looking up the group again returns the very
+	 * same array, without rebuilding it. */
+	for (i = 0; i < n_values; i += 7) {
+		values_prev = nm_multi_index_lookup (index, &id_all.id_base, NULL);
+		g_assert (nm_multi_index_remove (index, &id_all.id_base, GUINT_TO_POINTER (i + 1)));
+		g_assert (!nm_multi_index_contains (index, &id_all.id_base, GUINT_TO_POINTER (i + 1)));
+		g_assert (nm_multi_index_add (index, &id_all.id_base, GUINT_TO_POINTER (i + 1)));
+		values = nm_multi_index_lookup (index, &id_all.id_base, &len);
+		g_assert (values == values_prev);
+		g_assert_cmpint (len, ==, n_values);
+		g_assert (values[n_values - 1] == GUINT_TO_POINTER (i + 1));
+	}
+
+	len = 0;
+	nm_multi_index_id_iter_init (&iter, index, &id_all.id_base);
+	while (nm_multi_index_id_iter_next (&iter, &value)) {
+		g_assert (nm_multi_index_contains (index, &id_all.id_base, value));
+		len++;
+	}
+	g_assert_cmpint (len, ==, n_values);
+
+	for (i = 0; i < n_values; i++) {
+		id.bucket = 1 + (i % 8);
+		g_assert (nm_multi_index_remove (index, &id_all.id_base, GUINT_TO_POINTER (i + 1)));
+		g_assert (nm_multi_index_remove (index, &id.id_base, GUINT_TO_POINTER (i + 1)));
+	}
+	g_assert_cmpint (nm_multi_index_get_num_groups (index), ==, 0);
+
+	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+	g_test_message (">>> %u values finished in %ld.%09ld seconds", n_values,
+	                (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND));
+
+	nm_multi_index_free (index);
+}
+
 /*******************************************/
 
 static void
@@ -909,6 +985,8 @@ main (int argc, char **argv)
 	g_test_add_func ("/general/nm_utils_array_remove_at_indexes", test_nm_utils_array_remove_at_indexes);
 	g_test_add_func ("/general/nm_ethernet_address_is_valid", test_nm_ethernet_address_is_valid);
 	g_test_add_func ("/general/nm_multi_index", test_nm_multi_index);
+	g_test_add_data_func ("/general/nm_multi_index/many/10000", GUINT_TO_POINTER (10000), test_nm_multi_index_many);
+	g_test_add_data_func ("/general/nm_multi_index/many/1000000", GUINT_TO_POINTER (1000000), test_nm_multi_index_many);
 	g_test_add_func ("/general/nm_utils_new_vlan_name", test_nm_utils_new_vlan_name);
 
 	return g_test_run ();
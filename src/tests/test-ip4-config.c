@@ -300,6 +300,45 @@ test_add_route_with_source (void)
 	g_object_unref (a);
 }
 
+static void
+test_lookup_remove_route (void)
+{
+	NMIP4Config *a;
+	NMPlatformIP4Route route, needle;
+	const NMPlatformIP4Route *test_route;
+
+	a = nm_ip4_config_new (1);
+
+	route_new (&route, "1.2.3.0", 24, "1.2.3.1");
+	route.metric = 10;
+	nm_ip4_config_add_route (a, &route);
+	route_new (&route, "5.6.7.0", 24, NULL);
+	nm_ip4_config_add_route (a, &route);
+
+	/* routes are found by their destination only */
+	route_new (&needle, "1.2.3.0", 24, "1.2.3.254");
+	needle.metric = 20;
+	test_route = nm_ip4_config_lookup_route (a, &needle);
+	g_assert (test_route);
+	g_assert_cmpint (test_route->metric, ==, 10);
+
+	route_new (&needle, "1.2.3.0", 25, NULL);
+	g_assert (!nm_ip4_config_lookup_route (a, &needle));
+	g_assert (!nm_ip4_config_remove_route (a, &needle));
+	g_assert_cmpint (nm_ip4_config_get_num_routes (a), ==, 2);
+
+	route_new (&needle, "1.2.3.0", 24, NULL);
+	g_assert (nm_ip4_config_remove_route (a, &needle));
+	g_assert (!nm_ip4_config_lookup_route (a, &needle));
+	g_assert_cmpint (nm_ip4_config_get_num_routes (a), ==, 1);
+
+	/* the remaining route is still found after the index was invalidated */
+	test_route = nm_ip4_config_lookup_route (a, &route);
+	g_assert (test_route == nm_ip4_config_get_route (a, 0));
+
+	g_object_unref (a);
+}
+
 static void
 test_merge_subtract_mss_mtu (void)
 {
@@ -360,6 +399,122 @@ test_strip_search_trailing_dot (void)
 	g_object_unref (config);
 }
 
+static void
+test_equal (void)
+{
+	gs_unref_object NMIP4Config *a = NULL;
+	gs_unref_object NMIP4Config *b = NULL;
+	NMPlatformIP4Route route;
+
+	a = build_test_config ();
+	b = build_test_config ();
+
+	g_assert (nm_ip4_config_equal (a, b));
+	g_assert (nm_ip4_config_equal (a, a));
+	g_assert (!nm_ip4_config_equal (a, NULL));
+
+	/* a change must invalidate the cached fingerprint. */
+	route_new (&route, "10.0.0.0", 8, "192.168.1.2");
+	nm_ip4_config_add_route (a, &route);
+	g_assert (!nm_ip4_config_equal (a, b));
+	nm_ip4_config_add_route (b, &route);
+	g_assert (nm_ip4_config_equal (a, b));
+
+	/* NIS changes don't emit a property notification. */
+	nm_ip4_config_set_nis_domain (a, "example.com");
+	g_assert (!nm_ip4_config_equal (a, b));
+	nm_ip4_config_set_nis_domain (b, "example.com");
+	g_assert (nm_ip4_config_equal (a, b));
+
+	nm_ip4_config_del_nis_server (a, 0);
+	g_assert (!nm_ip4_config_equal (a, b));
+
+	/* sources are not relevant for equality. */
+	nm_ip4_config_del_nis_server (b, 0);
+	route.source = NM_IP_CONFIG_SOURCE_USER;
+	nm_ip4_config_add_route (b, &route);
+	g_assert (nm_ip4_config_equal (a, b));
+
+	/* equality relies on the fingerprint, which must not mix up lists. */
+	g_object_unref (a);
+	g_object_unref (b);
+	a = nm_ip4_config_new (1);
+	b = nm_ip4_config_new (1);
+	nm_ip4_config_add_domain (a, "example.com");
+	nm_ip4_config_add_search (b, "example.com");
+	g_assert (!nm_ip4_config_equal (a, b));
+}
+
+static void
+_routes_many_fill (NMIP4Config *config, guint n, guint step, guint offset)
+{
+	NMPlatformIP4Route route;
+	guint i;
+
+	memset (&route, 0, sizeof (route));
+	route.plen = 32;
+	route.source = NM_IP_CONFIG_SOURCE_USER;
+	for (i = offset; i < n; i += step) {
+		route.network = htonl (0x0A000000u + i);
+		nm_ip4_config_add_route (config, &route);
+	}
+}
+
+static void
+test_routes_many (gconstpointer user_data)
+{
+	const guint n_routes = GPOINTER_TO_UINT (user_data);
+	gs_unref_object NMIP4Config *a = NULL;
+	gs_unref_object NMIP4Config *b = NULL;
+	gs_unref_object NMIP4Config *c = NULL;
+	const NMPlatformIP4Route *r;
+	gint64 start_time, time;
+	guint i;
+
+	if (n_routes > 10000 && nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-ip4-config");
+		g_test_skip ("Skip long running test");
+		return;
+	}
+
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+
+	a = nm_ip4_config_new (1);
+	b = nm_ip4_config_new (1);
+	c = nm_ip4_config_new (1);
+
+	/* adding every route twice must not create duplicates. */
+	_routes_many_fill (a, n_routes, 1, 0);
+	_routes_many_fill (a, n_routes, 1, 0);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (a), ==, n_routes);
+
+	/* @b has every even route. */
+	_routes_many_fill (b, n_routes, 2, 0);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (b), ==, (n_routes + 1) / 2);
+
+	nm_ip4_config_merge (c, b, NM_IP_CONFIG_MERGE_DEFAULT);
+	nm_ip4_config_merge (c, a, NM_IP_CONFIG_MERGE_DEFAULT);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (c), ==, n_routes);
+
+	nm_ip4_config_intersect (c, b);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (c), ==, (n_routes + 1) / 2);
+
+	/* only the odd routes are left, in their original order. */
+	nm_ip4_config_subtract (a, b);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (a), ==, n_routes / 2);
+	for (i = 0; i < n_routes / 2; i++) {
+		r = nm_ip4_config_get_route (a, i);
+		g_assert_cmpuint (ntohl (r->network), ==, 0x0A000000u + 2 * i + 1);
+	}
+
+	nm_ip4_config_subtract (c, b);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (c), ==, 0);
+
+	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+	g_test_message (">>> %u routes finished in %ld.%09ld seconds", n_routes,
+	                (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND));
+}
+
 /*******************************************/
 
 NMTST_DEFINE ();
@@ -373,8 +528,12 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip4-config/compare-with-source", test_compare_with_source);
 	g_test_add_func ("/ip4-config/add-address-with-source", test_add_address_with_source);
 	g_test_add_func ("/ip4-config/add-route-with-source", test_add_route_with_source);
+	g_test_add_func ("/ip4-config/lookup-remove-route", test_lookup_remove_route);
 	g_test_add_func ("/ip4-config/merge-subtract-mss-mtu", test_merge_subtract_mss_mtu);
 	g_test_add_func ("/ip4-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
+	g_test_add_func ("/ip4-config/equal", test_equal);
+	g_test_add_data_func ("/ip4-config/routes-many/10000", GUINT_TO_POINTER (10000), test_routes_many);
+	g_test_add_data_func ("/ip4-config/routes-many/100000", GUINT_TO_POINTER (100000), test_routes_many);
 
 	return g_test_run ();
 }
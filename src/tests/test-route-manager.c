@@ -29,6 +29,7 @@
 #include "nm-route-manager.h"
 #include "nm-netns-controller.h"
 #include "nm-netns.h"
+#include "nm-ip-config-deltas.h"
 
 #include "nm-test-utils.h"
 
@@ -872,6 +873,234 @@ test_ip4_full_sync (test_fixture *fixture, gconstpointer user_data)
 	nm_log_dbg (LOGD_CORE, "TEST test_ip4_full_sync(): done");
 }
 
+static void
+test_ip4_external_delete (test_fixture *fixture, gconstpointer user_data)
+{
+	const NMPlatformVTableRoute *vtable = &nm_platform_vtable_route_v4;
+	gs_unref_array GArray *routes = g_array_new (FALSE, FALSE, sizeof (NMPlatformIP4Route));
+	NMPlatformIP4Route r01, r02;
+
+	nm_log_dbg (LOGD_CORE, "TEST start test_ip4_external_delete(): start");
+
+	r01 = *nmtst_platform_ip4_route_full ("12.3.4.0", 24, NULL,
+	                                      fixture->ifindex0, NM_IP_CONFIG_SOURCE_USER,
+	                                      100, 0, RT_SCOPE_LINK, NULL);
+	r02 = *nmtst_platform_ip4_route_full ("13.4.5.6", 32, "12.3.4.1",
+	                                      fixture->ifindex0, NM_IP_CONFIG_SOURCE_USER,
+	                                      100, 0, RT_SCOPE_UNIVERSE, NULL);
+	g_array_set_size (routes, 2);
+	g_array_index (routes, NMPlatformIP4Route, 0) = r01;
+	g_array_index (routes, NMPlatformIP4Route, 1) = r02;
+	nm_route_manager_ip4_route_sync (_get_route_manager (), fixture->ifindex0, routes, TRUE, TRUE);
+
+	_assert_route_check (vtable, TRUE,  (const NMPlatformIPXRoute *) &r01);
+	_assert_route_check (vtable, TRUE,  (const NMPlatformIPXRoute *) &r02);
+
+	/* the routes of the interface are remembered between syncs. The next
+	 * sync must notice that the route is gone and add it again. */
+	g_assert (nm_platform_ip4_route_delete (NM_PLATFORM_GET, fixture->ifindex0, r02.network, r02.plen, r02.metric));
+	_assert_route_check (vtable, FALSE, (const NMPlatformIPXRoute *) &r02);
+
+	nm_route_manager_ip4_route_sync (_get_route_manager (), fixture->ifindex0, routes, TRUE, FALSE);
+
+	_assert_route_check (vtable, TRUE,  (const NMPlatformIPXRoute *) &r01);
+	_assert_route_check (vtable, TRUE,  (const NMPlatformIPXRoute *) &r02);
+
+	g_array_set_size (routes, 1);
+	nm_route_manager_ip4_route_sync (_get_route_manager (), fixture->ifindex0, routes, TRUE, TRUE);
+
+	_assert_route_check (vtable, TRUE,  (const NMPlatformIPXRoute *) &r01);
+	_assert_route_check (vtable, FALSE, (const NMPlatformIPXRoute *) &r02);
+
+	nm_log_dbg (LOGD_CORE, "TEST test_ip4_external_delete(): done");
+}
+
+/*****************************************************************************/
+
+/* Checks that replaying the recorded route changes on a captured
+ * configuration gives the same routes as capturing it again, which
+ * is what NMDevice relies on. */
+
+typedef struct {
+	int ifindex;
+	NMIPConfigDeltas deltas;
+} DeltasData;
+
+static void
+_deltas_route_changed_cb (NMPlatform *platform,
+                          NMPObjectType obj_type,
+                          int ifindex,
+                          gconstpointer route,
+                          NMPlatformSignalChangeType change_type,
+                          DeltasData *data)
+{
+	if (ifindex != data->ifindex)
+		return;
+	nm_ip_config_deltas_add_route (&data->deltas, change_type, route,
+	                               obj_type == NMP_OBJECT_TYPE_IP4_ROUTE
+	                                   ? sizeof (NMPlatformIP4Route)
+	                                   : sizeof (NMPlatformIP6Route));
+}
+
+static void
+_deltas_ip4_route_add (int ifindex, guint i, guint32 metric)
+{
+	g_assert (nm_platform_ip4_route_add (NM_PLATFORM_GET, ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                                     htonl (0x0A000000u | (i << 8)), 24, 0, 0, metric, 0));
+}
+
+static void
+_deltas_ip4_route_delete (int ifindex, guint i, guint32 metric)
+{
+	g_assert (nm_platform_ip4_route_delete (NM_PLATFORM_GET, ifindex,
+	                                        htonl (0x0A000000u | (i << 8)), 24, metric));
+}
+
+static void
+_deltas_ip6_route_add (int ifindex, guint i)
+{
+	struct in6_addr network = *nmtst_inet6_from_string ("2001:db8::");
+
+	network.s6_addr[4] = i;
+	g_assert (nm_platform_ip6_route_add (NM_PLATFORM_GET, ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                                     network, 64, in6addr_any, 20, 0));
+}
+
+static void
+_deltas_ip6_route_delete (int ifindex, guint i)
+{
+	struct in6_addr network = *nmtst_inet6_from_string ("2001:db8::");
+
+	network.s6_addr[4] = i;
+	g_assert (nm_platform_ip6_route_delete (NM_PLATFORM_GET, ifindex, network, 64, 20));
+}
+
+/* the replayed configuration may list the routes in a different order. */
+static void
+_deltas_assert_equal_ip4 (NMIP4Config *replayed, NMIP4Config *full)
+{
+	guint i;
+
+	g_assert_cmpint (nm_ip4_config_get_num_routes (replayed), ==, nm_ip4_config_get_num_routes (full));
+	for (i = 0; i < nm_ip4_config_get_num_routes (full); i++) {
+		const NMPlatformIP4Route *route = nm_ip4_config_get_route (full, i);
+		const NMPlatformIP4Route *other = nm_ip4_config_lookup_route (replayed, route);
+
+		g_assert (other);
+		g_assert_cmpint (other->gateway, ==, route->gateway);
+		g_assert_cmpint (other->metric, ==, route->metric);
+	}
+}
+
+static void
+_deltas_assert_equal_ip6 (NMIP6Config *replayed, NMIP6Config *full)
+{
+	guint i;
+
+	g_assert_cmpint (nm_ip6_config_get_num_routes (replayed), ==, nm_ip6_config_get_num_routes (full));
+	for (i = 0; i < nm_ip6_config_get_num_routes (full); i++) {
+		const NMPlatformIP6Route *route = nm_ip6_config_get_route (full, i);
+		const NMPlatformIP6Route *other = nm_ip6_config_lookup_route (replayed, route);
+
+		g_assert (other);
+		g_assert (IN6_ARE_ADDR_EQUAL (&other->gateway, &route->gateway));
+		g_assert_cmpint (other->metric, ==, route->metric);
+	}
+}
+
+static void
+test_ip4_deltas (test_fixture *fixture, gconstpointer user_data)
+{
+	NMNetns *netns = nm_netns_controller_get_root_netns ();
+	DeltasData data = { .ifindex = fixture->ifindex0 };
+	NMIP4Config *captured;
+	NMIP4Config *full;
+	gulong id;
+	guint i, n_routes;
+
+	for (i = 0; i < 4; i++)
+		_deltas_ip4_route_add (fixture->ifindex0, i, 20);
+
+	captured = nm_ip4_config_capture (netns, fixture->ifindex0, FALSE);
+	id = g_signal_connect (NM_PLATFORM_GET, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED,
+	                       G_CALLBACK (_deltas_route_changed_cb), &data);
+
+	_deltas_ip4_route_add (fixture->ifindex0, 4, 20);
+	_deltas_ip4_route_add (fixture->ifindex0, 5, 20);
+	_deltas_ip4_route_delete (fixture->ifindex0, 1, 20);
+	_deltas_ip4_route_delete (fixture->ifindex0, 4, 20);
+	_deltas_ip4_route_add (fixture->ifindex0, 6, 20);
+	_deltas_ip4_route_delete (fixture->ifindex0, 0, 20);
+	_deltas_ip4_route_add (fixture->ifindex0, 1, 20);
+
+	g_assert (!data.deltas.need_full);
+	g_assert_cmpint (data.deltas.routes->len, ==, 7);
+	g_assert (nm_ip_config_deltas_replay_ip4 (&data.deltas, captured));
+	full = nm_ip4_config_capture (netns, fixture->ifindex0, FALSE);
+	_deltas_assert_equal_ip4 (captured, full);
+	g_object_unref (full);
+
+	/* a second route to the same destination cannot be replayed. */
+	nm_ip_config_deltas_reset (&data.deltas, FALSE);
+	_deltas_ip4_route_add (fixture->ifindex0, 2, 30);
+	g_assert (!data.deltas.need_full);
+	g_assert (!nm_ip_config_deltas_replay_ip4 (&data.deltas, captured));
+	g_object_unref (captured);
+	_deltas_ip4_route_delete (fixture->ifindex0, 2, 30);
+
+	/* too many changes fall back to a full capture. */
+	captured = nm_ip4_config_capture (netns, fixture->ifindex0, FALSE);
+	n_routes = nm_ip4_config_get_num_routes (captured);
+	nm_ip_config_deltas_reset (&data.deltas, FALSE);
+	for (i = 0; i < NM_IP_CONFIG_DELTAS_MAX + 1; i++)
+		_deltas_ip4_route_add (fixture->ifindex0, 100 + i, 20);
+	g_assert (data.deltas.need_full);
+	g_assert_cmpint (data.deltas.routes->len, ==, 0);
+	g_assert (!nm_ip_config_deltas_replay_ip4 (&data.deltas, captured));
+	g_assert_cmpint (nm_ip4_config_get_num_routes (captured), ==, n_routes);
+	g_object_unref (captured);
+
+	full = nm_ip4_config_capture (netns, fixture->ifindex0, FALSE);
+	g_assert_cmpint (nm_ip4_config_get_num_routes (full), ==, n_routes + NM_IP_CONFIG_DELTAS_MAX + 1);
+	g_object_unref (full);
+
+	g_signal_handler_disconnect (NM_PLATFORM_GET, id);
+	nm_ip_config_deltas_clear (&data.deltas);
+}
+
+static void
+test_ip6_deltas (test_fixture *fixture, gconstpointer user_data)
+{
+	NMNetns *netns = nm_netns_controller_get_root_netns ();
+	DeltasData data = { .ifindex = fixture->ifindex0 };
+	NMIP6Config *captured;
+	NMIP6Config *full;
+	gulong id;
+	guint i;
+
+	for (i = 0; i < 3; i++)
+		_deltas_ip6_route_add (fixture->ifindex0, i);
+
+	captured = nm_ip6_config_capture (netns, fixture->ifindex0, FALSE, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	id = g_signal_connect (NM_PLATFORM_GET, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED,
+	                       G_CALLBACK (_deltas_route_changed_cb), &data);
+
+	_deltas_ip6_route_add (fixture->ifindex0, 3);
+	_deltas_ip6_route_delete (fixture->ifindex0, 0);
+	_deltas_ip6_route_add (fixture->ifindex0, 4);
+	_deltas_ip6_route_delete (fixture->ifindex0, 3);
+
+	g_assert (!data.deltas.need_full);
+	g_assert (nm_ip_config_deltas_replay_ip6 (&data.deltas, captured));
+	full = nm_ip6_config_capture (netns, fixture->ifindex0, FALSE, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	_deltas_assert_equal_ip6 (captured, full);
+
+	g_object_unref (captured);
+	g_object_unref (full);
+	g_signal_handler_disconnect (NM_PLATFORM_GET, id);
+	nm_ip_config_deltas_clear (&data.deltas);
+}
+
 /*****************************************************************************/
 
 static void
@@ -926,4 +1155,8 @@ setup_tests (void)
 	g_test_add ("/route-manager/ip6", test_fixture, NULL, fixture_setup, test_ip6, fixture_teardown);
 
 	g_test_add ("/route-manager/ip4-full-sync", test_fixture, NULL, fixture_setup, test_ip4_full_sync, fixture_teardown);
+	g_test_add ("/route-manager/ip4-external-delete", test_fixture, NULL, fixture_setup, test_ip4_external_delete, fixture_teardown);
+
+	g_test_add ("/route-manager/ip4-deltas", test_fixture, NULL, fixture_setup, test_ip4_deltas, fixture_teardown);
+	g_test_add ("/route-manager/ip6-deltas", test_fixture, NULL, fixture_setup, test_ip6_deltas, fixture_teardown);
 }
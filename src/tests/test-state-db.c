@@ -0,0 +1,205 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ */
+
+#include "nm-default.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "settings/nm-state-db.c"
+
+#include "nm-test-utils.h"
+
+/*******************************************/
+
+typedef struct {
+	char *tmpdir;
+	char *filename;
+} TestFixture;
+
+/* point the timestamps database to a file of our own, dropping whatever
+ * state a previous test left behind. */
+static NMStateDB *
+_db_reset (const char *filename)
+{
+	NMStateDB *db = nm_state_db_get_timestamps ();
+
+	nm_clear_g_source (&db->flush_id);
+	g_clear_pointer (&db->keyfile, g_key_file_unref);
+	db->dirty = FALSE;
+	db->filename = filename;
+	return db;
+}
+
+static void
+fixture_setup (TestFixture *fixture, gconstpointer user_data)
+{
+	GError *error = NULL;
+
+	fixture->tmpdir = g_dir_make_tmp ("test-state-db-XXXXXX", &error);
+	g_assert_no_error (error);
+	fixture->filename = g_build_filename (fixture->tmpdir, "timestamps", NULL);
+}
+
+static void
+fixture_teardown (TestFixture *fixture, gconstpointer user_data)
+{
+	_db_reset (NULL);
+	unlink (fixture->filename);
+	rmdir (fixture->tmpdir);
+	g_free (fixture->filename);
+	g_free (fixture->tmpdir);
+}
+
+static void
+test_roundtrip (TestFixture *fixture, gconstpointer user_data)
+{
+	NMStateDB *db;
+	gs_free char *contents = NULL;
+	char *value;
+	GError *error = NULL;
+
+	g_assert (g_file_set_contents (fixture->filename,
+	                               "[timestamps]\n"
+	                               "uuid-a=1000\n"
+	                               "uuid-b=2000\n",
+	                               -1, &error));
+	g_assert_no_error (error);
+
+	db = _db_reset (fixture->filename);
+
+	value = nm_state_db_get_value (db, "uuid-a");
+	g_assert_cmpstr (value, ==, "1000");
+	g_free (value);
+	g_assert (!nm_state_db_get_value (db, "uuid-c"));
+
+	nm_state_db_set_value (db, "uuid-a", "1001");
+	nm_state_db_set_value (db, "uuid-c", "3000");
+	nm_state_db_remove (db, "uuid-b");
+	nm_state_db_flush (db);
+	g_assert (!db->dirty);
+	g_assert (!db->flush_id);
+
+	g_assert (g_file_get_contents (fixture->filename, &contents, NULL, &error));
+	g_assert_no_error (error);
+	g_assert (strstr (contents, "uuid-a=1001\n"));
+	g_assert (strstr (contents, "uuid-c=3000\n"));
+	g_assert (!strstr (contents, "uuid-b"));
+
+	/* a fresh load sees the flushed state. */
+	db = _db_reset (fixture->filename);
+	value = nm_state_db_get_value (db, "uuid-a");
+	g_assert_cmpstr (value, ==, "1001");
+	g_free (value);
+	value = nm_state_db_get_value (db, "uuid-c");
+	g_assert_cmpstr (value, ==, "3000");
+	g_free (value);
+	g_assert (!nm_state_db_get_value (db, "uuid-b"));
+}
+
+static void
+test_batching (TestFixture *fixture, gconstpointer user_data)
+{
+	NMStateDB *db;
+	guint flush_id;
+	char key[32];
+	guint i;
+
+	db = _db_reset (fixture->filename);
+
+	/* modifications are only collected, with a single pending write. */
+	nm_state_db_set_value (db, "uuid-0", "0");
+	flush_id = db->flush_id;
+	g_assert (flush_id);
+	for (i = 1; i < 100; i++) {
+		nm_sprintf_buf (key, "uuid-%u", i);
+		nm_state_db_set_value (db, key, "0");
+		g_assert_cmpint (db->flush_id, ==, flush_id);
+	}
+	g_assert (db->dirty);
+	g_assert (!g_file_test (fixture->filename, G_FILE_TEST_EXISTS));
+
+	nm_state_db_flush (db);
+	g_assert (!db->flush_id);
+	g_assert (g_file_test (fixture->filename, G_FILE_TEST_EXISTS));
+
+	/* setting a value that is already there is not a modification. */
+	unlink (fixture->filename);
+	nm_state_db_set_value (db, "uuid-0", "0");
+	g_assert (!db->dirty);
+	g_assert (!db->flush_id);
+	nm_state_db_flush (db);
+	g_assert (!g_file_test (fixture->filename, G_FILE_TEST_EXISTS));
+
+	/* nor is removing a key that is not there. */
+	nm_state_db_remove (db, "uuid-none");
+	g_assert (!db->dirty);
+}
+
+static void
+test_flush_failure (TestFixture *fixture, gconstpointer user_data)
+{
+	gs_free char *subdir = g_build_filename (fixture->tmpdir, "sub", NULL);
+	gs_free char *filename = g_build_filename (subdir, "timestamps", NULL);
+	NMStateDB *db;
+	char *value;
+
+	db = _db_reset (filename);
+
+	nm_state_db_set_value (db, "uuid-a", "1000");
+
+	/* the directory doesn't exist, so writing fails. The modification
+	 * must not get lost. */
+	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_MESSAGE, "*error saving timestamps to file*");
+	nm_state_db_flush (db);
+	g_test_assert_expected_messages ();
+	g_assert (db->dirty);
+
+	g_assert_cmpint (mkdir (subdir, 0755), ==, 0);
+	nm_state_db_flush (db);
+	g_assert (!db->dirty);
+	g_assert (g_file_test (filename, G_FILE_TEST_EXISTS));
+
+	db = _db_reset (filename);
+	value = nm_state_db_get_value (db, "uuid-a");
+	g_assert_cmpstr (value, ==, "1000");
+	g_free (value);
+
+	_db_reset (NULL);
+	unlink (filename);
+	rmdir (subdir);
+}
+
+/*******************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_assert_logging (&argc, &argv, "WARN", "DEFAULT");
+
+	g_test_add ("/state-db/roundtrip", TestFixture, NULL, fixture_setup, test_roundtrip, fixture_teardown);
+	g_test_add ("/state-db/batching", TestFixture, NULL, fixture_setup, test_batching, fixture_teardown);
+	g_test_add ("/state-db/flush-failure", TestFixture, NULL, fixture_setup, test_flush_failure, fixture_teardown);
+
+	return g_test_run ();
+}